@@ -0,0 +1,224 @@
+//
+// Created by Eric Berdahl on 5/18/18.
+//
+
+#include "baseline_compare.hpp"
+
+#include "benchmark_stats.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <sstream>
+
+namespace {
+
+    // significance below which a change in distribution is believed
+    const double kSignificance = 0.01;
+
+    // the rank test's normal approximation is poor for fewer samples than this
+    const std::size_t kMinSamples = 5;
+
+    typedef std::map<std::string, std::string> fields_t;
+
+    // Parses one line of the flat objects results_sink writes: string, number and null values only
+    bool parse_json_object(const std::string& line, fields_t& fields) {
+        std::size_t i = 0;
+        auto skip_space = [&]() { while (i < line.size() && std::isspace(static_cast<unsigned char>(line[i]))) ++i; };
+
+        auto parse_string = [&](std::string& s) {
+            if (i >= line.size() || '"' != line[i]) return false;
+            for (++i; i < line.size() && '"' != line[i]; ++i) {
+                if ('\\' != line[i]) {
+                    s += line[i];
+                    continue;
+                }
+
+                if (++i >= line.size()) return false;
+                switch (line[i]) {
+                    case 'n': s += '\n'; break;
+                    case 'r': s += '\r'; break;
+                    case 't': s += '\t'; break;
+                    case 'u':
+                        // results_sink escapes only control characters this way
+                        if (i + 4 >= line.size()) return false;
+                        s += static_cast<char>(std::strtoul(line.substr(i + 1, 4).c_str(), nullptr, 16));
+                        i += 4;
+                        break;
+                    default: s += line[i]; break;
+                }
+            }
+            if (i >= line.size()) return false;
+            ++i;
+            return true;
+        };
+
+        skip_space();
+        if (i >= line.size() || '{' != line[i++]) return false;
+
+        for (;;) {
+            skip_space();
+            if (i < line.size() && '}' == line[i]) return true;
+
+            std::string name;
+            if (!parse_string(name)) return false;
+            skip_space();
+            if (i >= line.size() || ':' != line[i++]) return false;
+            skip_space();
+
+            std::string value;
+            if (i < line.size() && '"' == line[i]) {
+                if (!parse_string(value)) return false;
+            }
+            else {
+                while (i < line.size() && ',' != line[i] && '}' != line[i] && !std::isspace(static_cast<unsigned char>(line[i]))) {
+                    value += line[i++];
+                }
+                if ("null" == value) value.clear();
+            }
+            fields[name] = value;
+
+            skip_space();
+            if (i < line.size() && ',' == line[i]) ++i;
+        }
+    }
+
+    // Reads one record of comma separated fields, which may span lines inside quotes
+    bool read_csv_record(std::istream& is, std::vector<std::string>& fields) {
+        fields.clear();
+        if (is.peek() == std::char_traits<char>::eof()) return false;
+
+        std::string field;
+        bool quoted = false;
+        for (int c = is.get(); c != std::char_traits<char>::eof(); c = is.get()) {
+            if (quoted) {
+                if ('"' == c && '"' == is.peek()) {
+                    field += static_cast<char>(is.get());
+                }
+                else if ('"' == c) {
+                    quoted = false;
+                }
+                else {
+                    field += static_cast<char>(c);
+                }
+            }
+            else if ('"' == c) {
+                quoted = true;
+            }
+            else if (',' == c) {
+                fields.push_back(field);
+                field.clear();
+            }
+            else if ('\n' == c) {
+                break;
+            }
+            else if ('\r' != c) {
+                field += static_cast<char>(c);
+            }
+        }
+        fields.push_back(field);
+
+        return true;
+    }
+
+    // the execution time of a timed invocation record, if it is one
+    void add_sample(const fields_t& fields, baseline_compare::baseline_t& baseline) {
+        auto field = [&fields](const char* name) {
+            auto found = fields.find(name);
+            return (found == fields.end() ? std::string() : found->second);
+        };
+
+        const std::string executionTime = field("execution_ns");
+        if ("invocation" != field("record") || "correctness" == field("timing") || executionTime.empty()) return;
+
+        const std::string key = baseline_compare::kernel_key(field("module"), field("entry_point"), field("workgroup"), field("arguments"));
+        baseline.mExecutionTimes_ns[key].push_back(std::strtod(executionTime.c_str(), nullptr));
+    }
+
+    double median(std::vector<double> samples) {
+        std::sort(samples.begin(), samples.end());
+        return benchmark_stats::percentile(samples, 50.0);
+    }
+
+} // anonymous namespace
+
+namespace baseline_compare {
+
+    std::string kernel_key(const std::string& moduleName,
+                           const std::string& entryPoint,
+                           const std::string& workgroup,
+                           const std::string& arguments) {
+        return moduleName + '\t' + entryPoint + '\t' + workgroup + '\t' + arguments;
+    }
+
+    std::string kernel_key(const std::string& moduleName, const test_utils::KernelTest& kernelTest) {
+        // formatted as results_sink writes the workgroup and arguments
+        std::ostringstream workgroup;
+        workgroup << kernelTest.mWorkgroupSize.width << "x" << kernelTest.mWorkgroupSize.height << "x" << kernelTest.mWorkgroupSize.depth;
+
+        std::string arguments;
+        for (const auto& arg : kernelTest.mArguments) {
+            if (!arguments.empty()) arguments += ' ';
+            arguments += arg;
+        }
+
+        return kernel_key(moduleName, kernelTest.mEntryName, workgroup.str(), arguments);
+    }
+
+    baseline_t read(std::istream& is, double threshold) {
+        baseline_t result;
+        result.mThreshold = threshold;
+
+        is >> std::ws;
+        if ('{' == is.peek()) {
+            std::string line;
+            while (std::getline(is, line)) {
+                fields_t fields;
+                if (parse_json_object(line, fields)) {
+                    add_sample(fields, result);
+                }
+            }
+        }
+        else {
+            std::vector<std::string> header;
+            read_csv_record(is, header);
+
+            std::vector<std::string> values;
+            while (read_csv_record(is, values)) {
+                fields_t fields;
+                for (std::size_t i = 0; i < std::min(header.size(), values.size()); ++i) {
+                    fields[header[i]] = values[i];
+                }
+                add_sample(fields, result);
+            }
+        }
+
+        return result;
+    }
+
+    comparison_t compare(const std::vector<double>& baseline, const std::vector<double>& current, double threshold) {
+        comparison_t result;
+        result.mNumBaseline = baseline.size();
+        result.mNumCurrent = current.size();
+        if (baseline.size() < kMinSamples || current.size() < kMinSamples) return result;
+
+        result.mBaselineMedian_ns = median(baseline);
+        result.mCurrentMedian_ns = median(current);
+        result.mDelta = (result.mBaselineMedian_ns > 0.0 ? result.mCurrentMedian_ns / result.mBaselineMedian_ns - 1.0 : 0.0);
+        result.mP = benchmark_stats::mann_whitney_u(current, baseline).mP;
+
+        result.mVerdict = verdict_unchanged;
+        if (result.mP < kSignificance) {
+            if (result.mDelta > threshold) {
+                result.mVerdict = verdict_regression;
+            }
+            else if (result.mDelta < -threshold) {
+                result.mVerdict = verdict_improvement;
+            }
+        }
+
+        return result;
+    }
+
+}
@@ -0,0 +1,63 @@
+//
+// Created by Eric Berdahl on 5/18/18.
+//
+
+#ifndef CLSPVTEST_BASELINE_COMPARE_HPP
+#define CLSPVTEST_BASELINE_COMPARE_HPP
+
+#include "test_utils.hpp"
+
+#include <istream>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace baseline_compare {
+
+    //
+    // Execution times of a previous run, read from the file the results verb writes, by kernel_key.
+    // Only invocations of timed kernels contribute.
+    //
+    struct baseline_t {
+        typedef std::map<std::string, std::vector<double>> samples_map;
+
+        samples_map mExecutionTimes_ns;
+        double      mThreshold  = 0.0;  // relative change in median below which nothing is flagged
+    };
+
+    enum verdict {
+        verdict_none,           // too few samples on one side to compare
+        verdict_unchanged,
+        verdict_regression,
+        verdict_improvement
+    };
+
+    struct comparison_t {
+        verdict     mVerdict            = verdict_none;
+        std::size_t mNumBaseline        = 0;
+        std::size_t mNumCurrent         = 0;
+        double      mBaselineMedian_ns  = 0.0;
+        double      mCurrentMedian_ns   = 0.0;
+        double      mDelta              = 0.0;  // relative change in median; positive is slower
+        double      mP                  = 1.0;  // Mann-Whitney U, two-sided
+    };
+
+    // Identifies a kernel test across runs, from the fields results_sink writes for it
+    std::string kernel_key(const std::string& moduleName,
+                           const std::string& entryPoint,
+                           const std::string& workgroup,
+                           const std::string& arguments);
+
+    std::string kernel_key(const std::string& moduleName, const test_utils::KernelTest& kernelTest);
+
+    // Reads a results file in either of the formats results_sink writes
+    baseline_t read(std::istream& is, double threshold);
+
+    //
+    // A change is a regression or improvement only if it is both significant (p below 0.01) and
+    // larger than the threshold, so that neither noise nor trivial but consistent shifts are flagged.
+    //
+    comparison_t compare(const std::vector<double>& baseline, const std::vector<double>& current, double threshold);
+}
+
+#endif //CLSPVTEST_BASELINE_COMPARE_HPP
@@ -0,0 +1,201 @@
+//
+// Created by Eric Berdahl on 5/18/18.
+//
+
+#include "benchmark_stats.hpp"
+
+#include "random_utils.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <tuple>
+
+namespace {
+
+    // scales the MAD of normally distributed samples to their standard deviation
+    const double kMADScale = 0.6745;
+
+    // arbitrary, but fixed so that intervals are reproducible
+    const std::uint64_t kBootstrapSeed = 0x626f6f7473747261ull;
+    const std::uint64_t kBootstrapStream = 0x70206d65616e7300ull;
+
+    double mean(const std::vector<double>& samples) {
+        return std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+    }
+
+    double sample_variance(const std::vector<double>& samples, double mean) {
+        if (samples.size() < 2) return 0.0;
+
+        double sumSquares = 0.0;
+        for (double x : samples) {
+            sumSquares += (x - mean) * (x - mean);
+        }
+        return sumSquares / (samples.size() - 1);
+    }
+
+} // anonymous namespace
+
+namespace benchmark_stats {
+
+    double percentile(const std::vector<double>& sorted, double p) {
+        if (sorted.empty()) return 0.0;
+
+        const double rank = std::min(std::max(p, 0.0), 100.0) / 100.0 * (sorted.size() - 1);
+        const std::size_t below = static_cast<std::size_t>(rank);
+        const std::size_t above = std::min(below + 1, sorted.size() - 1);
+
+        return sorted[below] + (rank - below) * (sorted[above] - sorted[below]);
+    }
+
+    double median_absolute_deviation(const std::vector<double>& sorted) {
+        const double median = percentile(sorted, 50.0);
+
+        std::vector<double> deviations;
+        deviations.reserve(sorted.size());
+        for (double x : sorted) {
+            deviations.push_back(std::abs(x - median));
+        }
+        std::sort(deviations.begin(), deviations.end());
+
+        return percentile(deviations, 50.0);
+    }
+
+    std::pair<std::vector<double>, std::vector<double>> reject_outliers(const std::vector<double>& samples,
+                                                                         double threshold) {
+        std::vector<double> sorted(samples);
+        std::sort(sorted.begin(), sorted.end());
+
+        const double median = percentile(sorted, 50.0);
+        const double mad = median_absolute_deviation(sorted);
+
+        std::pair<std::vector<double>, std::vector<double>> result;
+        for (double x : samples) {
+            const bool isOutlier = (mad > 0.0 && kMADScale * std::abs(x - median) / mad > threshold);
+            (isOutlier ? result.second : result.first).push_back(x);
+        }
+
+        return result;
+    }
+
+    std::pair<double, double> bootstrap_mean_interval(const std::vector<double>& samples,
+                                                      double confidence,
+                                                      unsigned int numResamples) {
+        if (samples.empty()) return std::make_pair(0.0, 0.0);
+
+        const std::uint64_t n = samples.size();
+        const std::uint64_t countersPerResample = (n + 3) / 4;
+
+        random_utils::stream_t stream;
+        stream.mSeed = kBootstrapSeed;
+        stream.mStream = kBootstrapStream;
+
+        std::vector<double> means;
+        means.reserve(numResamples);
+
+        for (unsigned int r = 0; r < numResamples; ++r) {
+            double sum = 0.0;
+            for (std::uint64_t i = 0; i < n; i += 4) {
+                std::uint32_t bits[4];
+                random_utils::philox4x32(stream, r * countersPerResample + i / 4, bits);
+
+                for (std::uint64_t j = 0; j < 4 && i + j < n; ++j) {
+                    // maps 32 random bits onto [0, n) without division
+                    sum += samples[static_cast<std::size_t>((bits[j] * n) >> 32)];
+                }
+            }
+            means.push_back(sum / n);
+        }
+        std::sort(means.begin(), means.end());
+
+        const double tail = (1.0 - confidence) / 2.0 * 100.0;
+        return std::make_pair(percentile(means, tail), percentile(means, 100.0 - tail));
+    }
+
+    summary_t summarize(std::vector<double> samples) {
+        summary_t result;
+        result.mNumSamples = samples.size();
+        if (samples.empty()) return result;
+
+        const auto split = reject_outliers(samples);
+        const std::vector<double>& inliers = split.first;
+        result.mNumOutliers = split.second.size();
+
+        std::sort(samples.begin(), samples.end());
+        result.mMedian = percentile(samples, 50.0);
+        result.mP90 = percentile(samples, 90.0);
+        result.mP95 = percentile(samples, 95.0);
+        result.mP99 = percentile(samples, 99.0);
+        result.mMin = samples.front();
+        result.mMax = samples.back();
+
+        result.mMean = mean(inliers);
+        result.mVariance = sample_variance(inliers, result.mMean);
+        std::tie(result.mMeanLow, result.mMeanHigh) = bootstrap_mean_interval(inliers);
+
+        return result;
+    }
+
+    void add_sample(running_t& stats, double x) {
+        ++stats.mNumSamples;
+        const double delta = x - stats.mMean;
+        stats.mMean += delta / stats.mNumSamples;
+        stats.mSumSquares += delta * (x - stats.mMean);
+    }
+
+    double variance(const running_t& stats) {
+        return (stats.mNumSamples < 2 ? 0.0 : stats.mSumSquares / (stats.mNumSamples - 1));
+    }
+
+    double mean_half_width(const running_t& stats) {
+        return (stats.mNumSamples < 1 ? 0.0 : 1.96 * std::sqrt(variance(stats) / stats.mNumSamples));
+    }
+
+    rank_test_t mann_whitney_u(const std::vector<double>& a, const std::vector<double>& b) {
+        rank_test_t result;
+        if (a.empty() || b.empty()) return result;
+
+        // pairs of sample and whether it is from a
+        std::vector<std::pair<double, bool>> pooled;
+        pooled.reserve(a.size() + b.size());
+        for (double x : a) pooled.push_back(std::make_pair(x, true));
+        for (double x : b) pooled.push_back(std::make_pair(x, false));
+        std::sort(pooled.begin(), pooled.end());
+
+        const double n1 = a.size();
+        const double n2 = b.size();
+        const double n = n1 + n2;
+
+        // ties share the average of their ranks
+        double rankSumA = 0.0;
+        double tieSum = 0.0;
+        for (std::size_t i = 0; i < pooled.size(); ) {
+            std::size_t j = i;
+            while (j < pooled.size() && pooled[j].first == pooled[i].first) ++j;
+
+            const double averageRank = (i + 1 + j) / 2.0;
+            const double tied = j - i;
+            tieSum += tied * tied * tied - tied;
+
+            for (std::size_t k = i; k < j; ++k) {
+                if (pooled[k].second) rankSumA += averageRank;
+            }
+            i = j;
+        }
+
+        result.mU = rankSumA - n1 * (n1 + 1) / 2.0;
+
+        const double mean = n1 * n2 / 2.0;
+        const double variance = n1 * n2 / 12.0 * ((n + 1) - tieSum / (n * (n - 1)));
+        if (variance <= 0.0) return result;
+
+        const double difference = result.mU - mean;
+        const double corrected = std::max(std::abs(difference) - 0.5, 0.0);
+        result.mZ = (difference < 0.0 ? -corrected : corrected) / std::sqrt(variance);
+        result.mP = std::erfc(std::abs(result.mZ) / std::sqrt(2.0));
+
+        return result;
+    }
+
+}
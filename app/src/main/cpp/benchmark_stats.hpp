@@ -0,0 +1,85 @@
+//
+// Created by Eric Berdahl on 5/18/18.
+//
+
+#ifndef CLSPVTEST_BENCHMARK_STATS_HPP
+#define CLSPVTEST_BENCHMARK_STATS_HPP
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace benchmark_stats {
+
+    //
+    // Summary statistics of a set of timing samples. Order statistics (median, percentiles,
+    // minimum, maximum) describe every sample. The mean, variance and the confidence interval of the
+    // mean describe only the samples which are not outliers, so that a few iterations disturbed by
+    // the rest of the system do not swamp them.
+    //
+    struct summary_t {
+        std::size_t mNumSamples     = 0;
+        std::size_t mNumOutliers    = 0;
+
+        double      mMedian         = 0.0;
+        double      mP90            = 0.0;
+        double      mP95            = 0.0;
+        double      mP99            = 0.0;
+        double      mMin            = 0.0;
+        double      mMax            = 0.0;
+
+        double      mMean           = 0.0;
+        double      mVariance       = 0.0;
+        double      mMeanLow        = 0.0;  // bounds of the 95% confidence interval of the mean
+        double      mMeanHigh       = 0.0;
+    };
+
+    // Percentile p (in [0,100]) of sorted samples, interpolating linearly between closest ranks
+    double percentile(const std::vector<double>& sorted, double p);
+
+    double median_absolute_deviation(const std::vector<double>& sorted);
+
+    // Splits samples into those whose modified z-score (0.6745 * |x - median| / MAD, Iglewicz and
+    // Hoaglin) is at most threshold, and the outliers. Nothing is an outlier if the MAD is zero.
+    std::pair<std::vector<double>, std::vector<double>> reject_outliers(const std::vector<double>& samples,
+                                                                         double threshold = 3.5);
+
+    // Percentile bootstrap confidence interval of the mean. Resamples are drawn from a fixed
+    // Philox stream, so the same samples always produce the same interval.
+    std::pair<double, double> bootstrap_mean_interval(const std::vector<double>& samples,
+                                                      double confidence = 0.95,
+                                                      unsigned int numResamples = 1000);
+
+    summary_t summarize(std::vector<double> samples);
+
+    //
+    // Mean and variance of samples added one at a time (Welford's method), for decisions which are
+    // made again after every batch and so cannot afford to revisit, sort or resample every sample.
+    // Unlike summary_t, outliers are not rejected.
+    //
+    struct running_t {
+        std::size_t mNumSamples = 0;
+        double      mMean       = 0.0;
+        double      mSumSquares = 0.0;  // of differences from the mean
+    };
+
+    void add_sample(running_t& stats, double x);
+
+    double variance(const running_t& stats);
+
+    // Half-width of the normal-approximation 95% confidence interval of the mean, 1.96 s / sqrt(n)
+    double mean_half_width(const running_t& stats);
+
+    struct rank_test_t {
+        double      mU  = 0.0;  // of the first set of samples
+        double      mZ  = 0.0;  // positive when the first set tends to be larger
+        double      mP  = 1.0;  // two-sided
+    };
+
+    // Mann-Whitney U test of whether two sets of samples come from the same distribution, using the
+    // normal approximation with corrections for ties and continuity. Makes no assumption about the
+    // shape of the distributions, which for timings are seldom normal.
+    rank_test_t mann_whitney_u(const std::vector<double>& a, const std::vector<double>& b);
+}
+
+#endif //CLSPVTEST_BENCHMARK_STATS_HPP
@@ -0,0 +1,80 @@
+//
+// Created by Eric Berdahl on 5/18/18.
+//
+
+// Throughput of clspv_utils::hexToBytes against the substr/stoi loop it replaced, on one long
+// string (the vector path) and on many short ones (mostly the scalar tail).
+
+#include "micro_benchmark.hpp"
+
+#include "clspv_utils/hex_utils.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace {
+
+    // The decoder spvmap constants and generic kernel data used before hex_utils
+    std::vector<std::uint8_t> substr_stoi_hex_to_bytes(const std::string& hexString) {
+        std::vector<std::uint8_t> result;
+        result.reserve(hexString.length() / 2);
+
+        for (std::string::size_type i = 0; i < hexString.length(); i += 2) {
+            result.push_back(static_cast<std::uint8_t>(std::stoi(hexString.substr(i, 2), nullptr, 16)));
+        }
+
+        return result;
+    }
+
+    // numChars of mixed-case hex digits, the same on every run
+    std::string make_hex(std::size_t numChars) {
+        const char digits[] = "0123456789abcdefABCDEF";
+
+        std::string result(numChars, '0');
+        std::uint32_t state = 12345;
+        for (auto& c : result) {
+            state = state * 1664525u + 1013904223u;
+            c = digits[(state >> 16) % (sizeof(digits) - 1)];
+        }
+        return result;
+    }
+
+    template <typename Decode>
+    void run(const char* label, const std::vector<std::string>& inputs, unsigned int numIterations, Decode decode) {
+        std::size_t numBytes = 0;
+        for (auto& s : inputs) {
+            numBytes += s.size();
+        }
+
+        const double seconds = micro_benchmark::best_seconds_per_call([&inputs, decode]() {
+            for (auto& s : inputs) {
+                auto bytes = decode(s);
+                micro_benchmark::keep(bytes);
+            }
+        }, numIterations);
+
+        micro_benchmark::report(label, seconds, numBytes);
+    }
+
+}
+
+int main() {
+    const std::vector<std::string> longInput(1, make_hex(8 << 20));
+    const std::vector<std::string> shortInputs(65536, make_hex(48));
+
+    const auto hexToBytes = [](const std::string& s) { return clspv_utils::hexToBytes(s); };
+
+    if (hexToBytes(longInput.front()) != substr_stoi_hex_to_bytes(longInput.front())) {
+        std::printf("hexToBytes disagrees with the substr/stoi decoder\n");
+        return 1;
+    }
+
+    run("hexToBytes, 8 MiB string", longInput, 10, hexToBytes);
+    run("substr/stoi, 8 MiB string", longInput, 1, substr_stoi_hex_to_bytes);
+    run("hexToBytes, 64K x 48 chars", shortInputs, 10, hexToBytes);
+    run("substr/stoi, 64K x 48 chars", shortInputs, 1, substr_stoi_hex_to_bytes);
+
+    return 0;
+}
@@ -0,0 +1,89 @@
+//
+// Created by Eric Berdahl on 5/18/18.
+//
+
+// Cost of resolving kernel names through module_spec_t's index against a linear search of
+// mKernels, and of parsing a spvmap whose kernel lines are interleaved, so that nearly every line
+// names a different kernel from the line before it.
+
+#include "micro_benchmark.hpp"
+
+#include "clspv_utils/interface.hpp"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace {
+
+    const unsigned int kNumKernels = 2000;
+    const unsigned int kNumArgs = 8;
+
+    std::string kernel_name(unsigned int k) {
+        return "kernel_" + std::to_string(k);
+    }
+
+    // Every kernel's argument 0, then every kernel's argument 1, and so on
+    std::string make_interleaved_spvmap() {
+        std::string result;
+        for (unsigned int a = 0; a < kNumArgs; ++a) {
+            for (unsigned int k = 0; k < kNumKernels; ++k) {
+                result += "kernel," + kernel_name(k) + ",arg,";
+                if (0 == a) {
+                    result += "dst,argOrdinal,0,descriptorSet,0,binding,0,offset,0,argKind,buffer\n";
+                }
+                else {
+                    result += "pod" + std::to_string(a)
+                              + ",argOrdinal," + std::to_string(a)
+                              + ",descriptorSet,0,binding,1,offset," + std::to_string(4 * (a - 1))
+                              + ",argKind,pod_ubo\n";
+                }
+            }
+        }
+        return result;
+    }
+
+}
+
+int main() {
+    const std::string spvmap = make_interleaved_spvmap();
+    const char* first = spvmap.data();
+    const char* last = first + spvmap.size();
+
+    const double parseSeconds = micro_benchmark::best_seconds_per_call([first, last]() {
+        auto spec = clspv_utils::createModuleSpec(first, last);
+        micro_benchmark::keep(spec);
+    }, 20);
+    micro_benchmark::report("parse, interleaved kernel lines", parseSeconds, spvmap.size());
+
+    const clspv_utils::module_spec_t spec = clspv_utils::createModuleSpec(first, last);
+
+    std::vector<std::string> names;
+    for (unsigned int k = 0; k < kNumKernels; ++k) {
+        names.push_back(kernel_name(k));
+    }
+
+    for (auto& n : names) {
+        auto indexed = clspv_utils::findKernelSpec(n, spec);
+        if (!indexed || indexed != clspv_utils::findKernelSpec(n, spec.mKernels)) {
+            std::printf("indexed and linear lookups disagree on %s\n", n.c_str());
+            return 1;
+        }
+    }
+
+    const double indexedSeconds = micro_benchmark::best_seconds_per_call([&names, &spec]() {
+        for (auto& n : names) {
+            micro_benchmark::keep(clspv_utils::findKernelSpec(n, spec));
+        }
+    }, 100);
+    micro_benchmark::report("resolve 2000 names, indexed", indexedSeconds);
+
+    const double linearSeconds = micro_benchmark::best_seconds_per_call([&names, &spec]() {
+        for (auto& n : names) {
+            micro_benchmark::keep(clspv_utils::findKernelSpec(n, spec.mKernels));
+        }
+    }, 10);
+    micro_benchmark::report("resolve 2000 names, linear", linearSeconds);
+
+    return 0;
+}
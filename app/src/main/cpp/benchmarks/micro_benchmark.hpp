@@ -0,0 +1,56 @@
+//
+// Created by Eric Berdahl on 5/18/18.
+//
+
+#ifndef CLSPVTEST_MICRO_BENCHMARK_HPP
+#define CLSPVTEST_MICRO_BENCHMARK_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+
+namespace micro_benchmark {
+
+    //
+    // Keeps the compiler from discarding a result the benchmark never otherwise reads
+    //
+    template <typename T>
+    inline void keep(const T& value) {
+        asm volatile("" : : "g"(&value) : "memory");
+    }
+
+    //
+    // Best time in seconds of fn over numTrials trials of numIterations calls each, divided by
+    // numIterations. The best trial is the one least disturbed by the rest of the system.
+    //
+    template <typename Fn>
+    double best_seconds_per_call(Fn fn, unsigned int numIterations, unsigned int numTrials = 5) {
+        typedef std::chrono::steady_clock clock;
+
+        double best = 0.0;
+        for (unsigned int trial = 0; trial < numTrials; ++trial) {
+            const auto start = clock::now();
+            for (unsigned int i = 0; i < numIterations; ++i) {
+                fn();
+            }
+            const std::chrono::duration<double> elapsed = clock::now() - start;
+            const double perCall = elapsed.count() / numIterations;
+            best = (0 == trial ? perCall : std::min(best, perCall));
+        }
+        return best;
+    }
+
+    inline void report(const char* label, double secondsPerCall, std::size_t bytesPerCall = 0) {
+        if (bytesPerCall > 0) {
+            std::printf("%-40s %12.3f us  %9.1f MB/s\n",
+                        label, secondsPerCall * 1.0e6, bytesPerCall / secondsPerCall / 1.0e6);
+        }
+        else {
+            std::printf("%-40s %12.3f us\n", label, secondsPerCall * 1.0e6);
+        }
+    }
+
+}
+
+#endif //CLSPVTEST_MICRO_BENCHMARK_HPP
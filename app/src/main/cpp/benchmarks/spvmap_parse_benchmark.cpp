@@ -0,0 +1,115 @@
+//
+// Created by Eric Berdahl on 5/18/18.
+//
+
+// Throughput of the CSV spvmap parser, createModuleSpec(first, last), on a map the size of the
+// ones the app ships and on a synthetic map large enough to time reliably, with LF and with CRLF
+// line endings.
+
+#include "micro_benchmark.hpp"
+
+#include "clspv_utils/interface.hpp"
+
+#include <cstddef>
+#include <cstdio>
+#include <string>
+
+namespace {
+
+    const char* const kSamplerLines[] = {
+        "sampler,34,samplerExpr,\"CLK_ADDRESS_CLAMP_TO_EDGE|CLK_FILTER_LINEAR|CLK_NORMALIZED_COORDS_FALSE\",descriptorSet,0,binding,0",
+        "sampler,18,samplerExpr,\"CLK_ADDRESS_CLAMP_TO_EDGE|CLK_FILTER_NEAREST|CLK_NORMALIZED_COORDS_FALSE\",descriptorSet,0,binding,1",
+        "sampler,16,samplerExpr,\"CLK_ADDRESS_NONE|CLK_FILTER_NEAREST|CLK_NORMALIZED_COORDS_FALSE\",descriptorSet,0,binding,2",
+    };
+
+    // A spvmap with numKernels kernels, each with one buffer argument and seven pod arguments,
+    // laid out as clspv writes them: every argument of a kernel before the next kernel.
+    std::string make_spvmap(unsigned int numKernels, const std::string& eol) {
+        std::string result;
+        for (auto line : kSamplerLines) {
+            result += line;
+            result += eol;
+        }
+
+        for (unsigned int k = 0; k < numKernels; ++k) {
+            const std::string prefix = "kernel,kernel_" + std::to_string(k) + ",arg,";
+            result += prefix + "dst,argOrdinal,0,descriptorSet,1,binding,0,offset,0,argKind,buffer" + eol;
+            for (unsigned int a = 1; a < 8; ++a) {
+                result += prefix + "pod" + std::to_string(a)
+                          + ",argOrdinal," + std::to_string(a)
+                          + ",descriptorSet,1,binding,1,offset," + std::to_string(4 * (a - 1))
+                          + ",argKind,pod_ubo" + eol;
+            }
+        }
+
+        return result;
+    }
+
+    bool same_interface(const clspv_utils::module_spec_t& a, const clspv_utils::module_spec_t& b) {
+        if (a.mSamplers.size() != b.mSamplers.size() || a.mKernels.size() != b.mKernels.size()) {
+            return false;
+        }
+
+        for (std::size_t i = 0; i < a.mSamplers.size(); ++i) {
+            if (a.mSamplers[i].mOpenclFlags != b.mSamplers[i].mOpenclFlags
+                || a.mSamplers[i].mBinding != b.mSamplers[i].mBinding) {
+                return false;
+            }
+        }
+
+        for (std::size_t k = 0; k < a.mKernels.size(); ++k) {
+            const auto& argsA = a.mKernels[k].mArguments;
+            const auto& argsB = b.mKernels[k].mArguments;
+            if (a.mKernels[k].mName != b.mKernels[k].mName || argsA.size() != argsB.size()) {
+                return false;
+            }
+            for (std::size_t i = 0; i < argsA.size(); ++i) {
+                if (argsA[i].mKind != argsB[i].mKind
+                    || argsA[i].mOrdinal != argsB[i].mOrdinal
+                    || argsA[i].mBinding != argsB[i].mBinding
+                    || argsA[i].mOffset != argsB[i].mOffset) {
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    void run(const char* label, const std::string& spvmap, unsigned int numIterations) {
+        const char* first = spvmap.data();
+        const char* last = first + spvmap.size();
+
+        const double seconds = micro_benchmark::best_seconds_per_call([first, last]() {
+            auto spec = clspv_utils::createModuleSpec(first, last);
+            micro_benchmark::keep(spec);
+        }, numIterations);
+
+        micro_benchmark::report(label, seconds, spvmap.size());
+    }
+
+}
+
+int main() {
+    const std::string shippedSize = make_spvmap(1, "\n");
+    const std::string synthetic = make_spvmap(2000, "\n");
+    const std::string syntheticCrlf = make_spvmap(2000, "\r\n");
+
+    // CRLF must parse to the same interface as LF, or its timing means nothing
+    const auto lfSpec = clspv_utils::createModuleSpec(synthetic.data(), synthetic.data() + synthetic.size());
+    const auto crlfSpec = clspv_utils::createModuleSpec(syntheticCrlf.data(),
+                                                        syntheticCrlf.data() + syntheticCrlf.size());
+    if (!same_interface(lfSpec, crlfSpec)) {
+        std::printf("CRLF spvmap parses differently from LF\n");
+        return 1;
+    }
+
+    std::printf("shipped-size spvmap: %zu bytes, synthetic spvmap: %zu bytes\n",
+                shippedSize.size(), synthetic.size());
+
+    run("createModuleSpec, shipped size", shippedSize, 10000);
+    run("createModuleSpec, 2000 kernels x 8 args", synthetic, 20);
+    run("createModuleSpec, same with CRLF", syntheticCrlf, 20);
+
+    return 0;
+}
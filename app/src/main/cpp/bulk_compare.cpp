@@ -0,0 +1,190 @@
+//
+// Created by Eric Berdahl on 5/18/18.
+//
+
+#include "bulk_compare.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define CLSPVTEST_BULK_COMPARE_SSE2 1
+#elif defined(__aarch64__)
+// 32-bit ARM NEON flushes float denormals to zero, so only arm64 uses the vector path
+#include <arm_neon.h>
+#define CLSPVTEST_BULK_COMPARE_NEON 1
+#endif
+
+namespace {
+
+    // number of half components converted to float at a time
+    const std::size_t kHalfChunkSize = 256;
+
+    //
+    // fp_utils::almost_equal, evaluated in float with the epsilon and minimum normal value of the
+    // original type. (half arithmetic in half.hpp is carried out in float, so this reproduces the
+    // half comparison exactly.)
+    //
+    void compare_floats(const float*    expected,
+                        const float*    observed,
+                        std::size_t     count,
+                        float           epsilon,
+                        float           minNormal,
+                        int             ulp,
+                        std::uint8_t*   isEqual) {
+        std::size_t i = 0;
+
+#if CLSPVTEST_BULK_COMPARE_SSE2
+        const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+        const __m128 epsilonV = _mm_set1_ps(epsilon);
+        const __m128 minNormalV = _mm_set1_ps(minNormal);
+        const __m128 ulpV = _mm_set1_ps(static_cast<float>(ulp));
+
+        for (; i + 4 <= count; i += 4) {
+            const __m128 x = _mm_loadu_ps(expected + i);
+            const __m128 y = _mm_loadu_ps(observed + i);
+
+            const __m128 diff = _mm_and_ps(_mm_sub_ps(x, y), absMask);
+            const __m128 tolerance = _mm_mul_ps(_mm_mul_ps(epsilonV, _mm_and_ps(_mm_add_ps(x, y), absMask)), ulpV);
+            const int mask = _mm_movemask_ps(_mm_or_ps(_mm_cmplt_ps(diff, tolerance), _mm_cmplt_ps(diff, minNormalV)));
+
+            isEqual[i + 0] = static_cast<std::uint8_t>(mask & 1);
+            isEqual[i + 1] = static_cast<std::uint8_t>((mask >> 1) & 1);
+            isEqual[i + 2] = static_cast<std::uint8_t>((mask >> 2) & 1);
+            isEqual[i + 3] = static_cast<std::uint8_t>((mask >> 3) & 1);
+        }
+#elif CLSPVTEST_BULK_COMPARE_NEON
+        const float32x4_t epsilonV = vdupq_n_f32(epsilon);
+        const float32x4_t minNormalV = vdupq_n_f32(minNormal);
+        const float32x4_t ulpV = vdupq_n_f32(static_cast<float>(ulp));
+
+        for (; i + 4 <= count; i += 4) {
+            const float32x4_t x = vld1q_f32(expected + i);
+            const float32x4_t y = vld1q_f32(observed + i);
+
+            const float32x4_t diff = vabsq_f32(vsubq_f32(x, y));
+            const float32x4_t tolerance = vmulq_f32(vmulq_f32(epsilonV, vabsq_f32(vaddq_f32(x, y))), ulpV);
+            const uint32x4_t ok = vorrq_u32(vcltq_f32(diff, tolerance), vcltq_f32(diff, minNormalV));
+
+            std::uint32_t flags[4];
+            vst1q_u32(flags, vandq_u32(ok, vdupq_n_u32(1)));
+            for (int k = 0; k < 4; ++k) isEqual[i + k] = static_cast<std::uint8_t>(flags[k]);
+        }
+#endif
+
+        for (; i < count; ++i) {
+            const float x = expected[i];
+            const float y = observed[i];
+            const float diff = std::abs(x - y);
+            isEqual[i] = (diff < epsilon * std::abs(x + y) * ulp || diff < minNormal);
+        }
+    }
+
+} // anonymous namespace
+
+namespace bulk_compare {
+
+    void compare_components(const float*   expected,
+                            const float*   observed,
+                            std::size_t    count,
+                            int            ulp,
+                            std::uint8_t*  isEqual) {
+        compare_floats(expected, observed, count,
+                       std::numeric_limits<float>::epsilon(),
+                       std::numeric_limits<float>::min(),
+                       ulp,
+                       isEqual);
+    }
+
+    void compare_components(const gpu_types::half*  expected,
+                            const gpu_types::half*  observed,
+                            std::size_t             count,
+                            int                     ulp,
+                            std::uint8_t*           isEqual) {
+        const float epsilon = std::numeric_limits<gpu_types::half>::epsilon();
+        const float minNormal = std::numeric_limits<gpu_types::half>::min();
+
+        float expectedFloats[kHalfChunkSize];
+        float observedFloats[kHalfChunkSize];
+
+        for (std::size_t first = 0; first < count; first += kHalfChunkSize) {
+            const std::size_t chunk = std::min(kHalfChunkSize, count - first);
+
+            for (std::size_t i = 0; i < chunk; ++i) {
+                expectedFloats[i] = expected[first + i];
+                observedFloats[i] = observed[first + i];
+            }
+
+            compare_floats(expectedFloats, observedFloats, chunk, epsilon, minNormal, ulp, isEqual + first);
+        }
+    }
+
+    void compare_components(const gpu_types::uchar* expected,
+                            const gpu_types::uchar* observed,
+                            std::size_t             count,
+                            std::uint8_t*           isEqual) {
+        std::size_t i = 0;
+
+        // because rounding modes in Vulkan are undefined, unknowable, and unsettable, we need to
+        // tolerate off-by-one differences in integral components
+#if CLSPVTEST_BULK_COMPARE_SSE2
+        const __m128i one = _mm_set1_epi8(1);
+
+        for (; i + 16 <= count; i += 16) {
+            const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(expected + i));
+            const __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(observed + i));
+
+            const __m128i diff = _mm_or_si128(_mm_subs_epu8(x, y), _mm_subs_epu8(y, x));
+            const __m128i ok = _mm_cmpeq_epi8(_mm_min_epu8(diff, one), diff);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(isEqual + i), _mm_and_si128(ok, one));
+        }
+#elif CLSPVTEST_BULK_COMPARE_NEON
+        const uint8x16_t one = vdupq_n_u8(1);
+
+        for (; i + 16 <= count; i += 16) {
+            const uint8x16_t diff = vabdq_u8(vld1q_u8(expected + i), vld1q_u8(observed + i));
+            vst1q_u8(isEqual + i, vandq_u8(vcleq_u8(diff, one), one));
+        }
+#endif
+
+        for (; i < count; ++i) {
+            isEqual[i] = (std::abs(static_cast<int>(expected[i]) - static_cast<int>(observed[i])) <= 1);
+        }
+    }
+
+    void compare_components(const std::int32_t* expected,
+                            const std::int32_t* observed,
+                            std::size_t         count,
+                            std::uint8_t*       isEqual) {
+        std::size_t i = 0;
+
+#if CLSPVTEST_BULK_COMPARE_SSE2
+        for (; i + 4 <= count; i += 4) {
+            const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(expected + i));
+            const __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(observed + i));
+            const int mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(x, y)));
+
+            isEqual[i + 0] = static_cast<std::uint8_t>(mask & 1);
+            isEqual[i + 1] = static_cast<std::uint8_t>((mask >> 1) & 1);
+            isEqual[i + 2] = static_cast<std::uint8_t>((mask >> 2) & 1);
+            isEqual[i + 3] = static_cast<std::uint8_t>((mask >> 3) & 1);
+        }
+#elif CLSPVTEST_BULK_COMPARE_NEON
+        for (; i + 4 <= count; i += 4) {
+            const uint32x4_t ok = vceqq_s32(vld1q_s32(expected + i), vld1q_s32(observed + i));
+
+            std::uint32_t flags[4];
+            vst1q_u32(flags, vandq_u32(ok, vdupq_n_u32(1)));
+            for (int k = 0; k < 4; ++k) isEqual[i + k] = static_cast<std::uint8_t>(flags[k]);
+        }
+#endif
+
+        for (; i < count; ++i) {
+            isEqual[i] = (expected[i] == observed[i]);
+        }
+    }
+
+}
@@ -0,0 +1,48 @@
+//
+// Created by Eric Berdahl on 5/18/18.
+//
+
+#ifndef CLSPVTEST_BULK_COMPARE_HPP
+#define CLSPVTEST_BULK_COMPARE_HPP
+
+#include "gpu_types.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace bulk_compare {
+
+    //
+    // Component-wise comparison of runs of pixel components, with the same tolerances as
+    // test_utils::pixel_compare. For each i in [0, count), isEqual[i] is set to 1 if expected[i]
+    // and observed[i] compare equal, and to 0 otherwise.
+    //
+    // The float and half comparisons are the ULP comparison of fp_utils::almost_equal; the uchar
+    // comparison tolerates off-by-one differences. Runs are compared with SSE2 (x86) or NEON
+    // (arm) where available.
+    //
+
+    void compare_components(const float*       expected,
+                            const float*       observed,
+                            std::size_t        count,
+                            int                ulp,
+                            std::uint8_t*      isEqual);
+
+    void compare_components(const gpu_types::half*  expected,
+                            const gpu_types::half*  observed,
+                            std::size_t             count,
+                            int                     ulp,
+                            std::uint8_t*           isEqual);
+
+    void compare_components(const gpu_types::uchar* expected,
+                            const gpu_types::uchar* observed,
+                            std::size_t             count,
+                            std::uint8_t*           isEqual);
+
+    void compare_components(const std::int32_t* expected,
+                            const std::int32_t* observed,
+                            std::size_t         count,
+                            std::uint8_t*       isEqual);
+}
+
+#endif //CLSPVTEST_BULK_COMPARE_HPP
@@ -17,6 +17,7 @@
  * limitations under the License.
  */
 
+#include "baseline_compare.hpp"
 #include "test_manifest.hpp"
 #include "test_result_logging.hpp"
 #include "test_utils.hpp"
@@ -27,6 +28,7 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cstring>
 #include <fstream>
 #include <iostream>
 #include <string>
@@ -131,6 +133,31 @@ void init_compute_queue_family_index(struct sample_info &info) {
     info.graphics_queue_family_properties = queue_props[info.graphics_queue_family_index];
 }
 
+bool supports_calibrated_timestamps(struct sample_info &info) {
+    /* VK_EXT_calibrated_timestamps helps only if it can relate the device's timestamps to
+     * CLOCK_MONOTONIC, which is the host clock the tests time with.
+     */
+
+    const auto extensions = info.gpu.enumerateDeviceExtensionProperties();
+    const bool hasExtension = std::any_of(extensions.begin(), extensions.end(), [](const vk::ExtensionProperties& p) {
+        return (0 == std::strcmp(p.extensionName, VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME));
+    });
+    if (!hasExtension) return false;
+
+    auto getTimeDomains = (PFN_vkGetPhysicalDeviceCalibrateableTimeDomainsEXT) info.inst->getProcAddr("vkGetPhysicalDeviceCalibrateableTimeDomainsEXT");
+    if (!getTimeDomains) return false;
+
+    uint32_t numDomains = 0;
+    if (VK_SUCCESS != getTimeDomains((VkPhysicalDevice)info.gpu, &numDomains, nullptr)) return false;
+
+    std::vector<VkTimeDomainEXT> domains(numDomains);
+    if (VK_SUCCESS != getTimeDomains((VkPhysicalDevice)info.gpu, &numDomains, domains.data())) return false;
+    domains.resize(numDomains);
+
+    return (std::count(domains.begin(), domains.end(), VK_TIME_DOMAIN_DEVICE_EXT) > 0 &&
+            std::count(domains.begin(), domains.end(), VK_TIME_DOMAIN_CLOCK_MONOTONIC_EXT) > 0);
+}
+
 void my_init_descriptor_pool(struct sample_info &info) {
     const vk::DescriptorPoolSize type_count[] = {
         { vk::DescriptorType::eStorageBuffer,   16 },
@@ -221,9 +248,21 @@ int sample_main(int argc, char *argv[]) {
     // The clspv solution we're using requires two Vulkan extensions to be enabled.
     info.device_extension_names.push_back("VK_KHR_storage_buffer_storage_class");
     info.device_extension_names.push_back("VK_KHR_variable_pointers");
+
+    // Without calibrated timestamps, device timestamps are related to the host clock by submission.
+    const bool calibratedTimestamps = supports_calibrated_timestamps(info);
+    if (calibratedTimestamps) {
+        info.device_extension_names.push_back(VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME);
+    }
     init_device(info);
     init_device_queue(info);
 
+    PFN_vkGetCalibratedTimestampsEXT getCalibratedTimestamps = nullptr;
+    if (calibratedTimestamps) {
+        getCalibratedTimestamps = (PFN_vkGetCalibratedTimestampsEXT) info.device->getProcAddr("vkGetCalibratedTimestampsEXT");
+    }
+    LOGI("timestamps calibrated %s", getCalibratedTimestamps ? "by " VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME : "by submission");
+
     init_command_pool(info);
     my_init_descriptor_pool(info);
 
@@ -235,10 +274,33 @@ int sample_main(int argc, char *argv[]) {
                                *info.device,
                                *info.desc_pool,
                                *info.cmd_pool,
-                               info.graphics_queue);
+                               info.graphics_queue,
+                               info.graphics_queue_family_index,
+                               getCalibratedTimestamps);
 
     const auto results = test_manifest::run(manifest, device);
-    test_result_logging::logResults(info, results);
+
+    unsigned int numRegressions = 0;
+    bool baselineMissing = false;
+    if (manifest.baseline_path.empty()) {
+        test_result_logging::logResults(info, results);
+    }
+    else {
+        // the baseline is a results file from an earlier run, kept in the application's data directory
+        const std::string baselinePath = std::string(AndroidGetInternalDataPath()) + "/" + manifest.baseline_path;
+        std::ifstream in(baselinePath);
+        if (!in) {
+            LOGE("cannot read baseline %s", baselinePath.c_str());
+        }
+
+        const auto baseline = baseline_compare::read(in, manifest.regression_threshold);
+        if (baseline.mExecutionTimes_ns.empty()) {
+            LOGE("baseline %s has no timed kernels to compare against", baselinePath.c_str());
+            baselineMissing = true;
+        }
+
+        numRegressions = test_result_logging::logResults(info, results, baseline);
+    }
 
     //
     // Clean up
@@ -251,5 +313,8 @@ int sample_main(int argc, char *argv[]) {
 
     LOGI("ClspvTest complete!!");
 
-    return 0;
+    // A nonzero status tells automation that performance regressed against the baseline, or that
+    // nothing could be compared against it, which must not pass for a clean comparison
+    if (baselineMissing) return 3;
+    return (numRegressions > 0 ? 2 : 0);
 }
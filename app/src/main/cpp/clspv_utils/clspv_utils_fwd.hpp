@@ -12,6 +12,7 @@ namespace clspv_utils {
     class invocation;
     class kernel;
     class module;
+    class module_cache;
 
     struct execution_time_t;
     struct kernel_req_t;
@@ -7,6 +7,7 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace clspv_utils {
@@ -19,6 +20,9 @@ namespace clspv_utils {
 
     using string = std::string;
 
+    template <typename T, typename U>
+    using unordered_map = std::unordered_map<T, U>;
+
     template <typename T>
     using vector = std::vector<T>;
 
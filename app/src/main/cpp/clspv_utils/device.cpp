@@ -4,6 +4,7 @@
 
 #include "device.hpp"
 
+#include "hash_utils.hpp"
 #include "interface.hpp"
 
 #include <cassert>
@@ -12,60 +13,13 @@
 namespace {
     using namespace clspv_utils;
 
-    //
-    // boost_* code heavily borrowed from Boost 1.65.0
-    // Ideally, we'd just use boost directly (that's what it's for, after all). However, it's a lot
-    // to pick up, just for these functions and for what is intened to be a simple library.
-    //
-
-    template <typename SizeT>
-    void boost_hash_combine_impl(SizeT& seed, SizeT value)
-    {
-        seed ^= value + 0x9e3779b9 + (seed<<6) + (seed>>2);
-    }
-
-    std::uint32_t boost_functional_hash_rotl32(std::uint32_t x, unsigned int r) {
-        return (x << r) | (x >> (32 - r));
-    }
-
-    void boost_hash_combine_impl(std::uint32_t& h1, std::uint32_t k1)
-    {
-        const uint32_t c1 = 0xcc9e2d51;
-        const uint32_t c2 = 0x1b873593;
-
-        k1 *= c1;
-        k1 = boost_functional_hash_rotl32(k1,15);
-        k1 *= c2;
-
-        h1 ^= k1;
-        h1 = boost_functional_hash_rotl32(h1,13);
-        h1 = h1*5+0xe6546b64;
-    }
-
-    void boost_hash_combine_impl(std::uint64_t& h, std::uint64_t k)
-    {
-        const std::uint64_t m = 0xc6a4a7935bd1e995ULL;
-        const int r = 47;
-
-        k *= m;
-        k ^= k >> r;
-        k *= m;
-
-        h ^= k;
-        h *= m;
-
-        // Completely arbitrary number, to prevent 0's
-        // from hashing to 0.
-        h += 0xe6546b64;
-    }
-
     std::size_t compute_hash(const vk::ArrayProxy<const sampler_spec_t>& samplers)
     {
         std::size_t result = 0;
 
         for (auto& s : samplers)
         {
-            boost_hash_combine_impl(result, std::hash<int>{}(s.mOpenclFlags));
+            detail::boost_hash_combine_impl(result, std::hash<int>{}(s.mOpenclFlags));
         }
 
         return result;
@@ -90,16 +44,52 @@ namespace clspv_utils {
                    vk::Device                           device,
                    vk::DescriptorPool                   descriptorPool,
                    vk::CommandPool                      commandPool,
-                   vk::Queue                            computeQueue)
+                   vk::Queue                            computeQueue,
+                   std::uint32_t                        computeQueueFamily,
+                   PFN_vkGetCalibratedTimestampsEXT     getCalibratedTimestamps)
             : mPhysicalDevice(physicalDevice),
               mDevice(device),
               mMemoryProperties(physicalDevice.getMemoryProperties()),
               mDescriptorPool(descriptorPool),
               mCommandPool(commandPool),
               mComputeQueue(computeQueue),
+              mProperties(physicalDevice.getProperties()),
+              mComputeQueueFamilyProperties(physicalDevice.getQueueFamilyProperties().at(computeQueueFamily)),
+              mGetCalibratedTimestamps(getCalibratedTimestamps),
               mSamplerCache(new sampler_cache),
-              mSamplerDescriptorCache(new descriptor_cache)
+              mSamplerDescriptorCache(new descriptor_cache),
+              mCalibrationCache(new calibration_cache)
+    {
+    }
+
+    vulkan_utils::timestamp_calibration_t device::calibrateTimestamps() const
+    {
+        assert(mCalibrationCache);
+
+        vulkan_utils::timestamp_calibration_t calibration;
+        if (mGetCalibratedTimestamps) {
+            calibration = vulkan_utils::calibrate_timestamps(mDevice,
+                                                             mGetCalibratedTimestamps,
+                                                             mProperties,
+                                                             mComputeQueueFamilyProperties);
+        }
+
+        if (!calibration.mIsValid) {
+            calibration = vulkan_utils::calibrate_timestamps_by_submission(mDevice,
+                                                                           mCommandPool,
+                                                                           mComputeQueue,
+                                                                           mProperties,
+                                                                           mComputeQueueFamilyProperties);
+        }
+
+        mCalibrationCache->mCalibration = calibration;
+        return calibration;
+    }
+
+    vulkan_utils::timestamp_calibration_t device::getTimestampCalibration() const
     {
+        assert(mCalibrationCache);
+        return mCalibrationCache->mCalibration;
     }
 
     vk::Sampler device::getCachedSampler(int opencl_flags)
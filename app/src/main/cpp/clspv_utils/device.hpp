@@ -14,6 +14,8 @@
 
 #include <memory>
 
+#include "vulkan_utils/vulkan_utils.hpp"
+
 namespace clspv_utils {
 
     class device {
@@ -24,15 +26,21 @@ namespace clspv_utils {
             vk::DescriptorSetLayout mLayout;
         };
 
+        // descriptor groups keyed by the descriptor set number they are bound to
+        typedef map<int, descriptor_group> descriptor_group_map;
+
         typedef vk::ArrayProxy<const sampler_spec_t> sampler_list_proxy;
 
         device() {}
 
-        device(vk::PhysicalDevice   physicalDevice,
-               vk::Device           device,
-               vk::DescriptorPool   descriptorPool,
-               vk::CommandPool      commandPool,
-               vk::Queue            computeQueue);
+        // getCalibratedTimestamps is null unless VK_EXT_calibrated_timestamps is enabled on device
+        device(vk::PhysicalDevice               physicalDevice,
+               vk::Device                       device,
+               vk::DescriptorPool               descriptorPool,
+               vk::CommandPool                  commandPool,
+               vk::Queue                        computeQueue,
+               std::uint32_t                    computeQueueFamily,
+               PFN_vkGetCalibratedTimestampsEXT getCalibratedTimestamps = nullptr);
 
         vk::PhysicalDevice  getPhysicalDevice() const { return mPhysicalDevice; }
         vk::Device          getDevice() const { return mDevice; }
@@ -41,6 +49,19 @@ namespace clspv_utils {
         vk::Queue           getComputeQueue() const { return mComputeQueue; }
 
         const vk::PhysicalDeviceMemoryProperties&   getMemoryProperties() const { return mMemoryProperties; }
+        const vk::PhysicalDeviceProperties&         getProperties() const { return mProperties; }
+        const vk::QueueFamilyProperties&            getComputeQueueFamilyProperties() const { return mComputeQueueFamilyProperties; }
+
+        //
+        // Relates the compute queue's timestamps to host time afresh, and keeps the result for
+        // getTimestampCalibration in this device and all copies of it. Without
+        // VK_EXT_calibrated_timestamps this submits work, so the queue must be idle and callers
+        // calibrate once per batch of runs rather than once per run.
+        //
+        vulkan_utils::timestamp_calibration_t   calibrateTimestamps() const;
+
+        // The calibration last made by calibrateTimestamps; not valid if there has been none
+        vulkan_utils::timestamp_calibration_t   getTimestampCalibration() const;
 
         vk::Sampler                     getCachedSampler(int opencl_flags);
 
@@ -61,6 +82,11 @@ namespace clspv_utils {
         typedef map<std::size_t, unique_descriptor_group> descriptor_cache;
         typedef map<int, vk::UniqueSampler> sampler_cache;
 
+        struct calibration_cache
+        {
+            vulkan_utils::timestamp_calibration_t   mCalibration;
+        };
+
     private:
         vk::PhysicalDevice                  mPhysicalDevice;
         vk::Device                          mDevice;
@@ -68,9 +94,13 @@ namespace clspv_utils {
         vk::DescriptorPool                  mDescriptorPool;
         vk::CommandPool                     mCommandPool;
         vk::Queue                           mComputeQueue;
+        vk::PhysicalDeviceProperties        mProperties;
+        vk::QueueFamilyProperties           mComputeQueueFamilyProperties;
+        PFN_vkGetCalibratedTimestampsEXT    mGetCalibratedTimestamps    = nullptr;
 
         shared_ptr<descriptor_cache>        mSamplerDescriptorCache;
         shared_ptr<sampler_cache>           mSamplerCache;
+        shared_ptr<calibration_cache>       mCalibrationCache;
     };
 
     vk::UniqueDescriptorSet allocateDescriptorSet(const device&           inDevice,
@@ -0,0 +1,95 @@
+//
+// Created by Eric Berdahl on 5/14/18.
+//
+
+#ifndef CLSPVUTILS_HASH_UTILS_HPP
+#define CLSPVUTILS_HASH_UTILS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace clspv_utils {
+
+    namespace detail {
+
+        //
+        // boost_* code heavily borrowed from Boost 1.65.0
+        // Ideally, we'd just use boost directly (that's what it's for, after all). However, it's a lot
+        // to pick up, just for these functions and for what is intened to be a simple library.
+        //
+
+        template <typename SizeT>
+        inline void boost_hash_combine_impl(SizeT& seed, SizeT value)
+        {
+            seed ^= value + 0x9e3779b9 + (seed<<6) + (seed>>2);
+        }
+
+        inline std::uint32_t boost_functional_hash_rotl32(std::uint32_t x, unsigned int r) {
+            return (x << r) | (x >> (32 - r));
+        }
+
+        inline void boost_hash_combine_impl(std::uint32_t& h1, std::uint32_t k1)
+        {
+            const uint32_t c1 = 0xcc9e2d51;
+            const uint32_t c2 = 0x1b873593;
+
+            k1 *= c1;
+            k1 = boost_functional_hash_rotl32(k1,15);
+            k1 *= c2;
+
+            h1 ^= k1;
+            h1 = boost_functional_hash_rotl32(h1,13);
+            h1 = h1*5+0xe6546b64;
+        }
+
+        inline void boost_hash_combine_impl(std::uint64_t& h, std::uint64_t k)
+        {
+            const std::uint64_t m = 0xc6a4a7935bd1e995ULL;
+            const int r = 47;
+
+            k *= m;
+            k ^= k >> r;
+            k *= m;
+
+            h ^= k;
+            h *= m;
+
+            // Completely arbitrary number, to prevent 0's
+            // from hashing to 0.
+            h += 0xe6546b64;
+        }
+
+    } // namespace detail
+
+    //
+    // 64-bit hash of a block of memory, suitable for keying caches by content. The hash is the
+    // same on 32-bit and 64-bit targets.
+    //
+    inline std::uint64_t computeContentHash(const void* data, std::size_t numBytes, std::uint64_t seed = 0)
+    {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+
+        std::uint64_t result = seed;
+        detail::boost_hash_combine_impl(result, static_cast<std::uint64_t>(numBytes));
+
+        for (; numBytes >= sizeof(std::uint64_t); numBytes -= sizeof(std::uint64_t), bytes += sizeof(std::uint64_t))
+        {
+            std::uint64_t word;
+            std::memcpy(&word, bytes, sizeof(word));
+            detail::boost_hash_combine_impl(result, word);
+        }
+
+        if (numBytes > 0)
+        {
+            std::uint64_t word = 0;
+            std::memcpy(&word, bytes, numBytes);
+            detail::boost_hash_combine_impl(result, word);
+        }
+
+        return result;
+    }
+
+} // namespace clspv_utils
+
+#endif //CLSPVUTILS_HASH_UTILS_HPP
@@ -0,0 +1,166 @@
+//
+// Created by Eric Berdahl on 5/17/18.
+//
+
+#include "hex_utils.hpp"
+
+#include <cstddef>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define CLSPVUTILS_HEX_SSE2 1
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define CLSPVUTILS_HEX_NEON 1
+#endif
+
+namespace {
+    using namespace clspv_utils;
+
+    // each vector step consumes 32 characters and produces 16 bytes
+    const std::size_t kVectorChars = 32;
+
+    // maps every byte value to its hex digit value, or to -1 if it is not a hex digit
+    class nibble_table {
+    public:
+        nibble_table() {
+            for (int c = 0; c < 256; ++c) {
+                if ('0' <= c && c <= '9')       mValues[c] = static_cast<std::int8_t>(c - '0');
+                else if ('a' <= c && c <= 'f')  mValues[c] = static_cast<std::int8_t>(c - 'a' + 10);
+                else if ('A' <= c && c <= 'F')  mValues[c] = static_cast<std::int8_t>(c - 'A' + 10);
+                else                            mValues[c] = -1;
+            }
+        }
+
+        int operator[](char c) const { return mValues[static_cast<unsigned char>(c)]; }
+
+    private:
+        std::int8_t mValues[256];
+    };
+
+    const nibble_table& get_nibble_table() {
+        static const nibble_table table;
+        return table;
+    }
+
+#if CLSPVUTILS_HEX_SSE2
+    // Returns the nibble value of each character in the low 4 bits of each byte. Characters which
+    // are not hex digits clear their bit in *validMask.
+    __m128i decode_nibbles(__m128i chars, int* validMask) {
+        // ASCII digits are all positive as signed bytes, so signed compares reject bytes >= 0x80
+        const __m128i isDigit = _mm_and_si128(_mm_cmpgt_epi8(chars, _mm_set1_epi8('0' - 1)),
+                                              _mm_cmplt_epi8(chars, _mm_set1_epi8('9' + 1)));
+
+        const __m128i lower = _mm_or_si128(chars, _mm_set1_epi8(0x20));
+        const __m128i isAlpha = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)),
+                                              _mm_cmplt_epi8(lower, _mm_set1_epi8('f' + 1)));
+
+        *validMask &= _mm_movemask_epi8(_mm_or_si128(isDigit, isAlpha));
+
+        const __m128i digitValue = _mm_sub_epi8(chars, _mm_set1_epi8('0'));
+        const __m128i alphaValue = _mm_sub_epi8(lower, _mm_set1_epi8('a' - 10));
+        return _mm_or_si128(_mm_and_si128(isDigit, digitValue), _mm_and_si128(isAlpha, alphaValue));
+    }
+
+    // Combines adjacent nibbles into bytes; the result holds one byte per 16-bit lane.
+    __m128i combine_nibbles(__m128i nibbles) {
+        const __m128i high = _mm_and_si128(nibbles, _mm_set1_epi16(0x00ff));
+        const __m128i low = _mm_srli_epi16(nibbles, 8);
+        return _mm_or_si128(_mm_slli_epi16(high, 4), low);
+    }
+
+    std::size_t decode_vector(const char* src, std::size_t numChars, std::uint8_t* dst) {
+        std::size_t consumed = 0;
+
+        for (; numChars - consumed >= kVectorChars; consumed += kVectorChars) {
+            const char* const chars = src + consumed;
+
+            int validMask = 0xffff;
+            const __m128i first = decode_nibbles(_mm_loadu_si128(reinterpret_cast<const __m128i*>(chars)), &validMask);
+            const __m128i second = decode_nibbles(_mm_loadu_si128(reinterpret_cast<const __m128i*>(chars + 16)), &validMask);
+            if (0xffff != validMask) {
+                // let the scalar loop locate and report the bad character
+                break;
+            }
+
+            const __m128i bytes = _mm_packus_epi16(combine_nibbles(first), combine_nibbles(second));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + consumed / 2), bytes);
+        }
+
+        return consumed;
+    }
+#elif CLSPVUTILS_HEX_NEON
+    uint8x16_t decode_nibbles(uint8x16_t chars, uint8x16_t* valid) {
+        const uint8x16_t digitValue = vsubq_u8(chars, vdupq_n_u8('0'));
+        const uint8x16_t isDigit = vcltq_u8(digitValue, vdupq_n_u8(10));
+
+        const uint8x16_t alphaOffset = vsubq_u8(vorrq_u8(chars, vdupq_n_u8(0x20)), vdupq_n_u8('a'));
+        const uint8x16_t isAlpha = vcltq_u8(alphaOffset, vdupq_n_u8(6));
+
+        *valid = vandq_u8(*valid, vorrq_u8(isDigit, isAlpha));
+
+        return vbslq_u8(isDigit, digitValue, vaddq_u8(alphaOffset, vdupq_n_u8(10)));
+    }
+
+    std::size_t decode_vector(const char* src, std::size_t numChars, std::uint8_t* dst) {
+        std::size_t consumed = 0;
+
+        for (; numChars - consumed >= kVectorChars; consumed += kVectorChars) {
+            // de-interleave into the high nibble characters and the low nibble characters
+            const uint8x16x2_t chars = vld2q_u8(reinterpret_cast<const std::uint8_t*>(src + consumed));
+
+            uint8x16_t valid = vdupq_n_u8(0xff);
+            const uint8x16_t high = decode_nibbles(chars.val[0], &valid);
+            const uint8x16_t low = decode_nibbles(chars.val[1], &valid);
+            if (0xff != vminvq_u8(valid)) {
+                // let the scalar loop locate and report the bad character
+                break;
+            }
+
+            vst1q_u8(dst + consumed / 2, vorrq_u8(vshlq_n_u8(high, 4), low));
+        }
+
+        return consumed;
+    }
+#else
+    std::size_t decode_vector(const char*, std::size_t, std::uint8_t*) {
+        return 0;
+    }
+#endif
+
+} // anonymous namespace
+
+namespace clspv_utils {
+
+    vector<std::uint8_t> hexToBytes(const char* first, const char* last) {
+        const std::size_t numChars = static_cast<std::size_t>(last - first);
+
+        if (0 != (numChars % 2)) {
+            fail_runtime_error("hex string must have even number of characters");
+        }
+
+        vector<std::uint8_t> result(numChars / 2);
+        if (result.empty()) return result;
+
+        std::uint8_t* const dst = result.data();
+        const nibble_table& nibbles = get_nibble_table();
+
+        for (std::size_t i = decode_vector(first, numChars, dst); i < numChars; i += 2) {
+            const int high = nibbles[first[i]];
+            const int low = nibbles[first[i + 1]];
+
+            if (high < 0 || low < 0) {
+                fail_runtime_error("hex string contains a character which is not a hex digit");
+            }
+
+            dst[i / 2] = static_cast<std::uint8_t>((high << 4) | low);
+        }
+
+        return result;
+    }
+
+    vector<std::uint8_t> hexToBytes(const string& hexString) {
+        return hexToBytes(hexString.data(), hexString.data() + hexString.size());
+    }
+
+} // namespace clspv_utils
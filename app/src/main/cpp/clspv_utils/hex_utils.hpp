@@ -0,0 +1,28 @@
+//
+// Created by Eric Berdahl on 5/17/18.
+//
+
+#ifndef CLSPVUTILS_HEX_UTILS_HPP
+#define CLSPVUTILS_HEX_UTILS_HPP
+
+#include "clspv_utils_interop.hpp"
+
+#include <cstdint>
+
+namespace clspv_utils {
+
+    //
+    // Decode a string of hexadecimal digit pairs (e.g. "0102ff") into bytes. Upper and lower case
+    // digits are accepted; an odd number of characters, or any character which is not a hex digit,
+    // is reported with fail_runtime_error.
+    //
+    // Long strings are decoded 16 bytes at a time with SSE2 (x86) or NEON (arm64); other targets,
+    // and the tail of every string, use a table-driven scalar loop.
+    //
+    vector<std::uint8_t>    hexToBytes(const char* first, const char* last);
+
+    vector<std::uint8_t>    hexToBytes(const string& hexString);
+
+}
+
+#endif //CLSPVUTILS_HEX_UTILS_HPP
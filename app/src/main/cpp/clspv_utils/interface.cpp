@@ -5,22 +5,53 @@
 #include "interface.hpp"
 
 #include "clspv_utils_interop.hpp"
+#include "hex_utils.hpp"
 #include "opencl_types.hpp"
 
 #include <algorithm>
 #include <cassert>
+#include <cctype>
 #include <cstring>
 #include <functional>
 #include <istream>
+#include <iterator>
 #include <limits>
 #include <memory>
 
-#include <sstream> // std::istringstream
-
 namespace {
     using namespace clspv_utils;
 
-    typedef std::pair<string, string> key_value_t;
+    //
+    // text_slice is a view of a run of characters in the spvmap buffer. The spvmap parser hands
+    // these around instead of strings so that tokenizing a line never allocates.
+    //
+    struct text_slice {
+        const char* mBegin  = nullptr;
+        const char* mEnd    = nullptr;
+
+        text_slice() {}
+        text_slice(const char* first, const char* last) : mBegin(first), mEnd(last) {}
+
+        bool        empty() const { return mBegin == mEnd; }
+        std::size_t size() const { return static_cast<std::size_t>(mEnd - mBegin); }
+        string      str() const { return string(mBegin, mEnd); }
+    };
+
+    bool operator==(const text_slice& lhs, const string& rhs) {
+        return lhs.size() == rhs.size() && 0 == std::memcmp(lhs.mBegin, rhs.data(), rhs.size());
+    }
+
+    bool operator==(const text_slice& lhs, const char* rhs) {
+        const std::size_t length = std::strlen(rhs);
+        return lhs.size() == length && 0 == std::memcmp(lhs.mBegin, rhs, length);
+    }
+
+    template <typename T>
+    bool operator==(const T& lhs, const text_slice& rhs) {
+        return rhs == lhs;
+    }
+
+    typedef std::pair<text_slice, text_slice> key_value_t;
 
     const auto kCLAddressMode_VkAddressMode_Map = {
             std::make_pair(CLK_ADDRESS_NONE,            vk::SamplerAddressMode::eClampToEdge),
@@ -51,7 +82,7 @@ namespace {
             std::make_pair("local",      arg_spec_t::kind_local)
     };
 
-    arg_spec_t::kind find_arg_kind(const string &argType) {
+    arg_spec_t::kind find_arg_kind(const text_slice& argType) {
         auto found = std::find_if(std::begin(kSpvMapArgType_ArgKind_Map),
                                   std::end(kSpvMapArgType_ArgKind_Map),
                                   [&argType](decltype(kSpvMapArgType_ArgKind_Map)::const_reference p) {
@@ -63,109 +94,146 @@ namespace {
         return found->second;
     }
 
-    vector<std::uint8_t> hexToBytes(string hexString) {
-        vector<std::uint8_t> result;
+    // Parses a decimal integer the way std::stoi does for the values a spvmap contains: leading
+    // whitespace and a sign are accepted, and parsing stops at the first non-digit.
+    int parse_int(const text_slice& field) {
+        const char* next = field.mBegin;
+        while (next != field.mEnd && std::isspace(static_cast<unsigned char>(*next))) ++next;
+
+        const bool isNegative = (next != field.mEnd && '-' == *next);
+        if (next != field.mEnd && ('-' == *next || '+' == *next)) ++next;
+
+        const char* const firstDigit = next;
+        long long value = 0;
+        for (; next != field.mEnd && '0' <= *next && *next <= '9'; ++next) {
+            value = value * 10 + (*next - '0');
+            if (value > static_cast<long long>(std::numeric_limits<int>::max()) + 1) {
+                fail_runtime_error("spvmap integer out of range");
+            }
+        }
 
-        if (0 != (hexString.length() % 2)) {
-            fail_runtime_error("spvmap constant hex string must have even number of characters");
+        if (next == firstDigit) {
+            fail_runtime_error("spvmap field is not an integer");
         }
 
-        result.reserve(hexString.length() / 2);
+        value = (isNegative ? -value : value);
+        if (value > std::numeric_limits<int>::max()) {
+            fail_runtime_error("spvmap integer out of range");
+        }
 
-        for (string::size_type i = 0; i < hexString.length(); i +=2) {
-            const string    byteString = hexString.substr(i, 2);
-            const int       byteInt = std::stoi(byteString, nullptr, 16);
+        return static_cast<int>(value);
+    }
 
-            assert(0 <= byteInt);
-            assert(byteInt <= std::numeric_limits<std::uint8_t>::max());
+    //
+    // csv_line tokenizes a single spvmap line in place. Fields are separated by commas; a field
+    // starting with a double quote extends to the closing quote (so it may contain commas), and
+    // anything between the closing quote and the next comma is discarded.
+    //
+    class csv_line {
+    public:
+        csv_line(const char* first, const char* last) : mNext(first), mEnd(last) {}
 
-            result.push_back(static_cast<std::uint8_t>(byteInt));
-        }
+        bool        at_end() const { return mNext == mEnd; }
 
-        return result;
-    }
+        text_slice  next_field() {
+            text_slice result;
 
-    string read_csv_field(std::istream& in) {
-        string result;
+            if (at_end()) return result;
 
-        if (in.good()) {
-            const bool is_quoted = (in.peek() == '"');
+            if ('"' == *mNext) {
+                const char* const contents = mNext + 1;
+                const char* const closeQuote = find(contents, '"');
 
-            if (is_quoted) {
-                in.ignore(std::numeric_limits<std::streamsize>::max(), '"');
+                result = text_slice(contents, closeQuote);
+                mNext = closeQuote;
+                if (mNext != mEnd) mNext = find(mNext + 1, ',');
             }
+            else {
+                const char* const comma = find(mNext, ',');
 
-            std::getline(in, result, is_quoted ? '"' : ',');
-
-            if (is_quoted) {
-                in.ignore(std::numeric_limits<std::streamsize>::max(), ',');
+                result = text_slice(mNext, comma);
+                mNext = comma;
             }
+
+            if (mNext != mEnd) ++mNext;   // step over the comma
+
+            return result;
         }
 
-        return result;
-    }
+        key_value_t next_key_value_pair() {
+            // evaluate the key before the value; the order of evaluation of function arguments
+            // is unspecified, so this must not be written as make_pair(next_field(), next_field())
+            const text_slice key = next_field();
+            return std::make_pair(key, next_field());
+        }
+
+    private:
+        const char* find(const char* first, char c) const {
+            const void* found = std::memchr(first, c, mEnd - first);
+            return (found ? static_cast<const char*>(found) : mEnd);
+        }
 
-    key_value_t read_key_value_pair(std::istream& in) {
-        return std::make_pair(read_csv_field(in), read_csv_field(in));
+    private:
+        const char* mNext;
+        const char* mEnd;
     };
 
-    constant_spec_t parse_spvmap_constant(std::istream& in) {
+    constant_spec_t parse_spvmap_constant(csv_line& in) {
         constant_spec_t result;
 
-        while (!in.eof()) {
-            const auto tag = read_key_value_pair(in);
+        while (!in.at_end()) {
+            const auto tag = in.next_key_value_pair();
 
             if ("descriptorSet" == tag.first) {
-                result.mDescriptorSet = std::stoi(tag.second);
+                result.mDescriptorSet = parse_int(tag.second);
             } else if ("binding" == tag.first) {
-                result.mBinding = std::stoi(tag.second);
+                result.mBinding = parse_int(tag.second);
             } else if ("hexbytes" == tag.first) {
-                result.mBytes = hexToBytes(tag.second);
+                result.mBytes = hexToBytes(tag.second.mBegin, tag.second.mEnd);
             }
         }
 
         return result;
     }
 
-    sampler_spec_t parse_spvmap_sampler(std::istream& in) {
+    sampler_spec_t parse_spvmap_sampler(csv_line& in) {
         sampler_spec_t result;
 
-        const auto clFlagString = read_csv_field(in);
-        result.mOpenclFlags = std::stoi(clFlagString);
+        result.mOpenclFlags = parse_int(in.next_field());
 
-        while (!in.eof()) {
-            const auto tag = read_key_value_pair(in);
+        while (!in.at_end()) {
+            const auto tag = in.next_key_value_pair();
 
             if ("descriptorSet" == tag.first) {
-                result.mDescriptorSet = std::stoi(tag.second);
+                result.mDescriptorSet = parse_int(tag.second);
             } else if ("binding" == tag.first) {
-                result.mBinding = std::stoi(tag.second);
+                result.mBinding = parse_int(tag.second);
             }
         }
 
         return result;
     }
 
-    arg_spec_t parse_spvmap_kernel_arg(std::istream& in) {
+    arg_spec_t parse_spvmap_kernel_arg(csv_line& in) {
         arg_spec_t result;
 
-        while (!in.eof()) {
-            const auto tag = read_key_value_pair(in);
+        while (!in.at_end()) {
+            const auto tag = in.next_key_value_pair();
 
             if ("argOrdinal" == tag.first) {
-                result.mOrdinal = std::stoi(tag.second);
+                result.mOrdinal = parse_int(tag.second);
             } else if ("descriptorSet" == tag.first) {
-                result.mDescriptorSet = std::stoi(tag.second);
+                result.mDescriptorSet = parse_int(tag.second);
             } else if ("binding" == tag.first) {
-                result.mBinding = std::stoi(tag.second);
+                result.mBinding = parse_int(tag.second);
             } else if ("offset" == tag.first) {
-                result.mOffset = std::stoi(tag.second);
+                result.mOffset = parse_int(tag.second);
             } else if ("argKind" == tag.first) {
                 result.mKind = find_arg_kind(tag.second);
             } else if ("arrayElemSize" == tag.first) {
                 // arrayElemSize is ignored by clspvtest
             } else if ("arrayNumElemSpecId" == tag.first) {
-                result.mSpecConstant = std::stoi(tag.second);
+                result.mSpecConstant = parse_int(tag.second);
             }
 
         }
@@ -182,30 +250,54 @@ namespace clspv_utils {
      **********************************************************************************************/
 
     module_spec_t createModuleSpec(std::istream& in)
+    {
+        const string contents((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        return createModuleSpec(contents.data(), contents.data() + contents.size());
+    }
+
+    module_spec_t createModuleSpec(const char* first, const char* last)
+    {
+        module_spec_t result = createModuleSpecMetadata(first, last);
+
+        standardizeModuleSpec(result);
+        validateModule(result);
+
+        return result;
+    }
+
+    module_spec_t createModuleSpecMetadata(const char* first, const char* last)
     {
         module_spec_t result;
 
         kernel_spec_t* recentKernel = nullptr;
 
-        string line;
-        while (!in.eof()) {
-            std::getline(in, line);
+        while (first != last) {
+            const void* newline = std::memchr(first, '\n', last - first);
+            const char* lineEnd = (newline ? static_cast<const char*>(newline) : last);
+            const char* const nextLine = (newline ? lineEnd + 1 : last);
 
-            std::istringstream in_line(line);
-            const auto tag = read_csv_field(in_line);
+            // spvmap files may have been generated on a system which uses different line ending
+            // conventions than the system on which the consumer runs.
+            if (lineEnd != first && '\r' == lineEnd[-1]) --lineEnd;
+
+            csv_line in_line(first, lineEnd);
+            first = nextLine;
+
+            const auto tag = in_line.next_field();
             if ("sampler" == tag) {
                 result.mSamplers.push_back(parse_spvmap_sampler(in_line));
             } else if ("constant" == tag) {
                 result.mConstants.push_back(parse_spvmap_constant(in_line));
             } else if ("kernel" == tag) {
-                const auto kernelName = read_csv_field(in_line);
-                if (!recentKernel || recentKernel->mName != kernelName)
+                const auto kernelName = in_line.next_field();
+                if (!recentKernel || !(recentKernel->mName == kernelName))
                 {
-                    recentKernel = findKernelSpec(kernelName, result.mKernels);
-                    if (!recentKernel) {
-                        result.mKernels.push_back(kernel_spec_t{ kernelName, kernel_spec_t::arg_list() });
-                        recentKernel = &result.mKernels.back();
+                    string name = kernelName.str();
+                    const auto inserted = result.mKernelIndex.insert(std::make_pair(name, result.mKernels.size()));
+                    if (inserted.second) {
+                        result.mKernels.push_back(kernel_spec_t{ std::move(name), kernel_spec_t::arg_list() });
                     }
+                    recentKernel = &result.mKernels[inserted.first->second];
                 }
                 assert(recentKernel);
 
@@ -213,20 +305,54 @@ namespace clspv_utils {
             }
         }
 
+        return result;
+    }
+
+    void standardizeModuleSpec(module_spec_t& spec)
+    {
         // Ensure that the literal samplers are sorted by increasing binding number. This will be
         // important if the sequence is later used to determine whether a cached sampler descriptor
         // set can be re-used for this module.
-        std::sort(result.mSamplers.begin(), result.mSamplers.end(), [](const sampler_spec_t& lhs, const sampler_spec_t& rhs) {
+        std::sort(spec.mSamplers.begin(), spec.mSamplers.end(), [](const sampler_spec_t& lhs, const sampler_spec_t& rhs) {
             return lhs.mBinding < rhs.mBinding;
         });
 
-        for (auto& k : result.mKernels) {
+        for (auto& k : spec.mKernels) {
             standardizeKernelArgumentOrder(k.mArguments);
         }
 
-        validateModule(result);
+        indexKernelSpecs(spec);
+    }
 
-        return result;
+    void indexKernelSpecs(module_spec_t& spec)
+    {
+        spec.mKernelIndex.clear();
+        spec.mKernelIndex.reserve(spec.mKernels.size());
+
+        for (std::size_t i = 0; i < spec.mKernels.size(); ++i) {
+            spec.mKernelIndex.insert(std::make_pair(spec.mKernels[i].mName, i));
+        }
+    }
+
+    const kernel_spec_t* findKernelSpec(const string&           name,
+                                        const module_spec_t&    spec)
+    {
+        const auto found = spec.mKernelIndex.find(name);
+        if (found != spec.mKernelIndex.end()
+            && found->second < spec.mKernels.size()
+            && spec.mKernels[found->second].mName == name) {
+            return &spec.mKernels[found->second];
+        }
+
+        // The index is stale if mKernels changed since it was built (kernels renamed, reordered or
+        // replaced), so a miss, or a hit on some other kernel, is settled by the kernels themselves
+        return findKernelSpec(name, spec.mKernels);
+    }
+
+    kernel_spec_t* findKernelSpec(const string&     name,
+                                  module_spec_t&    spec)
+    {
+        return const_cast<kernel_spec_t*>(findKernelSpec(name, const_cast<const module_spec_t&>(spec)));
     }
 
     /***********************************************************************************************
@@ -409,11 +535,33 @@ namespace clspv_utils {
             validateSampler(ls, sampler_ds);
         }
 
+        const int constant_ds = (spec.mConstants.empty() ? -1 : spec.mConstants.front().mDescriptorSet);
+        for (auto& c : spec.mConstants) {
+            // All module-scope constants for a module need to be in the same descriptor set
+            validateConstant(c, constant_ds);
+
+            if (c.mDescriptorSet == sampler_ds) {
+                const bool bindingCollides = std::any_of(spec.mSamplers.begin(), spec.mSamplers.end(), [&c](const sampler_spec_t& s) {
+                    return s.mBinding == c.mBinding;
+                });
+                if (bindingCollides) {
+                    fail_runtime_error("constant and literal sampler share a binding");
+                }
+            }
+        }
+
         // If there are literal samplers, the kernel arguments are in descriptor set 1, otherwise
         // they are in descriptor set 0
         const int kernel_ds = (sampler_ds > 0 ? 1 : 0);
         for (auto& k : spec.mKernels) {
             validateKernel(k, kernel_ds);
+
+            // Module-scope descriptor sets are shared by every kernel, so they can't also hold
+            // any one kernel's arguments
+            const int arg_ds = getKernelArgumentDescriptorSet(k.mArguments);
+            if (-1 != arg_ds && (arg_ds == sampler_ds || arg_ds == constant_ds)) {
+                fail_runtime_error("kernel arguments share a descriptor set with module-scope resources");
+            }
         }
 
     }
@@ -470,6 +618,22 @@ namespace clspv_utils {
         }
     }
 
+    void validateConstant(const constant_spec_t& spec, int requiredDescriptorSet) {
+        if (spec.mDescriptorSet < 0) {
+            fail_runtime_error("constant missing descriptorSet");
+        }
+        if (spec.mBinding < 0) {
+            fail_runtime_error("constant missing binding");
+        }
+        if (spec.mBytes.empty()) {
+            fail_runtime_error("constant has no data");
+        }
+
+        if (requiredDescriptorSet >= 0 && spec.mDescriptorSet != requiredDescriptorSet) {
+            fail_runtime_error("constant is not in required descriptor_set");
+        }
+    }
+
     void validateKernelArg(const arg_spec_t &arg) {
         if (arg.mKind == arg_spec_t::kind_unknown) {
             fail_runtime_error("kernel argument kind unknown");
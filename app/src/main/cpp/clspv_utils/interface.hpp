@@ -56,9 +56,13 @@ namespace clspv_utils {
         typedef vector<sampler_spec_t>  sampler_list;
         typedef vector<kernel_spec_t>   kernel_list;
 
+        // maps each kernel name to its position in mKernels (see indexKernelSpecs)
+        typedef unordered_map<string, std::size_t>  kernel_index;
+
         sampler_list    mSamplers;
         constant_list   mConstants;
         kernel_list     mKernels;
+        kernel_index    mKernelIndex;
     };
 
     /*
@@ -67,6 +71,32 @@ namespace clspv_utils {
 
     module_spec_t           createModuleSpec(std::istream& spvmapStream);
 
+    module_spec_t           createModuleSpec(const char* spvmapFirst, const char* spvmapLast);
+
+    /*
+     * Parse a CSV spvmap into its records alone, without standardizing or validating them, for
+     * callers which only take metadata from it and check their own result (see combineModuleSpecs)
+     */
+    module_spec_t           createModuleSpecMetadata(const char* spvmapFirst, const char* spvmapLast);
+
+    /*
+     * Sort literal samplers by binding and put each kernel's arguments in standard order
+     */
+    void                    standardizeModuleSpec(module_spec_t& spec);
+
+    /*
+     * Rebuild mKernelIndex from mKernels. Must be called after mKernels is modified, or lookups
+     * through the module_spec_t will fall back to a linear search. findKernelSpec checks the name
+     * of every kernel the index finds, so a stale index is slow but never wrong.
+     */
+    void                    indexKernelSpecs(module_spec_t& spec);
+
+    const kernel_spec_t*    findKernelSpec(const string&        name,
+                                           const module_spec_t& spec);
+
+    kernel_spec_t*          findKernelSpec(const string&    name,
+                                           module_spec_t&   spec);
+
     /*
      * module_spec_t::kernel_list functions
      */
@@ -132,7 +162,7 @@ namespace clspv_utils {
 
     void    validateModule(const module_spec_t& spec);
 
-    void    validateConstant(const constant_spec_t& spec);
+    void    validateConstant(const constant_spec_t& spec, int requiredDescriptorSet = -1);
 }
 
 #endif // CLSPVUTILS_INTERFACE_HPP
@@ -6,6 +6,9 @@
 
 #include "interface.hpp"
 
+#include "trace_events.hpp"
+
+#include <algorithm>
 #include <cassert>
 #include <memory>
 
@@ -14,7 +17,16 @@ namespace clspv_utils {
 
     execution_time_t::execution_time_t() :
             cpu_duration(0),
-            timestamps()
+            descriptor_update_duration(0),
+            record_duration(0),
+            submit_duration(0),
+            wait_duration(0),
+            has_latency(false),
+            submission_latency(0),
+            completion_latency(0),
+            calibration_error(0),
+            timestamps(),
+            dispatches()
     {
     }
 
@@ -30,7 +42,7 @@ namespace clspv_utils {
 
         vk::QueryPoolCreateInfo poolCreateInfo;
         poolCreateInfo.setQueryType(vk::QueryType::eTimestamp)
-                .setQueryCount(kQueryIndex_Count);
+                .setQueryCount(getQueryCount());
 
         mQueryPool = mReq.mDevice.getDevice().createQueryPoolUnique(poolCreateInfo);
     }
@@ -61,6 +73,18 @@ namespace clspv_utils {
         swap(mArgumentDescriptorWrites, other.mArgumentDescriptorWrites);
     }
 
+    std::uint32_t invocation::getQueryCount() const {
+        return kQueryIndex_Count + 2 * (mReq.mNumDispatches - 1);
+    }
+
+    std::uint32_t invocation::getDispatchStartQuery(std::uint32_t dispatch) const {
+        return (0 == dispatch ? kQueryIndex_PostHostBarrier : kQueryIndex_FirstDispatchBoundary + 2 * dispatch - 1);
+    }
+
+    std::uint32_t invocation::getDispatchEndQuery(std::uint32_t dispatch) const {
+        return (mReq.mNumDispatches - 1 == dispatch ? kQueryIndex_PostExecution : kQueryIndex_FirstDispatchBoundary + 2 * dispatch);
+    }
+
     std::size_t invocation::countArguments() const {
         return mArgumentDescriptorWrites.size() + mSpecConstantArguments.size();
     }
@@ -210,17 +234,27 @@ namespace clspv_utils {
 
         mCommand->bindPipeline(vk::PipelineBindPoint::eCompute, pipeline);
 
-        vk::DescriptorSet descriptors[] = { mReq.mLiteralSamplerDescriptor, mReq.mArgumentsDescriptor };
-        std::uint32_t numDescriptors = (descriptors[0] ? 2 : 1);
-        if (1 == numDescriptors) descriptors[0] = descriptors[1];
+        // bind each run of consecutive set numbers which has descriptors
+        const std::uint32_t numDescriptors = mReq.mDescriptors.size();
+        for (std::uint32_t first = 0; first < numDescriptors; ) {
+            if (!mReq.mDescriptors[first]) {
+                ++first;
+                continue;
+            }
+
+            std::uint32_t last = first;
+            while (last < numDescriptors && mReq.mDescriptors[last]) ++last;
 
-        mCommand->bindDescriptorSets(vk::PipelineBindPoint::eCompute,
-                                     mReq.mPipelineLayout,
-                                     0,
-                                     { numDescriptors, descriptors },
-                                     nullptr);
+            mCommand->bindDescriptorSets(vk::PipelineBindPoint::eCompute,
+                                         mReq.mPipelineLayout,
+                                         first,
+                                         { last - first, mReq.mDescriptors.data() + first },
+                                         nullptr);
 
-        mCommand->resetQueryPool(*mQueryPool, kQueryIndex_FirstIndex, kQueryIndex_Count);
+            first = last;
+        }
+
+        mCommand->resetQueryPool(*mQueryPool, kQueryIndex_FirstIndex, getQueryCount());
 
         mCommand->writeTimestamp(vk::PipelineStageFlagBits::eComputeShader, *mQueryPool, kQueryIndex_StartOfExecution);
         mCommand->pipelineBarrier(vk::PipelineStageFlagBits::eHost | vk::PipelineStageFlagBits::eComputeShader | vk::PipelineStageFlagBits::eTransfer,
@@ -229,9 +263,20 @@ namespace clspv_utils {
                                   nullptr,    // memory barriers
                                   mBufferMemoryBarriers,    // buffer memory barriers
                                   mImageMemoryBarriers);    // image memory barriers
-        mCommand->writeTimestamp(vk::PipelineStageFlagBits::eComputeShader, *mQueryPool, kQueryIndex_PostHostBarrier);
-        mCommand->dispatch(num_workgroups.width, num_workgroups.height, num_workgroups.depth);
-        mCommand->writeTimestamp(vk::PipelineStageFlagBits::eComputeShader, *mQueryPool, kQueryIndex_PostExecution);
+        for (std::uint32_t dispatch = 0; dispatch < mReq.mNumDispatches; ++dispatch) {
+            if (dispatch > 0) {
+                // each dispatch sees the previous one's writes, as it would if submitted separately
+                mCommand->pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader,
+                                          vk::PipelineStageFlagBits::eComputeShader,
+                                          vk::DependencyFlags(),
+                                          { { vk::AccessFlagBits::eShaderWrite, vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite } },    // memory barriers
+                                          nullptr,    // buffer memory barriers
+                                          nullptr);    // image memory barriers
+            }
+            mCommand->writeTimestamp(vk::PipelineStageFlagBits::eComputeShader, *mQueryPool, getDispatchStartQuery(dispatch));
+            mCommand->dispatch(num_workgroups.width, num_workgroups.height, num_workgroups.depth);
+            mCommand->writeTimestamp(vk::PipelineStageFlagBits::eComputeShader, *mQueryPool, getDispatchEndQuery(dispatch));
+        }
         mCommand->pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader,
                                   vk::PipelineStageFlagBits::eHost | vk::PipelineStageFlagBits::eTransfer,
                                   vk::DependencyFlags(),
@@ -253,30 +298,97 @@ namespace clspv_utils {
 
     }
 
+    void invocation::traceQueue(const execution_time_t& time, const vulkan_utils::timestamp_calibration_t& calibration) const {
+        auto to_host_ns = [&calibration](std::uint64_t timestamp) {
+            return static_cast<std::uint64_t>(std::max<std::int64_t>(0, vulkan_utils::timestamp_to_host_ns(calibration, timestamp)));
+        };
+
+        trace_events::record_queue("host barrier", to_host_ns(time.timestamps.start), to_host_ns(time.timestamps.host_barrier));
+        if (time.dispatches.empty()) {
+            trace_events::record_queue("dispatch", to_host_ns(time.timestamps.host_barrier), to_host_ns(time.timestamps.execution));
+        }
+        else {
+            for (const auto& dispatch : time.dispatches) {
+                trace_events::record_queue("dispatch", to_host_ns(dispatch.start), to_host_ns(dispatch.end));
+            }
+        }
+        trace_events::record_queue("gpu barrier", to_host_ns(time.timestamps.execution), to_host_ns(time.timestamps.gpu_barrier));
+    }
+
     execution_time_t invocation::run(const vk::Extent3D& num_workgroups) {
-        updateDescriptorSets();
-        fillCommandBuffer(num_workgroups);
+        // the steady clock is the host time domain device timestamps are calibrated against
+        typedef std::chrono::steady_clock clock;
 
-        auto start = std::chrono::high_resolution_clock::now();
-        submitCommand();
-        mReq.mDevice.getComputeQueue().waitIdle();
-        auto end = std::chrono::high_resolution_clock::now();
+        auto updateStart = clock::now();
+        {
+            trace_events::scope scope("descriptor update", "invocation");
+            updateDescriptorSets();
+        }
 
-        uint64_t timestamps[kQueryIndex_Count];
+        auto recordStart = clock::now();
+        {
+            trace_events::scope scope("command recording", "invocation");
+            fillCommandBuffer(num_workgroups);
+        }
+
+        auto start = clock::now();
+        {
+            trace_events::scope scope("submit", "invocation");
+            submitCommand();
+        }
+
+        auto waitStart = clock::now();
+        {
+            trace_events::scope scope("queue wait", "invocation");
+            mReq.mDevice.getComputeQueue().waitIdle();
+        }
+        auto end = clock::now();
+
+        vector<uint64_t> timestamps(getQueryCount());
         mReq.mDevice.getDevice().getQueryPoolResults(*mQueryPool,
                                                      kQueryIndex_FirstIndex,
-                                                     kQueryIndex_Count,
-                                                     sizeof(uint64_t),
-                                                     timestamps,
+                                                     timestamps.size(),
+                                                     timestamps.size() * sizeof(uint64_t),
+                                                     timestamps.data(),
                                                      sizeof(uint64_t),
                                                      vk::QueryResultFlagBits::e64 | vk::QueryResultFlagBits::eWait);
 
         execution_time_t result;
         result.cpu_duration = end - start;
+        result.descriptor_update_duration = recordStart - updateStart;
+        result.record_duration = start - recordStart;
+        result.submit_duration = waitStart - start;
+        result.wait_duration = end - waitStart;
         result.timestamps.start = timestamps[kQueryIndex_StartOfExecution];
         result.timestamps.host_barrier = timestamps[kQueryIndex_PostHostBarrier];
         result.timestamps.execution = timestamps[kQueryIndex_PostExecution];
         result.timestamps.gpu_barrier = timestamps[kQueryIndex_PostGPUBarrier];
+
+        if (mReq.mNumDispatches > 1) {
+            result.dispatches.resize(mReq.mNumDispatches);
+            for (std::uint32_t dispatch = 0; dispatch < mReq.mNumDispatches; ++dispatch) {
+                result.dispatches[dispatch].start = timestamps[getDispatchStartQuery(dispatch)];
+                result.dispatches[dispatch].end = timestamps[getDispatchEndQuery(dispatch)];
+            }
+        }
+
+        // calibrating is left to the caller, once per batch of runs, so that it adds no work to them
+        const vulkan_utils::timestamp_calibration_t calibration = mReq.mDevice.getTimestampCalibration();
+        if (calibration.mIsValid) {
+            typedef std::chrono::duration<double, std::nano> duration_ns;
+            const duration_ns submit_ns = std::chrono::duration_cast<duration_ns>(start.time_since_epoch());
+            const duration_ns complete_ns = std::chrono::duration_cast<duration_ns>(end.time_since_epoch());
+
+            result.has_latency = true;
+            result.submission_latency = duration_ns(vulkan_utils::timestamp_to_host_ns(calibration, result.timestamps.start)) - submit_ns;
+            result.completion_latency = complete_ns - duration_ns(vulkan_utils::timestamp_to_host_ns(calibration, result.timestamps.gpu_barrier));
+            result.calibration_error = duration_ns(calibration.mMaxDeviation_ns);
+
+            if (trace_events::is_enabled()) {
+                traceQueue(result, calibration);
+            }
+        }
+
         return result;
     }
 
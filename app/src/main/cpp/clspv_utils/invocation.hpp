@@ -30,10 +30,36 @@ namespace clspv_utils {
             uint64_t gpu_barrier    = 0;
         };
 
+        struct dispatch_timestamps {
+            uint64_t start  = 0;
+            uint64_t end    = 0;
+        };
+
         execution_time_t();
 
+        // from submit until the queue is idle
         std::chrono::duration<double>   cpu_duration;
+
+        // host work of the run, phase by phase; submit and wait together make up cpu_duration
+        std::chrono::duration<double>   descriptor_update_duration;
+        std::chrono::duration<double>   record_duration;
+        std::chrono::duration<double>   submit_duration;
+        std::chrono::duration<double>   wait_duration;
+
+        //
+        // From submit until the GPU's first timestamp, and from its last timestamp until the host
+        // returns from waiting, with device timestamps placed on the host clock by calibration. Either
+        // may be off by as much as calibration_error, and so may even be negative.
+        //
+        bool                            has_latency;
+        std::chrono::duration<double>   submission_latency;
+        std::chrono::duration<double>   completion_latency;
+        std::chrono::duration<double>   calibration_error;
         vulkan_timestamps               timestamps;
+
+        // One entry per dispatch when the invocation records more than one dispatch into its
+        // submission; empty otherwise. timestamps then spans all of the dispatches.
+        vector<dispatch_timestamps>     dispatches;
     };
 
     class invocation {
@@ -62,6 +88,13 @@ namespace clspv_utils {
         void    updateDescriptorSets();
         void    submitCommand();
 
+        // Records the GPU work of a completed run on the trace's queue track
+        void    traceQueue(const execution_time_t& time, const vulkan_utils::timestamp_calibration_t& calibration) const;
+
+        std::uint32_t   getQueryCount() const;
+        std::uint32_t   getDispatchStartQuery(std::uint32_t dispatch) const;
+        std::uint32_t   getDispatchEndQuery(std::uint32_t dispatch) const;
+
         // Sanity check that the nth argument (specified by ordinal) has the indicated
         // spvmap type. Throw an exception if false. Return the binding number if true.
         std::uint32_t   validateArgType(std::size_t ordinal, vk::DescriptorType kind) const;
@@ -76,7 +109,11 @@ namespace clspv_utils {
             kQueryIndex_PostHostBarrier = 1,
             kQueryIndex_PostExecution = 2,
             kQueryIndex_PostGPUBarrier= 3,
-            kQueryIndex_Count = 4
+            kQueryIndex_Count = 4,
+
+            // with more than one dispatch, the end of each dispatch but the last, and the start of
+            // each dispatch but the first, follow the fixed queries
+            kQueryIndex_FirstDispatchBoundary = kQueryIndex_Count
         };
 
     private:
@@ -18,14 +18,18 @@ namespace clspv_utils {
     struct invocation_req_t {
         typedef std::function<vk::Pipeline (vk::ArrayProxy<std::uint32_t>)> get_pipeline_fn;
 
-        device              mDevice;
-        kernel_spec_t       mKernelSpec;
+        device                      mDevice;
+        kernel_spec_t               mKernelSpec;
 
-        vk::PipelineLayout  mPipelineLayout;
-        get_pipeline_fn     mGetPipelineFn;
+        vk::PipelineLayout          mPipelineLayout;
+        get_pipeline_fn             mGetPipelineFn;
 
-        vk::DescriptorSet   mLiteralSamplerDescriptor;
-        vk::DescriptorSet   mArgumentsDescriptor;
+        // indexed by descriptor set number; null for set numbers the kernel doesn't use
+        vector<vk::DescriptorSet>   mDescriptors;
+        vk::DescriptorSet           mArgumentsDescriptor;
+
+        // number of back-to-back dispatches each run records into its command buffer
+        std::uint32_t               mNumDispatches  = 1;
     };
 }
 
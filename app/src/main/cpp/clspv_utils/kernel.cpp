@@ -20,24 +20,50 @@ namespace {
 
 namespace clspv_utils {
 
-    kernel::kernel()
+    kernel::kernel() :
+            mArgumentsDescriptorSet(-1),
+            mNumDispatches(1)
     {
     }
 
     kernel::kernel(kernel_req_t         layout,
                    const vk::Extent3D&  workgroup_sizes) :
             mReq(std::move(layout)),
-            mSpecConstants({ workgroup_sizes.width, workgroup_sizes.height, workgroup_sizes.depth })
+            mArgumentsDescriptorSet(getKernelArgumentDescriptorSet(mReq.mKernelSpec.mArguments)),
+            mSpecConstants({ workgroup_sizes.width, workgroup_sizes.height, workgroup_sizes.depth }),
+            mNumDispatches(1)
     {
-        if (-1 != getKernelArgumentDescriptorSet(mReq.mKernelSpec.mArguments)) {
+        if (-1 != mArgumentsDescriptorSet) {
+            if (mReq.mModuleDescriptors.count(mArgumentsDescriptorSet)) {
+                fail_runtime_error("kernel arguments share a descriptor set with module-scope resources");
+            }
+
             mArgumentsLayout = createKernelArgumentDescriptorLayout(mReq.mKernelSpec.mArguments, mReq.mDevice.getDevice());
 
             mArgumentsDescriptor = allocateDescriptorSet(mReq.mDevice, *mArgumentsLayout);
         }
 
+        // The pipeline layout is indexed by descriptor set number. Set numbers used by neither the
+        // module nor the kernel's arguments get an empty layout.
         vector<vk::DescriptorSetLayout> layouts;
-        if (mReq.mLiteralSamplerLayout) layouts.push_back(mReq.mLiteralSamplerLayout);
-        if (mArgumentsLayout) layouts.push_back(*mArgumentsLayout);
+        for (auto& md : mReq.mModuleDescriptors) {
+            if (md.first >= static_cast<int>(layouts.size())) layouts.resize(md.first + 1);
+            layouts[md.first] = md.second.mLayout;
+        }
+        if (mArgumentsLayout) {
+            if (mArgumentsDescriptorSet >= static_cast<int>(layouts.size())) layouts.resize(mArgumentsDescriptorSet + 1);
+            layouts[mArgumentsDescriptorSet] = *mArgumentsLayout;
+        }
+
+        for (auto& l : layouts) {
+            if (!l) {
+                if (!mEmptyLayout) {
+                    mEmptyLayout = mReq.mDevice.getDevice().createDescriptorSetLayoutUnique(vk::DescriptorSetLayoutCreateInfo());
+                }
+                l = *mEmptyLayout;
+            }
+        }
+
         mPipelineLayout = create_pipeline_layout(mReq.mDevice.getDevice(), layouts);
 
         updatePipeline(nullptr);
@@ -63,11 +89,14 @@ namespace clspv_utils {
         using std::swap;
 
         swap(mReq, other.mReq);
+        swap(mArgumentsDescriptorSet, other.mArgumentsDescriptorSet);
         swap(mArgumentsLayout, other.mArgumentsLayout);
         swap(mArgumentsDescriptor, other.mArgumentsDescriptor);
+        swap(mEmptyLayout, other.mEmptyLayout);
         swap(mPipelineLayout, other.mPipelineLayout);
         swap(mPipeline, other.mPipeline);
         swap(mSpecConstants, other.mSpecConstants);
+        swap(mNumDispatches, other.mNumDispatches);
     }
 
     invocation_req_t kernel::createInvocationReq() {
@@ -77,12 +106,28 @@ namespace clspv_utils {
         result.mKernelSpec = mReq.mKernelSpec;
         result.mPipelineLayout = *mPipelineLayout;
         result.mGetPipelineFn = std::bind(&kernel::updatePipeline, this, std::placeholders::_1);
-        result.mLiteralSamplerDescriptor = mReq.mLiteralSamplerDescriptor;
         result.mArgumentsDescriptor = *mArgumentsDescriptor;
+        result.mNumDispatches = mNumDispatches;
+
+        for (auto& md : mReq.mModuleDescriptors) {
+            if (md.first >= static_cast<int>(result.mDescriptors.size())) result.mDescriptors.resize(md.first + 1);
+            result.mDescriptors[md.first] = md.second.mDescriptor;
+        }
+        if (mArgumentsDescriptor) {
+            if (mArgumentsDescriptorSet >= static_cast<int>(result.mDescriptors.size())) result.mDescriptors.resize(mArgumentsDescriptorSet + 1);
+            result.mDescriptors[mArgumentsDescriptorSet] = *mArgumentsDescriptor;
+        }
 
         return result;
     }
 
+    void kernel::setNumDispatches(std::uint32_t numDispatches) {
+        if (0 == numDispatches) {
+            fail_runtime_error("kernel invocations need at least one dispatch");
+        }
+        mNumDispatches = numDispatches;
+    }
+
     vk::Pipeline kernel::updatePipeline(vk::ArrayProxy<uint32_t> otherSpecConstants) {
         // If the spec constants being passed are equal to the spec constants we already have,
         // the existing pipeline is up to date.
@@ -37,6 +37,11 @@ namespace clspv_utils {
 
         vk::Pipeline        updatePipeline(vk::ArrayProxy<uint32_t> otherSpecConstants);
 
+        // Invocations created afterwards record this many dispatches, separated by barriers, into a
+        // single submission (see execution_time_t::dispatches)
+        void                setNumDispatches(std::uint32_t numDispatches);
+        std::uint32_t       getNumDispatches() const { return mNumDispatches; }
+
         void                swap(kernel& other);
 
         invocation_req_t    createInvocationReq();
@@ -46,11 +51,14 @@ namespace clspv_utils {
 
     private:
         kernel_req_t                    mReq;
+        int                             mArgumentsDescriptorSet;
         vk::UniqueDescriptorSetLayout   mArgumentsLayout;
         vk::UniqueDescriptorSet         mArgumentsDescriptor;
+        vk::UniqueDescriptorSetLayout   mEmptyLayout;
         vk::UniquePipelineLayout        mPipelineLayout;
         vk::UniquePipeline              mPipeline;
         spec_constant_list              mSpecConstants;
+        std::uint32_t                   mNumDispatches;
     };
 
     inline void swap(kernel& lhs, kernel& rhs)
@@ -18,8 +18,7 @@ namespace clspv_utils {
         kernel_spec_t                   mKernelSpec;
         vk::ShaderModule                mShaderModule;
         vk::PipelineCache               mPipelineCache;
-        vk::DescriptorSet               mLiteralSamplerDescriptor;
-        vk::DescriptorSetLayout         mLiteralSamplerLayout;
+        device::descriptor_group_map    mModuleDescriptors;
     };
 }
 
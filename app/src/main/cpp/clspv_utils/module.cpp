@@ -7,6 +7,10 @@
 #include "interface.hpp"
 #include "kernel_req.hpp"
 
+#include "vulkan_utils/vulkan_utils.hpp"
+
+#include <algorithm>
+#include <cstring>
 #include <istream>
 #include <functional>
 #include <memory>
@@ -14,8 +18,7 @@
 namespace {
     using namespace clspv_utils;
 
-    vk::UniqueShaderModule create_shader(vk::Device     device,
-                                         std::istream&  in)
+    vector<std::uint32_t> read_spv_words(std::istream& in)
     {
         const auto savePos = in.tellg();
         in.seekg(0, std::ios_base::end);
@@ -31,18 +34,217 @@ namespace {
 
         in.read(reinterpret_cast<char*>(spvModule.data()), num_bytes);
 
-        vk::ShaderModuleCreateInfo shaderModuleCreateInfo;
-        shaderModuleCreateInfo.setCodeSize(spvModule.size() * sizeof(decltype(spvModule)::value_type))
-                .setPCode(spvModule.data());
+        return spvModule;
+    }
 
-        return device.createShaderModuleUnique(shaderModuleCreateInfo);
+    bool has_memory_type(const vk::PhysicalDeviceMemoryProperties&  memoryProperties,
+                         std::uint32_t                              memoryTypeBits,
+                         vk::MemoryPropertyFlags                    propertyFlags)
+    {
+        for (std::uint32_t i = 0; i < memoryProperties.memoryTypeCount; ++i) {
+            if ((memoryTypeBits & (1u << i))
+                && (memoryProperties.memoryTypes[i].propertyFlags & propertyFlags) == propertyFlags) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void copy_to_mappable_memory(vk::Device                     dev,
+                                 vk::DeviceMemory               memory,
+                                 const vector<std::uint8_t>&    contents)
+    {
+        void* mapped = dev.mapMemory(memory, 0, VK_WHOLE_SIZE);
+        std::memcpy(mapped, contents.data(), contents.size());
+        dev.unmapMemory(memory);
     }
 
+    void copy_through_staging_buffer(const device&                  inDevice,
+                                     vk::Buffer                     dst,
+                                     const vector<std::uint8_t>&    contents)
+    {
+        const vk::Device dev = inDevice.getDevice();
+
+        vulkan_utils::storage_buffer staging(dev, inDevice.getMemoryProperties(), contents.size());
+        {
+            auto stagingMap = staging.map<std::uint8_t>();
+            std::memcpy(stagingMap.get(), contents.data(), contents.size());
+        }
+
+        vk::BufferMemoryBarrier barrier;
+        barrier.setSrcAccessMask(vk::AccessFlagBits::eTransferWrite)
+                .setDstAccessMask(vk::AccessFlagBits::eShaderRead)
+                .setSize(VK_WHOLE_SIZE)
+                .setBuffer(dst);
+
+        auto command = vulkan_utils::allocate_command_buffer(dev, inDevice.getCommandPool());
+        command->begin(vk::CommandBufferBeginInfo(vk::CommandBufferUsageFlagBits::eOneTimeSubmit));
+        command->copyBuffer(staging.use().buffer, dst, vk::BufferCopy(0, 0, contents.size()));
+        command->pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
+                                 vk::PipelineStageFlagBits::eComputeShader,
+                                 vk::DependencyFlags(),
+                                 nullptr,   // memory barriers
+                                 barrier,   // buffer memory barriers
+                                 nullptr);  // image memory barriers
+        command->end();
+
+        vk::CommandBuffer rawCommand = *command;
+        vk::SubmitInfo submitInfo;
+        submitInfo.setCommandBufferCount(1)
+                .setPCommandBuffers(&rawCommand);
+
+        inDevice.getComputeQueue().submit(submitInfo, nullptr);
+        inDevice.getComputeQueue().waitIdle();
+    }
 
 } // anonymous namespace
 
 namespace clspv_utils {
 
+    module::shader_ptr module::createShaderObjects(vk::Device                   dev,
+                                                   const vector<std::uint32_t>& spvWords)
+    {
+        vk::ShaderModuleCreateInfo shaderModuleCreateInfo;
+        shaderModuleCreateInfo.setCodeSize(spvWords.size() * sizeof(std::uint32_t))
+                .setPCode(spvWords.data());
+
+        auto result = std::make_shared<shader_objects>();
+        result->mShaderModule = dev.createShaderModuleUnique(shaderModuleCreateInfo);
+        result->mPipelineCache = dev.createPipelineCacheUnique(vk::PipelineCacheCreateInfo());
+
+        return result;
+    }
+
+    module::constants_ptr module::createConstantObjects(device                  inDevice,
+                                                        const module_spec_t&    spec)
+    {
+        if (spec.mConstants.empty()) {
+            return constants_ptr();
+        }
+
+        const vk::Device dev = inDevice.getDevice();
+
+        // Pack every constant into one buffer, each at an offset usable as a descriptor range
+        const vk::DeviceSize alignment = std::max<vk::DeviceSize>(1, inDevice.getPhysicalDevice().getProperties().limits.minStorageBufferOffsetAlignment);
+
+        vector<vk::DeviceSize> offsets;
+        vk::DeviceSize totalSize = 0;
+        for (auto& c : spec.mConstants) {
+            totalSize = (totalSize + alignment - 1) / alignment * alignment;
+            offsets.push_back(totalSize);
+            totalSize += c.mBytes.size();
+        }
+
+        vector<std::uint8_t> contents(totalSize, 0);
+        for (std::size_t i = 0; i < spec.mConstants.size(); ++i) {
+            const auto& bytes = spec.mConstants[i].mBytes;
+            std::copy(bytes.begin(), bytes.end(), contents.begin() + offsets[i]);
+        }
+
+        auto result = std::make_shared<constant_objects>();
+        result->mDescriptorSet = spec.mConstants.front().mDescriptorSet;
+
+        vk::BufferCreateInfo bufferInfo;
+        bufferInfo.setUsage(vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst)
+                .setSize(totalSize)
+                .setSharingMode(vk::SharingMode::eExclusive);
+        result->mBuffer = dev.createBufferUnique(bufferInfo);
+
+        // Prefer device local memory. Where it is also host visible (typical of mobile GPUs) the
+        // data is written directly; otherwise it is copied in through a staging buffer.
+        const auto& memoryProperties = inDevice.getMemoryProperties();
+        const auto memoryRequirements = dev.getBufferMemoryRequirements(*result->mBuffer);
+        const vk::MemoryPropertyFlags mappable = vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent;
+        const vk::MemoryPropertyFlags deviceLocal = vk::MemoryPropertyFlagBits::eDeviceLocal;
+
+        if (has_memory_type(memoryProperties, memoryRequirements.memoryTypeBits, deviceLocal | mappable)) {
+            result->mMemory = vulkan_utils::allocate_device_memory(dev, memoryRequirements, memoryProperties, deviceLocal | mappable);
+            dev.bindBufferMemory(*result->mBuffer, *result->mMemory, 0);
+            copy_to_mappable_memory(dev, *result->mMemory, contents);
+        }
+        else if (has_memory_type(memoryProperties, memoryRequirements.memoryTypeBits, deviceLocal)) {
+            result->mMemory = vulkan_utils::allocate_device_memory(dev, memoryRequirements, memoryProperties, deviceLocal);
+            dev.bindBufferMemory(*result->mBuffer, *result->mMemory, 0);
+            copy_through_staging_buffer(inDevice, *result->mBuffer, contents);
+        }
+        else {
+            result->mMemory = vulkan_utils::allocate_device_memory(dev, memoryRequirements, memoryProperties, mappable);
+            dev.bindBufferMemory(*result->mBuffer, *result->mMemory, 0);
+            copy_to_mappable_memory(dev, *result->mMemory, contents);
+        }
+
+        // clspv may put the literal samplers in the same descriptor set as the constants
+        const bool includeSamplers = (!spec.mSamplers.empty()
+                                      && getSamplersDescriptorSet(spec.mSamplers) == result->mDescriptorSet);
+
+        vector<vk::DescriptorSetLayoutBinding> bindingSet;
+
+        vk::DescriptorSetLayoutBinding binding;
+        binding.setStageFlags(vk::ShaderStageFlagBits::eCompute)
+                .setDescriptorCount(1);
+
+        for (auto& c : spec.mConstants) {
+            binding.descriptorType = vk::DescriptorType::eStorageBuffer;
+            binding.binding = c.mBinding;
+            bindingSet.push_back(binding);
+        }
+
+        if (includeSamplers) {
+            for (auto& s : spec.mSamplers) {
+                binding.descriptorType = vk::DescriptorType::eSampler;
+                binding.binding = s.mBinding;
+                bindingSet.push_back(binding);
+            }
+        }
+
+        vk::DescriptorSetLayoutCreateInfo layoutInfo;
+        layoutInfo.setBindingCount(bindingSet.size())
+                .setPBindings(bindingSet.data());
+        result->mLayout = dev.createDescriptorSetLayoutUnique(layoutInfo);
+        result->mDescriptor = allocateDescriptorSet(inDevice, *result->mLayout);
+
+        vector<vk::DescriptorBufferInfo> bufferInfos;
+        vector<vk::DescriptorImageInfo> samplerInfos;
+        vector<vk::WriteDescriptorSet> descriptorWrites;
+
+        // reserve up front so the pointers held by descriptorWrites stay valid
+        bufferInfos.reserve(spec.mConstants.size());
+        samplerInfos.reserve(spec.mSamplers.size());
+
+        for (std::size_t i = 0; i < spec.mConstants.size(); ++i) {
+            bufferInfos.push_back(vk::DescriptorBufferInfo(*result->mBuffer, offsets[i], spec.mConstants[i].mBytes.size()));
+
+            vk::WriteDescriptorSet constantSet;
+            constantSet.setDstSet(*result->mDescriptor)
+                    .setDstBinding(spec.mConstants[i].mBinding)
+                    .setDescriptorCount(1)
+                    .setDescriptorType(vk::DescriptorType::eStorageBuffer)
+                    .setPBufferInfo(&bufferInfos.back());
+            descriptorWrites.push_back(constantSet);
+        }
+
+        if (includeSamplers) {
+            for (auto& s : spec.mSamplers) {
+                vk::DescriptorImageInfo samplerInfo;
+                samplerInfo.setSampler(inDevice.getCachedSampler(s.mOpenclFlags));
+                samplerInfos.push_back(samplerInfo);
+
+                vk::WriteDescriptorSet samplerSet;
+                samplerSet.setDstSet(*result->mDescriptor)
+                        .setDstBinding(s.mBinding)
+                        .setDescriptorCount(1)
+                        .setDescriptorType(vk::DescriptorType::eSampler)
+                        .setPImageInfo(&samplerInfos.back());
+                descriptorWrites.push_back(samplerSet);
+            }
+        }
+
+        dev.updateDescriptorSets(descriptorWrites, nullptr);
+
+        return result;
+    }
+
     module::module()
     {
     }
@@ -56,17 +258,27 @@ namespace clspv_utils {
     module::module(std::istream&  spvmoduleStream,
                    device         inDevice,
                    module_spec_t  spec)
+            : module(inDevice,
+                     std::make_shared<module_spec_t>(std::move(spec)),
+                     createShaderObjects(inDevice.getDevice(), read_spv_words(spvmoduleStream)))
+    {
+    }
+
+    module::module(device       inDevice,
+                   spec_ptr     spec,
+                   shader_ptr   shaders)
             : mDevice(inDevice),
               mModuleSpec(spec),
-              mLiteralSamplerDescriptor(),
-              mLiteralSamplerDescriptorLayout()
+              mShaderObjects(shaders),
+              mConstantObjects(),
+              mModuleDescriptors()
     {
-        const auto literalSamplerDescriptorGroup = mDevice.getCachedSamplerDescriptorGroup(mModuleSpec.mSamplers);
-        mLiteralSamplerDescriptor = literalSamplerDescriptorGroup.mDescriptor;
-        mLiteralSamplerDescriptorLayout = literalSamplerDescriptorGroup.mLayout;
+        if (!mModuleSpec || !mShaderObjects)
+        {
+            fail_runtime_error("module requires both an interface and shader objects");
+        }
 
-        mShaderModule = create_shader(mDevice.getDevice(), spvmoduleStream);
-        mPipelineCache = mDevice.getDevice().createPipelineCacheUnique(vk::PipelineCacheCreateInfo());
+        initModuleDescriptors();
     }
 
     module::~module()
@@ -85,15 +297,34 @@ namespace clspv_utils {
 
         swap(mDevice, other.mDevice);
         swap(mModuleSpec, other.mModuleSpec);
-        swap(mLiteralSamplerDescriptorLayout, other.mLiteralSamplerDescriptorLayout);
-        swap(mLiteralSamplerDescriptor, other.mLiteralSamplerDescriptor);
-        swap(mShaderModule, other.mShaderModule);
-        swap(mPipelineCache, other.mPipelineCache);
+        swap(mShaderObjects, other.mShaderObjects);
+        swap(mConstantObjects, other.mConstantObjects);
+        swap(mModuleDescriptors, other.mModuleDescriptors);
+    }
+
+    void module::initModuleDescriptors()
+    {
+        mConstantObjects = createConstantObjects(mDevice, *mModuleSpec);
+        if (mConstantObjects) {
+            device::descriptor_group constantDescriptorGroup;
+            constantDescriptorGroup.mDescriptor = *mConstantObjects->mDescriptor;
+            constantDescriptorGroup.mLayout = *mConstantObjects->mLayout;
+            mModuleDescriptors[mConstantObjects->mDescriptorSet] = constantDescriptorGroup;
+        }
+
+        if (!mModuleSpec->mSamplers.empty()) {
+            // If the literal samplers share the constants' descriptor set, the constant objects
+            // already hold them
+            const int samplerDescriptorSet = getSamplersDescriptorSet(mModuleSpec->mSamplers);
+            if (0 == mModuleDescriptors.count(samplerDescriptorSet)) {
+                mModuleDescriptors[samplerDescriptorSet] = mDevice.getCachedSamplerDescriptorGroup(mModuleSpec->mSamplers);
+            }
+        }
     }
 
     vector<string> module::getEntryPoints() const
     {
-        return getEntryPointNames(mModuleSpec.mKernels);
+        return (mModuleSpec ? getEntryPointNames(mModuleSpec->mKernels) : vector<string>());
     }
 
     kernel_req_t module::createKernelReq(const string &entryPoint) const {
@@ -101,7 +332,7 @@ namespace clspv_utils {
             fail_runtime_error("cannot create layout for unloaded module");
         }
 
-        const auto kernelSpec = findKernelSpec(entryPoint, mModuleSpec.mKernels);
+        const auto kernelSpec = findKernelSpec(entryPoint, *mModuleSpec);
         if (!kernelSpec) {
             fail_runtime_error("cannot create kernel layout for unknown entry point");
         }
@@ -109,10 +340,9 @@ namespace clspv_utils {
         kernel_req_t result;
         result.mDevice = mDevice;
         result.mKernelSpec = *kernelSpec;
-        result.mShaderModule = *mShaderModule;
-        result.mPipelineCache = *mPipelineCache;
-        result.mLiteralSamplerDescriptor = mLiteralSamplerDescriptor;
-        result.mLiteralSamplerLayout = mLiteralSamplerDescriptorLayout;
+        result.mShaderModule = *mShaderObjects->mShaderModule;
+        result.mPipelineCache = *mShaderObjects->mPipelineCache;
+        result.mModuleDescriptors = mModuleDescriptors;
 
         return result;
     }
@@ -19,6 +19,33 @@ namespace clspv_utils {
 
     class module {
     public:
+        struct shader_objects {
+            vk::UniqueShaderModule  mShaderModule;
+            vk::UniquePipelineCache mPipelineCache;
+        };
+
+        // The module-scope constant data from the spvmap, uploaded into a single buffer, and the
+        // descriptor set through which every kernel in the module sees it. If the module's
+        // literal samplers use the same descriptor set number, the set holds them as well.
+        struct constant_objects {
+            vk::UniqueDeviceMemory          mMemory;
+            vk::UniqueBuffer                mBuffer;
+            vk::UniqueDescriptorSetLayout   mLayout;
+            vk::UniqueDescriptorSet         mDescriptor;
+            int                             mDescriptorSet  = -1;
+        };
+
+        typedef shared_ptr<const module_spec_t>     spec_ptr;
+        typedef shared_ptr<const shader_objects>    shader_ptr;
+        typedef shared_ptr<const constant_objects>  constants_ptr;
+
+        static shader_ptr       createShaderObjects(vk::Device                      dev,
+                                                    const vector<std::uint32_t>&    spvWords);
+
+        // Returns null if the module has no constants
+        static constants_ptr    createConstantObjects(device                dev,
+                                                      const module_spec_t&  spec);
+
                             module();
 
                             module(module&& other);
@@ -27,26 +54,32 @@ namespace clspv_utils {
                                    device        dev,
                                    module_spec_t spec);
 
+                            module(device       dev,
+                                   spec_ptr     spec,
+                                   shader_ptr   shaders);
+
                             ~module();
 
         module&             operator=(module&& other);
 
         void                swap(module& other);
 
-        bool                isLoaded() const { return (bool)(*mShaderModule); }
+        bool                isLoaded() const { return mShaderObjects && mShaderObjects->mShaderModule; }
 
         vector<string>      getEntryPoints() const;
 
         kernel_req_t        createKernelReq(const string &entryPoint) const;
 
     private:
-        device                  mDevice;
-        module_spec_t           mModuleSpec;
+        void                initModuleDescriptors();
+
+    private:
+        device                          mDevice;
+        spec_ptr                        mModuleSpec;
+        shader_ptr                      mShaderObjects;
+        constants_ptr                   mConstantObjects;
 
-        vk::DescriptorSetLayout mLiteralSamplerDescriptorLayout;
-        vk::DescriptorSet       mLiteralSamplerDescriptor;
-        vk::UniqueShaderModule  mShaderModule;
-        vk::UniquePipelineCache mPipelineCache;
+        device::descriptor_group_map    mModuleDescriptors;
     };
 
     inline void swap(module& lhs, module& rhs)
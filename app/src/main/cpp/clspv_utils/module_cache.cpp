@@ -0,0 +1,255 @@
+//
+// Created by Eric Berdahl on 5/14/18.
+//
+
+#include "module_cache.hpp"
+
+#include "hash_utils.hpp"
+#include "spirv_reflection.hpp"
+#include "spvmap_binary.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+
+namespace {
+    using namespace clspv_utils;
+
+    std::uint64_t compute_shader_key(vk::Device dev, const vector<std::uint32_t>& spvWords)
+    {
+        const VkDevice deviceHandle = static_cast<VkDevice>(dev);
+
+        const std::uint64_t wordsHash = computeContentHash(spvWords.data(), spvWords.size() * sizeof(std::uint32_t));
+        return computeContentHash(&deviceHandle, sizeof(deviceHandle), wordsHash);
+    }
+
+    module_spec_t parse_spvmap(const void* spvmap, std::size_t numBytes)
+    {
+        if (isBinaryModuleSpec(spvmap, numBytes))
+        {
+            return createModuleSpec(spvmap, numBytes);
+        }
+
+        const char* text = static_cast<const char*>(spvmap);
+        return createModuleSpec(text, text + numBytes);
+    }
+
+    // only the metadata SPIR-V lacks is taken from the spvmap, so it needn't be a complete interface
+    module_spec_t parse_spvmap_metadata(const void* spvmap, std::size_t numBytes)
+    {
+        if (isBinaryModuleSpec(spvmap, numBytes))
+        {
+            return createModuleSpec(spvmap, numBytes);
+        }
+
+        const char* text = static_cast<const char*>(spvmap);
+        return createModuleSpecMetadata(text, text + numBytes);
+    }
+
+    template <typename Map>
+    typename Map::iterator find_least_recently_used_unreferenced(Map& entries)
+    {
+        auto result = entries.end();
+
+        for (auto iter = entries.begin(); iter != entries.end(); ++iter)
+        {
+            if (iter->second.mValue.use_count() > 1) continue;
+
+            if (result == entries.end() || iter->second.mLastUse < result->second.mLastUse)
+            {
+                result = iter;
+            }
+        }
+
+        return result;
+    }
+
+} // anonymous namespace
+
+namespace clspv_utils {
+
+    const std::size_t module_cache::kDefaultCapacity;
+
+    module_cache::module_cache()
+            : module_cache(kDefaultCapacity)
+    {
+    }
+
+    module_cache::module_cache(std::size_t capacity)
+            : mCapacity(capacity),
+              mUseClock(0),
+              mSpecs(),
+              mShaders()
+    {
+    }
+
+    module::spec_ptr module_cache::getModuleSpec(const string& spvmapContents)
+    {
+        return getModuleSpec(spvmapContents.data(), spvmapContents.size());
+    }
+
+    module::spec_ptr module_cache::getModuleSpec(const void* spvmap, std::size_t numBytes)
+    {
+        return findOrCreateSpec(vector<std::uint32_t>(), spvmap, numBytes, -1, [spvmap, numBytes]() -> module::spec_ptr {
+            return std::make_shared<module_spec_t>(parse_spvmap(spvmap, numBytes));
+        });
+    }
+
+    module::spec_ptr module_cache::getModuleSpec(const vector<std::uint32_t>&   spvWords,
+                                                 const void*                    spvmap,
+                                                 std::size_t                    numBytes,
+                                                 reflection                     mode)
+    {
+        return findOrCreateSpec(spvWords, spvmap, numBytes, mode, [this, &spvWords, spvmap, numBytes, mode]() -> module::spec_ptr {
+            const auto reflected = reflectModuleSpec(spvWords);
+
+            if (reflection_combine == mode)
+            {
+                return std::make_shared<module_spec_t>(combineModuleSpecs(reflected, parse_spvmap_metadata(spvmap, numBytes)));
+            }
+
+            // the spvmap's own interface is shared with clients which don't reflect
+            const auto result = getModuleSpec(spvmap, numBytes);
+
+            const auto discrepancies = compareModuleSpecs(reflected, *result);
+            if (!discrepancies.empty())
+            {
+                std::ostringstream os;
+                os << "SPIR-V reflection disagrees with spvmap:";
+                for (const auto& d : discrepancies)
+                {
+                    os << "\n    " << d;
+                }
+                fail_runtime_error(os.str());
+            }
+
+            return result;
+        });
+    }
+
+    template <typename CreateFn>
+    module::spec_ptr module_cache::findOrCreateSpec(const vector<std::uint32_t>&    spvWords,
+                                                    const void*                     spvmap,
+                                                    std::size_t                     numBytes,
+                                                    int                             reflection,
+                                                    CreateFn                        create)
+    {
+        std::uint64_t key = computeContentHash(spvmap, numBytes);
+        if (-1 != reflection)
+        {
+            key = computeContentHash(spvWords.data(), spvWords.size() * sizeof(std::uint32_t), key);
+            key = computeContentHash(&reflection, sizeof(reflection), key);
+        }
+
+        const auto candidates = mSpecs.equal_range(key);
+        auto found = std::find_if(candidates.first, candidates.second, [&spvWords, spvmap, numBytes, reflection](const spec_map::value_type& candidate) {
+            const string& contents = candidate.second.mSpvmap;
+            return (candidate.second.mReflection == reflection
+                    && contents.size() == numBytes
+                    && 0 == std::memcmp(contents.data(), spvmap, numBytes)
+                    && candidate.second.mSpvWords == spvWords);
+        });
+        if (found == candidates.second)
+        {
+            spec_entry entry;
+            entry.mValue = create();
+            entry.mSpvmap.assign(static_cast<const char*>(spvmap), numBytes);
+            entry.mSpvWords = spvWords;
+            entry.mReflection = reflection;
+
+            found = mSpecs.insert(std::make_pair(key, entry));
+        }
+
+        found->second.mLastUse = ++mUseClock;
+        const auto result = found->second.mValue;
+
+        trim();
+
+        return result;
+    }
+
+    module::shader_ptr module_cache::getShaderObjects(vk::Device                    dev,
+                                                      const vector<std::uint32_t>&  spvWords)
+    {
+        const auto key = compute_shader_key(dev, spvWords);
+
+        const auto candidates = mShaders.equal_range(key);
+        auto found = std::find_if(candidates.first, candidates.second, [dev, &spvWords](const shader_map::value_type& candidate) {
+            return (candidate.second.mDevice == dev && candidate.second.mSpvWords == spvWords);
+        });
+        if (found == candidates.second)
+        {
+            shader_entry entry;
+            entry.mValue = module::createShaderObjects(dev, spvWords);
+            entry.mDevice = dev;
+            entry.mSpvWords = spvWords;
+
+            found = mShaders.insert(std::make_pair(key, entry));
+        }
+
+        found->second.mLastUse = ++mUseClock;
+        const auto result = found->second.mValue;
+
+        trim();
+
+        return result;
+    }
+
+    module module_cache::getModule(device                       dev,
+                                   const vector<std::uint32_t>& spvWords,
+                                   const string&                spvmapContents)
+    {
+        return module(dev,
+                      getModuleSpec(spvmapContents),
+                      getShaderObjects(dev.getDevice(), spvWords));
+    }
+
+    void module_cache::releaseDeviceObjects(vk::Device dev)
+    {
+        for (auto iter = mShaders.begin(); iter != mShaders.end(); )
+        {
+            iter = (iter->second.mDevice == dev ? mShaders.erase(iter) : std::next(iter));
+        }
+    }
+
+    void module_cache::evictUnreferenced()
+    {
+        for (auto iter = mSpecs.begin(); iter != mSpecs.end(); )
+        {
+            iter = (iter->second.mValue.use_count() > 1 ? std::next(iter) : mSpecs.erase(iter));
+        }
+
+        for (auto iter = mShaders.begin(); iter != mShaders.end(); )
+        {
+            iter = (iter->second.mValue.use_count() > 1 ? std::next(iter) : mShaders.erase(iter));
+        }
+    }
+
+    void module_cache::trim()
+    {
+        while (size() > mCapacity)
+        {
+            const auto spec = find_least_recently_used_unreferenced(mSpecs);
+            const auto shader = find_least_recently_used_unreferenced(mShaders);
+
+            const bool haveSpec = (spec != mSpecs.end());
+            const bool haveShader = (shader != mShaders.end());
+
+            if (!haveSpec && !haveShader)
+            {
+                // everything remaining is in use; let the cache grow past its capacity
+                break;
+            }
+
+            if (haveSpec && (!haveShader || spec->second.mLastUse < shader->second.mLastUse))
+            {
+                mSpecs.erase(spec);
+            }
+            else
+            {
+                mShaders.erase(shader);
+            }
+        }
+    }
+
+} // namespace clspv_utils
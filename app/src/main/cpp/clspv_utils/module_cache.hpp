@@ -0,0 +1,121 @@
+//
+// Created by Eric Berdahl on 5/14/18.
+//
+
+#ifndef CLSPVUTILS_MODULE_CACHE_HPP
+#define CLSPVUTILS_MODULE_CACHE_HPP
+
+#include "clspv_utils_fwd.hpp"
+
+#include "clspv_utils_interop.hpp"
+#include "device.hpp"
+#include "interface.hpp"
+#include "module.hpp"
+
+#include <vulkan/vulkan.hpp>
+
+#include <cstdint>
+
+namespace clspv_utils {
+
+    //
+    // module_cache shares the parsed module interface and the Vulkan objects backing a module
+    // among all clients which load the same content. Interfaces are keyed by a hash of the
+    // spvmap contents, and shader objects by a hash of the SPIR-V words and the owning device,
+    // so each distinct asset is parsed or created only once. Entries keep the content they were
+    // made from, and a hit is shared only if that content is identical, so a hash collision
+    // makes a second entry rather than returning the wrong one.
+    //
+    // Entries are reference counted through the shared_ptrs handed out to modules. Entries
+    // which are no longer referenced by any module are retained, so that a later request for
+    // the same content is a hit, until the number of entries exceeds the cache capacity. At
+    // that point the least recently used unreferenced entries are evicted.
+    //
+    class module_cache {
+    public:
+        static const std::size_t kDefaultCapacity = 16;
+
+        // How getModuleSpec relates the SPIR-V to the spvmap
+        enum reflection {
+            reflection_combine, // kernels, bindings and spec constants come from the SPIR-V, and
+                                // only the metadata SPIR-V lacks from the spvmap
+            reflection_verify   // the interface comes from the spvmap, checked against the SPIR-V
+        };
+
+                            module_cache();
+
+        explicit            module_cache(std::size_t capacity);
+
+        module::spec_ptr    getModuleSpec(const string& spvmapContents);
+
+        // spvmap may be either the CSV text or the binary form (see spvmap_binary.hpp)
+        module::spec_ptr    getModuleSpec(const void* spvmap, std::size_t numBytes);
+
+        //
+        // The interface of a module derived from both its SPIR-V and its spvmap, keyed by the two
+        // and the reflection mode, so that reflecting and merging happen once per module. With
+        // reflection_combine the spvmap is never parsed into a module interface of its own. A
+        // verification failure is thrown, and not cached.
+        //
+        module::spec_ptr    getModuleSpec(const vector<std::uint32_t>&  spvWords,
+                                          const void*                   spvmap,
+                                          std::size_t                   numBytes,
+                                          reflection                    mode);
+
+        module::shader_ptr  getShaderObjects(vk::Device                     dev,
+                                             const vector<std::uint32_t>&   spvWords);
+
+        module              getModule(device                        dev,
+                                      const vector<std::uint32_t>&  spvWords,
+                                      const string&                 spvmapContents);
+
+        // Drop every cached object created on the device. Modules which still reference those
+        // objects keep them alive until they are themselves destroyed.
+        void                releaseDeviceObjects(vk::Device dev);
+
+        // Drop every entry not currently referenced by a module.
+        void                evictUnreferenced();
+
+        std::size_t         size() const { return mSpecs.size() + mShaders.size(); }
+
+        std::size_t         getCapacity() const { return mCapacity; }
+
+    private:
+        struct spec_entry {
+            module::spec_ptr        mValue;
+            string                  mSpvmap;
+            vector<std::uint32_t>   mSpvWords;          // empty unless the interface was reflected
+            int                     mReflection = -1;   // a reflection, or -1 for the spvmap alone
+            std::uint64_t           mLastUse    = 0;
+        };
+
+        struct shader_entry {
+            module::shader_ptr      mValue;
+            vk::Device              mDevice;
+            vector<std::uint32_t>   mSpvWords;
+            std::uint64_t           mLastUse    = 0;
+        };
+
+        // keyed by content hash; entries with the same hash are told apart by their content
+        typedef std::multimap<std::uint64_t, spec_entry>    spec_map;
+        typedef std::multimap<std::uint64_t, shader_entry>  shader_map;
+
+        template <typename CreateFn>
+        module::spec_ptr    findOrCreateSpec(const vector<std::uint32_t>&   spvWords,
+                                             const void*                    spvmap,
+                                             std::size_t                    numBytes,
+                                             int                            reflection,
+                                             CreateFn                       create);
+
+        void                trim();
+
+    private:
+        std::size_t     mCapacity;
+        std::uint64_t   mUseClock;
+        spec_map        mSpecs;
+        shader_map      mShaders;
+    };
+
+}
+
+#endif //CLSPVUTILS_MODULE_CACHE_HPP
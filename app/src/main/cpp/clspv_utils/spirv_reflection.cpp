@@ -0,0 +1,562 @@
+//
+// Created by Eric Berdahl on 5/15/18.
+//
+
+#include "spirv_reflection.hpp"
+
+#include <algorithm>
+#include <set>
+#include <sstream>
+#include <tuple>
+
+namespace {
+    using namespace clspv_utils;
+
+    //
+    // The small subset of the SPIR-V grammar the reflector needs. Values are from the SPIR-V
+    // 1.0 specification; we don't pull in spirv.hpp just for these.
+    //
+
+    const std::uint32_t kSpirvMagicNumber   = 0x07230203;
+    const std::size_t   kSpirvHeaderWords   = 5;
+
+    enum spirv_op : std::uint32_t {
+        OpEntryPoint                = 15,
+        OpTypeImage                 = 25,
+        OpTypeSampler               = 26,
+        OpTypeArray                 = 28,
+        OpTypeRuntimeArray          = 29,
+        OpTypeStruct                = 30,
+        OpTypePointer               = 32,
+        OpFunction                  = 54,
+        OpFunctionEnd               = 56,
+        OpFunctionCall              = 57,
+        OpVariable                  = 59,
+        OpImageTexelPointer         = 60,
+        OpLoad                      = 61,
+        OpStore                     = 62,
+        OpCopyMemory                = 63,
+        OpCopyMemorySized           = 64,
+        OpAccessChain               = 65,
+        OpInBoundsAccessChain       = 66,
+        OpPtrAccessChain            = 67,
+        OpInBoundsPtrAccessChain    = 70,
+        OpDecorate                  = 71
+    };
+
+    enum spirv_decoration : std::uint32_t {
+        DecorationSpecId        = 1,
+        DecorationBlock         = 2,
+        DecorationBufferBlock   = 3,
+        DecorationBinding       = 33,
+        DecorationDescriptorSet = 34
+    };
+
+    enum spirv_storage_class : std::uint32_t {
+        StorageClassUniformConstant = 0,
+        StorageClassUniform         = 2,
+        StorageClassWorkgroup       = 4,
+        StorageClassStorageBuffer   = 12
+    };
+
+    const std::uint32_t kExecutionModelGLCompute = 5;
+
+    struct id_decorations {
+        int     mDescriptorSet  = -1;
+        int     mBinding        = -1;
+        int     mSpecId         = -1;
+        bool    mBufferBlock    = false;
+    };
+
+    struct type_info {
+        std::uint32_t           mOpcode = 0;
+        vector<std::uint32_t>   mOperands;  // the words following the result id
+    };
+
+    struct entry_point_info {
+        std::uint32_t   mFunction;
+        string          mName;
+    };
+
+    struct reflection_state {
+        map<std::uint32_t, id_decorations>          mDecorations;
+        map<std::uint32_t, type_info>               mTypes;
+        map<std::uint32_t, std::uint32_t>           mVariableTypes;     // variable id -> pointer type id
+        map<std::uint32_t, std::set<std::uint32_t>> mFunctionVariables; // function id -> referenced variables
+        map<std::uint32_t, std::set<std::uint32_t>> mFunctionCallees;   // function id -> called functions
+        vector<entry_point_info>                    mEntryPoints;
+        std::uint32_t                               mCurrentFunction    = 0;
+    };
+
+    string read_literal_string(const std::uint32_t* first, const std::uint32_t* last)
+    {
+        string result;
+
+        for (; first != last; ++first)
+        {
+            for (int shift = 0; shift < 32; shift += 8)
+            {
+                const char c = static_cast<char>((*first >> shift) & 0xff);
+                if (0 == c) return result;
+                result.push_back(c);
+            }
+        }
+
+        fail_runtime_error("unterminated SPIR-V literal string");
+        return result;
+    }
+
+    void note_variable_use(reflection_state& state, std::uint32_t id)
+    {
+        if (0 != state.mCurrentFunction && state.mVariableTypes.count(id))
+        {
+            state.mFunctionVariables[state.mCurrentFunction].insert(id);
+        }
+    }
+
+    void reflect_instruction(reflection_state& state, const std::uint32_t* inst, std::uint32_t wordCount)
+    {
+        const std::uint32_t opcode = inst[0] & 0xffff;
+
+        switch (opcode)
+        {
+            case OpEntryPoint:
+                if (wordCount >= 4 && kExecutionModelGLCompute == inst[1])
+                {
+                    state.mEntryPoints.push_back(entry_point_info{ inst[2], read_literal_string(inst + 3, inst + wordCount) });
+                }
+                break;
+
+            case OpDecorate:
+                if (wordCount >= 3)
+                {
+                    auto& decorations = state.mDecorations[inst[1]];
+                    switch (inst[2])
+                    {
+                        case DecorationSpecId:          if (wordCount >= 4) decorations.mSpecId = inst[3]; break;
+                        case DecorationBufferBlock:     decorations.mBufferBlock = true; break;
+                        case DecorationBinding:         if (wordCount >= 4) decorations.mBinding = inst[3]; break;
+                        case DecorationDescriptorSet:   if (wordCount >= 4) decorations.mDescriptorSet = inst[3]; break;
+                        default: break;
+                    }
+                }
+                break;
+
+            case OpTypeImage:
+            case OpTypeSampler:
+            case OpTypeArray:
+            case OpTypeRuntimeArray:
+            case OpTypeStruct:
+            case OpTypePointer:
+                if (wordCount >= 2)
+                {
+                    auto& type = state.mTypes[inst[1]];
+                    type.mOpcode = opcode;
+                    type.mOperands.assign(inst + 2, inst + wordCount);
+                }
+                break;
+
+            case OpVariable:
+                // Only module-scope variables can be kernel arguments; they all precede the
+                // first function, so anything declared inside a function is ignored.
+                if (wordCount >= 4 && 0 == state.mCurrentFunction)
+                {
+                    state.mVariableTypes[inst[2]] = inst[1];
+                }
+                break;
+
+            case OpFunction:
+                if (wordCount >= 3)
+                {
+                    state.mCurrentFunction = inst[2];
+                    state.mFunctionVariables[state.mCurrentFunction];
+                }
+                break;
+
+            case OpFunctionEnd:
+                state.mCurrentFunction = 0;
+                break;
+
+            case OpFunctionCall:
+                if (wordCount >= 4)
+                {
+                    state.mFunctionCallees[state.mCurrentFunction].insert(inst[3]);
+                    for (std::uint32_t i = 4; i < wordCount; ++i)
+                    {
+                        note_variable_use(state, inst[i]);
+                    }
+                }
+                break;
+
+            case OpLoad:
+            case OpAccessChain:
+            case OpInBoundsAccessChain:
+            case OpPtrAccessChain:
+            case OpInBoundsPtrAccessChain:
+            case OpImageTexelPointer:
+                if (wordCount >= 4) note_variable_use(state, inst[3]);
+                break;
+
+            case OpStore:
+            case OpCopyMemory:
+            case OpCopyMemorySized:
+                if (wordCount >= 3)
+                {
+                    note_variable_use(state, inst[1]);
+                    note_variable_use(state, inst[2]);
+                }
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    const type_info* find_type(const reflection_state& state, std::uint32_t id)
+    {
+        const auto found = state.mTypes.find(id);
+        return (found == state.mTypes.end() ? nullptr : &found->second);
+    }
+
+    id_decorations find_decorations(const reflection_state& state, std::uint32_t id)
+    {
+        const auto found = state.mDecorations.find(id);
+        return (found == state.mDecorations.end() ? id_decorations() : found->second);
+    }
+
+    bool is_first_member_array(const reflection_state& state, const type_info& structType, std::uint32_t arrayOpcode)
+    {
+        if (OpTypeStruct != structType.mOpcode || structType.mOperands.empty()) return false;
+
+        const auto member = find_type(state, structType.mOperands[0]);
+        return (member && member->mOpcode == arrayOpcode);
+    }
+
+    // Returns true and fills in arg if the variable is something a kernel argument could be bound to
+    bool classify_variable(const reflection_state& state, std::uint32_t variable, arg_spec_t& arg)
+    {
+        const auto pointerType = find_type(state, state.mVariableTypes.find(variable)->second);
+        if (!pointerType || OpTypePointer != pointerType->mOpcode || pointerType->mOperands.size() < 2) return false;
+
+        const auto storageClass = pointerType->mOperands[0];
+        const auto pointee = find_type(state, pointerType->mOperands[1]);
+        if (!pointee) return false;
+
+        const auto decorations = find_decorations(state, variable);
+
+        arg = arg_spec_t();
+
+        if (StorageClassWorkgroup == storageClass)
+        {
+            // local arguments are workgroup arrays sized by a specialization constant
+            if (OpTypeArray != pointee->mOpcode || pointee->mOperands.size() < 2) return false;
+
+            const int specId = find_decorations(state, pointee->mOperands[1]).mSpecId;
+            if (specId < 0) return false;
+
+            arg.mKind = arg_spec_t::kind_local;
+            arg.mSpecConstant = specId;
+            return true;
+        }
+
+        if (decorations.mDescriptorSet < 0 || decorations.mBinding < 0) return false;
+
+        arg.mDescriptorSet = decorations.mDescriptorSet;
+        arg.mBinding = decorations.mBinding;
+        arg.mOffset = 0;
+
+        switch (storageClass)
+        {
+            case StorageClassUniformConstant:
+                if (OpTypeSampler == pointee->mOpcode)
+                {
+                    arg.mKind = arg_spec_t::kind_sampler;
+                }
+                else if (OpTypeImage == pointee->mOpcode && pointee->mOperands.size() >= 6)
+                {
+                    // Sampled operand: 1 => used with a sampler, 2 => used as a storage image
+                    arg.mKind = (2 == pointee->mOperands[5] ? arg_spec_t::kind_wo_image : arg_spec_t::kind_ro_image);
+                }
+                break;
+
+            case StorageClassStorageBuffer:
+                arg.mKind = (is_first_member_array(state, *pointee, OpTypeRuntimeArray) ? arg_spec_t::kind_buffer : arg_spec_t::kind_pod);
+                break;
+
+            case StorageClassUniform:
+                if (find_decorations(state, pointerType->mOperands[1]).mBufferBlock)
+                {
+                    // pre-StorageBuffer storage class encoding of a storage buffer
+                    arg.mKind = (is_first_member_array(state, *pointee, OpTypeRuntimeArray) ? arg_spec_t::kind_buffer : arg_spec_t::kind_pod);
+                }
+                else
+                {
+                    arg.mKind = (is_first_member_array(state, *pointee, OpTypeArray) ? arg_spec_t::kind_buffer_ubo : arg_spec_t::kind_pod_ubo);
+                }
+                break;
+
+            default:
+                break;
+        }
+
+        return (arg_spec_t::kind_unknown != arg.mKind);
+    }
+
+    std::set<std::uint32_t> collect_reachable_variables(const reflection_state& state, std::uint32_t entryFunction)
+    {
+        std::set<std::uint32_t> result;
+        std::set<std::uint32_t> visited;
+        vector<std::uint32_t>   pending(1, entryFunction);
+
+        while (!pending.empty())
+        {
+            const auto fn = pending.back();
+            pending.pop_back();
+
+            if (!visited.insert(fn).second) continue;
+
+            const auto vars = state.mFunctionVariables.find(fn);
+            if (vars != state.mFunctionVariables.end())
+            {
+                result.insert(vars->second.begin(), vars->second.end());
+            }
+
+            const auto callees = state.mFunctionCallees.find(fn);
+            if (callees != state.mFunctionCallees.end())
+            {
+                pending.insert(pending.end(), callees->second.begin(), callees->second.end());
+            }
+        }
+
+        return result;
+    }
+
+    bool is_literal_sampler_or_constant(const arg_spec_t& arg, const module_spec_t& spvmap)
+    {
+        if (arg_spec_t::kind_local == arg.mKind) return false;
+
+        const bool isSampler = std::any_of(spvmap.mSamplers.begin(), spvmap.mSamplers.end(), [&arg](const sampler_spec_t& s) {
+            return s.mDescriptorSet == arg.mDescriptorSet && s.mBinding == arg.mBinding;
+        });
+        const bool isConstant = std::any_of(spvmap.mConstants.begin(), spvmap.mConstants.end(), [&arg](const constant_spec_t& c) {
+            return c.mDescriptorSet == arg.mDescriptorSet && c.mBinding == arg.mBinding;
+        });
+
+        return isSampler || isConstant;
+    }
+
+    bool is_same_argument_slot(const arg_spec_t& reflected, const arg_spec_t& spvmap)
+    {
+        const bool reflectedIsLocal = (arg_spec_t::kind_local == reflected.mKind);
+        const bool spvmapIsLocal = (arg_spec_t::kind_local == spvmap.mKind);
+
+        if (reflectedIsLocal || spvmapIsLocal)
+        {
+            return reflectedIsLocal && spvmapIsLocal && reflected.mSpecConstant == spvmap.mSpecConstant;
+        }
+
+        return reflected.mDescriptorSet == spvmap.mDescriptorSet && reflected.mBinding == spvmap.mBinding;
+    }
+
+    bool is_compatible_kind(const arg_spec_t& reflected, const arg_spec_t& spvmap)
+    {
+        if (arg_spec_t::kind_local == reflected.mKind || arg_spec_t::kind_local == spvmap.mKind)
+        {
+            return reflected.mKind == spvmap.mKind;
+        }
+
+        // The reflector can't always tell a pod from a buffer (both are structs in a buffer),
+        // so only insist that the descriptor types agree.
+        return getDescriptorType(reflected.mKind) == getDescriptorType(spvmap.mKind);
+    }
+
+    string describe_arg(const string& kernelName, const arg_spec_t& arg)
+    {
+        std::ostringstream os;
+        os << "kernel '" << kernelName << "' ";
+        if (arg_spec_t::kind_local == arg.mKind)
+        {
+            os << "local argument with SpecId " << arg.mSpecConstant;
+        }
+        else
+        {
+            os << "argument at descriptorSet " << arg.mDescriptorSet << " binding " << arg.mBinding;
+        }
+        return os.str();
+    }
+
+} // anonymous namespace
+
+namespace clspv_utils {
+
+    module_spec_t reflectModuleSpec(const vector<std::uint32_t>& spvWords)
+    {
+        if (spvWords.size() < kSpirvHeaderWords || kSpirvMagicNumber != spvWords[0])
+        {
+            fail_runtime_error("not a SPIR-V module");
+        }
+
+        reflection_state state;
+
+        const std::uint32_t* inst = spvWords.data() + kSpirvHeaderWords;
+        const std::uint32_t* const last = spvWords.data() + spvWords.size();
+        while (inst < last)
+        {
+            const std::uint32_t wordCount = inst[0] >> 16;
+            if (0 == wordCount || wordCount > static_cast<std::size_t>(last - inst))
+            {
+                fail_runtime_error("malformed SPIR-V instruction stream");
+            }
+
+            reflect_instruction(state, inst, wordCount);
+            inst += wordCount;
+        }
+
+        module_spec_t result;
+
+        for (const auto& ep : state.mEntryPoints)
+        {
+            kernel_spec_t kernel;
+            kernel.mName = ep.mName;
+
+            for (auto variable : collect_reachable_variables(state, ep.mFunction))
+            {
+                arg_spec_t arg;
+                if (classify_variable(state, variable, arg))
+                {
+                    kernel.mArguments.push_back(arg);
+                }
+            }
+
+            std::sort(kernel.mArguments.begin(), kernel.mArguments.end(), [](const arg_spec_t& lhs, const arg_spec_t& rhs) {
+                return std::tie(lhs.mDescriptorSet, lhs.mBinding, lhs.mSpecConstant)
+                       < std::tie(rhs.mDescriptorSet, rhs.mBinding, rhs.mSpecConstant);
+            });
+
+            result.mKernels.push_back(kernel);
+        }
+
+        indexKernelSpecs(result);
+
+        return result;
+    }
+
+    module_spec_t combineModuleSpecs(const module_spec_t& reflected,
+                                     const module_spec_t& spvmapMetadata)
+    {
+        module_spec_t result;
+        result.mSamplers = spvmapMetadata.mSamplers;
+        result.mConstants = spvmapMetadata.mConstants;
+
+        for (const auto& metaKernel : spvmapMetadata.mKernels)
+        {
+            if (!findKernelSpec(metaKernel.mName, reflected))
+            {
+                fail_runtime_error("spvmap kernel '" + metaKernel.mName + "' is not a SPIR-V entry point");
+            }
+        }
+
+        for (const auto& reflectedKernel : reflected.mKernels)
+        {
+            kernel_spec_t kernel;
+            kernel.mName = reflectedKernel.mName;
+
+            const kernel_spec_t* metaKernel = findKernelSpec(reflectedKernel.mName, spvmapMetadata);
+            vector<bool> metaArgUsed(metaKernel ? metaKernel->mArguments.size() : 0, false);
+
+            for (const auto& ra : reflectedKernel.mArguments)
+            {
+                if (is_literal_sampler_or_constant(ra, spvmapMetadata)) continue;
+
+                bool found = false;
+                for (std::size_t i = 0; i < metaArgUsed.size(); ++i)
+                {
+                    const auto& ma = metaKernel->mArguments[i];
+                    if (!is_same_argument_slot(ra, ma)) continue;
+
+                    if (!is_compatible_kind(ra, ma))
+                    {
+                        fail_runtime_error(describe_arg(kernel.mName, ra) + " has a different kind in the spvmap");
+                    }
+
+                    // Several pod arguments may be packed into one binding at different offsets
+                    arg_spec_t arg = ra;
+                    arg.mKind = ma.mKind;
+                    arg.mOrdinal = ma.mOrdinal;
+                    arg.mOffset = ma.mOffset;
+                    kernel.mArguments.push_back(arg);
+
+                    metaArgUsed[i] = true;
+                    found = true;
+                }
+
+                if (!found)
+                {
+                    fail_runtime_error(describe_arg(kernel.mName, ra) + " has no spvmap entry");
+                }
+            }
+
+            // Arguments the kernel never references are still part of its signature
+            for (std::size_t i = 0; i < metaArgUsed.size(); ++i)
+            {
+                if (!metaArgUsed[i]) kernel.mArguments.push_back(metaKernel->mArguments[i]);
+            }
+
+            result.mKernels.push_back(kernel);
+        }
+
+        // the metadata may not have been standardized, so neither are the samplers taken from it
+        standardizeModuleSpec(result);
+        validateModule(result);
+
+        return result;
+    }
+
+    vector<string> compareModuleSpecs(const module_spec_t& reflected,
+                                      const module_spec_t& spvmap)
+    {
+        vector<string> result;
+
+        for (const auto& mk : spvmap.mKernels)
+        {
+            const auto rk = findKernelSpec(mk.mName, reflected);
+            if (!rk)
+            {
+                result.push_back("spvmap kernel '" + mk.mName + "' is not a SPIR-V entry point");
+                continue;
+            }
+
+            for (const auto& ma : mk.mArguments)
+            {
+                for (const auto& ra : rk->mArguments)
+                {
+                    if (is_same_argument_slot(ra, ma) && !is_compatible_kind(ra, ma))
+                    {
+                        result.push_back(describe_arg(mk.mName, ma) + " has a different kind in the SPIR-V");
+                    }
+                }
+            }
+        }
+
+        for (const auto& rk : reflected.mKernels)
+        {
+            const auto mk = findKernelSpec(rk.mName, spvmap);
+
+            for (const auto& ra : rk.mArguments)
+            {
+                if (is_literal_sampler_or_constant(ra, spvmap)) continue;
+
+                const bool described = mk && std::any_of(mk->mArguments.begin(), mk->mArguments.end(), [&ra](const arg_spec_t& ma) {
+                    return is_same_argument_slot(ra, ma);
+                });
+                if (!described)
+                {
+                    result.push_back(describe_arg(rk.mName, ra) + " is not described by the spvmap");
+                }
+            }
+        }
+
+        return result;
+    }
+
+} // namespace clspv_utils
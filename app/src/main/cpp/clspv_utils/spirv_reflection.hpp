@@ -0,0 +1,47 @@
+//
+// Created by Eric Berdahl on 5/15/18.
+//
+
+#ifndef CLSPVUTILS_SPIRV_REFLECTION_HPP
+#define CLSPVUTILS_SPIRV_REFLECTION_HPP
+
+#include "clspv_utils_fwd.hpp"
+
+#include "clspv_utils_interop.hpp"
+#include "interface.hpp"
+
+#include <cstdint>
+
+namespace clspv_utils {
+
+    /*
+     * Build a module_spec_t from the SPIR-V itself, in a single pass over the word stream. Each
+     * GLCompute entry point becomes a kernel_spec_t whose arguments are the descriptor-bound and
+     * spec-constant-sized workgroup variables that its call tree references.
+     *
+     * SPIR-V does not record argument ordinals, pod offsets, or the OpenCL flags of literal
+     * samplers, so the reflected arguments have mOrdinal == -1 and the result has no samplers or
+     * constants. Use combineModuleSpecs to supply that metadata from the spvmap.
+     */
+    module_spec_t   reflectModuleSpec(const vector<std::uint32_t>& spvWords);
+
+    /*
+     * Merge a reflected module with the metadata only the spvmap can provide. Kernels, bindings
+     * and spec constants come from the reflected spec; ordinals, pod offsets, literal samplers and
+     * constants come from the spvmap. Fails if a reflected argument has no spvmap counterpart.
+     * The metadata need not be standardized or validated (see createModuleSpecMetadata); the
+     * result is both.
+     */
+    module_spec_t   combineModuleSpecs(const module_spec_t& reflected,
+                                       const module_spec_t& spvmapMetadata);
+
+    /*
+     * Cross-check a reflected module against the spec parsed from its spvmap. Returns a
+     * description of each discrepancy; an empty result means the two agree.
+     */
+    vector<string>  compareModuleSpecs(const module_spec_t& reflected,
+                                       const module_spec_t& spvmap);
+
+}
+
+#endif //CLSPVUTILS_SPIRV_REFLECTION_HPP
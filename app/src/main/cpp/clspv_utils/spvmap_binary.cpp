@@ -0,0 +1,197 @@
+//
+// Created by Eric Berdahl on 5/16/18.
+//
+
+#include "spvmap_binary.hpp"
+
+#include <cstring>
+#include <type_traits>
+
+namespace {
+    using namespace clspv_utils;
+
+    static_assert(sizeof(binary_spvmap_header) == 8 * sizeof(std::uint32_t), "unexpected padding in binary_spvmap_header");
+    static_assert(sizeof(binary_spvmap_sampler) == 3 * sizeof(std::uint32_t), "unexpected padding in binary_spvmap_sampler");
+    static_assert(sizeof(binary_spvmap_constant) == 4 * sizeof(std::uint32_t), "unexpected padding in binary_spvmap_constant");
+    static_assert(sizeof(binary_spvmap_kernel) == 4 * sizeof(std::uint32_t), "unexpected padding in binary_spvmap_kernel");
+    static_assert(sizeof(binary_spvmap_arg) == 6 * sizeof(std::uint32_t), "unexpected padding in binary_spvmap_arg");
+
+    const arg_spec_t::kind kBinaryKind_ArgKind_Map[] = {
+            arg_spec_t::kind_pod,           // binary_kind_pod
+            arg_spec_t::kind_pod_ubo,       // binary_kind_pod_ubo
+            arg_spec_t::kind_buffer,        // binary_kind_buffer
+            arg_spec_t::kind_buffer_ubo,    // binary_kind_buffer_ubo
+            arg_spec_t::kind_ro_image,      // binary_kind_ro_image
+            arg_spec_t::kind_wo_image,      // binary_kind_wo_image
+            arg_spec_t::kind_sampler,       // binary_kind_sampler
+            arg_spec_t::kind_local          // binary_kind_local
+    };
+
+    // Reads consecutive fixed-size records out of the mapped file. The mapping carries no
+    // alignment guarantee, so records are copied out rather than accessed in place.
+    class record_reader {
+    public:
+        record_reader(const void* data, std::size_t numBytes)
+                : mNext(static_cast<const std::uint8_t*>(data)),
+                  mEnd(mNext + numBytes)
+        {
+        }
+
+        template <typename Record>
+        Record read()
+        {
+            static_assert(std::is_trivially_copyable<Record>::value, "binary spvmap records must be trivially copyable");
+
+            Record result;
+            std::memcpy(&result, take(sizeof(Record)), sizeof(Record));
+            return result;
+        }
+
+        const std::uint8_t* take(std::uint64_t numBytes)
+        {
+            if (numBytes > static_cast<std::uint64_t>(mEnd - mNext))
+            {
+                fail_runtime_error("binary spvmap is truncated");
+            }
+
+            const std::uint8_t* result = mNext;
+            mNext += numBytes;
+            return result;
+        }
+
+        std::uint64_t remaining() const
+        {
+            return static_cast<std::uint64_t>(mEnd - mNext);
+        }
+
+    private:
+        const std::uint8_t* mNext;
+        const std::uint8_t* mEnd;
+    };
+
+} // anonymous namespace
+
+namespace clspv_utils {
+
+    bool isBinaryModuleSpec(const void* data, std::size_t numBytes)
+    {
+        std::uint32_t magic = 0;
+        if (numBytes < sizeof(magic)) return false;
+
+        std::memcpy(&magic, data, sizeof(magic));
+        return (kBinarySpvmapMagic == magic);
+    }
+
+    module_spec_t createModuleSpec(const void* binarySpvmap, std::size_t numBytes)
+    {
+        record_reader in(binarySpvmap, numBytes);
+
+        const auto header = in.read<binary_spvmap_header>();
+        if (kBinarySpvmapMagic != header.mMagic)
+        {
+            fail_runtime_error("not a binary spvmap");
+        }
+        if (kBinarySpvmapVersion != header.mVersion)
+        {
+            fail_runtime_error("unsupported binary spvmap version");
+        }
+
+        // The counts are untrusted, so check that the file holds everything they describe before
+        // sizing anything from them. Each term is at most 2^32 * 24 bytes, so the sum can't overflow.
+        const std::uint64_t numBodyBytes = std::uint64_t(header.mNumSamplers) * sizeof(binary_spvmap_sampler)
+                                           + std::uint64_t(header.mNumConstants) * sizeof(binary_spvmap_constant)
+                                           + std::uint64_t(header.mNumKernels) * sizeof(binary_spvmap_kernel)
+                                           + std::uint64_t(header.mNumArgs) * sizeof(binary_spvmap_arg)
+                                           + header.mStringBytes
+                                           + header.mConstantBytes;
+        if (numBodyBytes > in.remaining())
+        {
+            fail_runtime_error("binary spvmap is truncated");
+        }
+
+        module_spec_t result;
+
+        result.mSamplers.reserve(header.mNumSamplers);
+        for (std::uint32_t i = 0; i < header.mNumSamplers; ++i)
+        {
+            const auto record = in.read<binary_spvmap_sampler>();
+
+            sampler_spec_t sampler;
+            sampler.mOpenclFlags = record.mOpenclFlags;
+            sampler.mDescriptorSet = record.mDescriptorSet;
+            sampler.mBinding = record.mBinding;
+            result.mSamplers.push_back(sampler);
+        }
+
+        vector<binary_spvmap_constant> constants(header.mNumConstants);
+        for (auto& c : constants)
+        {
+            c = in.read<binary_spvmap_constant>();
+        }
+
+        vector<binary_spvmap_kernel> kernels(header.mNumKernels);
+        for (auto& k : kernels)
+        {
+            k = in.read<binary_spvmap_kernel>();
+        }
+
+        vector<arg_spec_t> args;
+        args.reserve(header.mNumArgs);
+        for (std::uint32_t i = 0; i < header.mNumArgs; ++i)
+        {
+            const auto record = in.read<binary_spvmap_arg>();
+            if (record.mKind >= sizeof(kBinaryKind_ArgKind_Map) / sizeof(kBinaryKind_ArgKind_Map[0]))
+            {
+                fail_runtime_error("unknown argKind encountered in binary spvmap");
+            }
+
+            arg_spec_t arg;
+            arg.mKind = kBinaryKind_ArgKind_Map[record.mKind];
+            arg.mOrdinal = record.mOrdinal;
+            arg.mDescriptorSet = record.mDescriptorSet;
+            arg.mBinding = record.mBinding;
+            arg.mOffset = record.mOffset;
+            arg.mSpecConstant = record.mSpecConstant;
+            args.push_back(arg);
+        }
+
+        const char* strings = reinterpret_cast<const char*>(in.take(header.mStringBytes));
+        const std::uint8_t* constantData = in.take(header.mConstantBytes);
+
+        result.mKernels.reserve(kernels.size());
+        for (const auto& k : kernels)
+        {
+            if (std::uint64_t(k.mNameOffset) + k.mNameSize > header.mStringBytes
+                || std::uint64_t(k.mFirstArg) + k.mNumArgs > args.size())
+            {
+                fail_runtime_error("binary spvmap kernel record is out of range");
+            }
+
+            kernel_spec_t kernel;
+            kernel.mName.assign(strings + k.mNameOffset, k.mNameSize);
+            kernel.mArguments.assign(args.begin() + k.mFirstArg, args.begin() + k.mFirstArg + k.mNumArgs);
+            result.mKernels.push_back(std::move(kernel));
+        }
+
+        result.mConstants.reserve(constants.size());
+        for (const auto& c : constants)
+        {
+            if (std::uint64_t(c.mDataOffset) + c.mDataSize > header.mConstantBytes)
+            {
+                fail_runtime_error("binary spvmap constant record is out of range");
+            }
+
+            constant_spec_t constant;
+            constant.mDescriptorSet = c.mDescriptorSet;
+            constant.mBinding = c.mBinding;
+            constant.mBytes.assign(constantData + c.mDataOffset, constantData + c.mDataOffset + c.mDataSize);
+            result.mConstants.push_back(std::move(constant));
+        }
+
+        standardizeModuleSpec(result);
+        validateModule(result);
+
+        return result;
+    }
+
+} // namespace clspv_utils
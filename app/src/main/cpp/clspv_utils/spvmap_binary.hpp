@@ -0,0 +1,99 @@
+//
+// Created by Eric Berdahl on 5/16/18.
+//
+
+#ifndef CLSPVUTILS_SPVMAP_BINARY_HPP
+#define CLSPVUTILS_SPVMAP_BINARY_HPP
+
+#include "clspv_utils_fwd.hpp"
+
+#include "clspv_utils_interop.hpp"
+#include "interface.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace clspv_utils {
+
+    /*
+     * Binary descriptor map (.spvmap.bin)
+     *
+     * A compact, pre-tokenized form of the clspv descriptor map, produced at build time by
+     * app/src/main/tools/spvmap_to_binary.py. All fields are little-endian 32-bit words, so the
+     * file can be used in place from a memory mapping without any text parsing:
+     *
+     *      binary_spvmap_header
+     *      binary_spvmap_sampler   [mNumSamplers]
+     *      binary_spvmap_constant  [mNumConstants]
+     *      binary_spvmap_kernel    [mNumKernels]
+     *      binary_spvmap_arg       [mNumArgs]
+     *      char                    [mStringBytes]      interned kernel names, not NUL terminated
+     *      std::uint8_t            [mConstantBytes]    constant data, referenced by binary_spvmap_constant
+     *
+     * Records keep the order in which they appear in the CSV spvmap; the loader applies the same
+     * sorting and validation createModuleSpec does.
+     */
+
+    const std::uint32_t kBinarySpvmapMagic      = 0x42505343;   // "CSPB" in little-endian byte order
+    const std::uint32_t kBinarySpvmapVersion    = 1;
+
+    struct binary_spvmap_header {
+        std::uint32_t   mMagic;
+        std::uint32_t   mVersion;
+        std::uint32_t   mNumSamplers;
+        std::uint32_t   mNumConstants;
+        std::uint32_t   mNumKernels;
+        std::uint32_t   mNumArgs;
+        std::uint32_t   mStringBytes;
+        std::uint32_t   mConstantBytes;
+    };
+
+    struct binary_spvmap_sampler {
+        std::int32_t    mOpenclFlags;
+        std::int32_t    mDescriptorSet;
+        std::int32_t    mBinding;
+    };
+
+    struct binary_spvmap_constant {
+        std::int32_t    mDescriptorSet;
+        std::int32_t    mBinding;
+        std::uint32_t   mDataOffset;
+        std::uint32_t   mDataSize;
+    };
+
+    struct binary_spvmap_kernel {
+        std::uint32_t   mNameOffset;
+        std::uint32_t   mNameSize;
+        std::uint32_t   mFirstArg;
+        std::uint32_t   mNumArgs;
+    };
+
+    // mKind uses the encoding in binary_spvmap_arg_kind, not arg_spec_t::kind, so the file format
+    // does not change if the enumeration is reordered.
+    struct binary_spvmap_arg {
+        std::uint32_t   mKind;
+        std::int32_t    mOrdinal;
+        std::int32_t    mDescriptorSet;
+        std::int32_t    mBinding;
+        std::int32_t    mOffset;
+        std::int32_t    mSpecConstant;
+    };
+
+    enum binary_spvmap_arg_kind : std::uint32_t {
+        binary_kind_pod         = 0,
+        binary_kind_pod_ubo     = 1,
+        binary_kind_buffer      = 2,
+        binary_kind_buffer_ubo  = 3,
+        binary_kind_ro_image    = 4,
+        binary_kind_wo_image    = 5,
+        binary_kind_sampler     = 6,
+        binary_kind_local       = 7
+    };
+
+    bool            isBinaryModuleSpec(const void* data, std::size_t numBytes);
+
+    module_spec_t   createModuleSpec(const void* binarySpvmap, std::size_t numBytes);
+
+}
+
+#endif //CLSPVUTILS_SPVMAP_BINARY_HPP
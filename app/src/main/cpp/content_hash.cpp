@@ -0,0 +1,289 @@
+//
+// Created by Eric Berdahl on 5/18/18.
+//
+
+#include "content_hash.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define CLSPVTEST_HASH_SSE2 1
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define CLSPVTEST_HASH_NEON 1
+#endif
+
+namespace {
+    using content_hash::hasher;
+
+    const std::uint32_t kPrime32_1 = 0x9E3779B1u;
+    const std::uint32_t kPrime32_2 = 0x85EBCA77u;
+    const std::uint32_t kPrime32_3 = 0xC2B2AE3Du;
+    const std::uint64_t kPrime64_1 = 0x9E3779B185EBCA87ull;
+    const std::uint64_t kPrime64_2 = 0xC2B2AE3D27D4EB4Full;
+    const std::uint64_t kPrime64_3 = 0x165667B19E3779F9ull;
+    const std::uint64_t kPrime64_4 = 0x85EBCA77C2B2AE63ull;
+    const std::uint64_t kPrime64_5 = 0x27D4EB2F165667C5ull;
+
+    const std::size_t kStripesPerBlock = hasher::kBlockSize / hasher::kStripeSize;
+
+    // Each stripe in a block is keyed by the secret starting 8 bytes after the previous one's key.
+    // The end of the secret keys the scramble at the end of each block.
+    const std::size_t kSecretSize = 192;
+    const std::size_t kSecretStripeStep = 8;
+    const std::size_t kScrambleSecretOffset = kSecretSize - hasher::kStripeSize;
+    const std::size_t kMergeSecretOffset = 11;
+
+    static_assert((kStripesPerBlock - 1) * kSecretStripeStep + hasher::kStripeSize <= kSecretSize, "secret too small for a block");
+
+    struct secret_t {
+        secret_t() {
+            // splitmix64, written out byte by byte so the secret is the same on every platform
+            std::uint64_t state = 0;
+            for (std::size_t i = 0; i < kSecretSize; i += sizeof(std::uint64_t)) {
+                state += 0x9E3779B97F4A7C15ull;
+                std::uint64_t z = state;
+                z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+                z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+                z ^= (z >> 31);
+
+                for (std::size_t b = 0; b < sizeof(std::uint64_t); ++b) {
+                    mBytes[i + b] = static_cast<unsigned char>(z >> (8 * b));
+                }
+            }
+        }
+
+        unsigned char mBytes[kSecretSize];
+    };
+
+    const unsigned char* get_secret() {
+        static const secret_t secret;
+        return secret.mBytes;
+    }
+
+    // every supported ABI is little-endian
+    inline std::uint64_t read64(const unsigned char* p) {
+        std::uint64_t result;
+        std::memcpy(&result, p, sizeof(result));
+        return result;
+    }
+
+    // xor of the high and low halves of the 128-bit product a * b
+    inline std::uint64_t mul_fold64(std::uint64_t a, std::uint64_t b) {
+        const std::uint64_t aLow = a & 0xFFFFFFFFu;
+        const std::uint64_t aHigh = a >> 32;
+        const std::uint64_t bLow = b & 0xFFFFFFFFu;
+        const std::uint64_t bHigh = b >> 32;
+
+        const std::uint64_t lowLow = aLow * bLow;
+        const std::uint64_t highLow = aHigh * bLow;
+        const std::uint64_t lowHigh = aLow * bHigh;
+        const std::uint64_t highHigh = aHigh * bHigh;
+
+        const std::uint64_t cross = (lowLow >> 32) + (highLow & 0xFFFFFFFFu) + lowHigh;
+        const std::uint64_t upper = (highLow >> 32) + (cross >> 32) + highHigh;
+        const std::uint64_t lower = (cross << 32) | (lowLow & 0xFFFFFFFFu);
+
+        return lower ^ upper;
+    }
+
+    inline std::uint64_t avalanche(std::uint64_t h) {
+        h ^= h >> 37;
+        h *= 0x165667919E3779F9ull;
+        h ^= h >> 32;
+        return h;
+    }
+
+    //
+    // accumulate adds numStripes consecutive stripes into the lanes, keying the stripe at
+    // data + 64*i with the secret at secret + 8*i. Each lane adds the product of the low and high
+    // halves of its keyed data, plus its neighbour's unkeyed data so that no input is lost when
+    // either half of the keyed data is zero. scramble mixes the high bits of each lane back into
+    // its low bits.
+    //
+#if CLSPVTEST_HASH_SSE2
+    void accumulate(std::uint64_t* acc, const unsigned char* data, const unsigned char* secret, std::size_t numStripes) {
+        __m128i* accVec = reinterpret_cast<__m128i*>(acc);
+        __m128i lanes[4];
+        for (int i = 0; i < 4; ++i) {
+            lanes[i] = _mm_loadu_si128(accVec + i);
+        }
+
+        for (std::size_t s = 0; s < numStripes; ++s) {
+            const __m128i* dataVec = reinterpret_cast<const __m128i*>(data + s * hasher::kStripeSize);
+            const __m128i* keyVec = reinterpret_cast<const __m128i*>(secret + s * kSecretStripeStep);
+
+            for (int i = 0; i < 4; ++i) {
+                const __m128i d = _mm_loadu_si128(dataVec + i);
+                const __m128i keyed = _mm_xor_si128(d, _mm_loadu_si128(keyVec + i));
+                const __m128i product = _mm_mul_epu32(keyed, _mm_shuffle_epi32(keyed, _MM_SHUFFLE(0, 3, 0, 1)));
+                const __m128i swapped = _mm_shuffle_epi32(d, _MM_SHUFFLE(1, 0, 3, 2));
+                lanes[i] = _mm_add_epi64(lanes[i], _mm_add_epi64(product, swapped));
+            }
+        }
+
+        for (int i = 0; i < 4; ++i) {
+            _mm_storeu_si128(accVec + i, lanes[i]);
+        }
+    }
+
+    void scramble(std::uint64_t* acc, const unsigned char* secret) {
+        __m128i* accVec = reinterpret_cast<__m128i*>(acc);
+        const __m128i* keyVec = reinterpret_cast<const __m128i*>(secret);
+        const __m128i prime = _mm_set1_epi32(static_cast<int>(kPrime32_1));
+
+        for (int i = 0; i < 4; ++i) {
+            __m128i a = _mm_loadu_si128(accVec + i);
+            a = _mm_xor_si128(a, _mm_srli_epi64(a, 47));
+            a = _mm_xor_si128(a, _mm_loadu_si128(keyVec + i));
+
+            // 64x32 bit multiply, from the products of each half
+            const __m128i productLow = _mm_mul_epu32(a, prime);
+            const __m128i productHigh = _mm_mul_epu32(_mm_srli_epi64(a, 32), prime);
+            _mm_storeu_si128(accVec + i, _mm_add_epi64(productLow, _mm_slli_epi64(productHigh, 32)));
+        }
+    }
+#elif CLSPVTEST_HASH_NEON
+    void accumulate(std::uint64_t* acc, const unsigned char* data, const unsigned char* secret, std::size_t numStripes) {
+        uint64x2_t lanes[4];
+        for (int i = 0; i < 4; ++i) {
+            lanes[i] = vld1q_u64(acc + 2 * i);
+        }
+
+        for (std::size_t s = 0; s < numStripes; ++s) {
+            const unsigned char* stripe = data + s * hasher::kStripeSize;
+            const unsigned char* key = secret + s * kSecretStripeStep;
+
+            for (int i = 0; i < 4; ++i) {
+                const uint64x2_t d = vreinterpretq_u64_u8(vld1q_u8(stripe + 16 * i));
+                const uint64x2_t keyed = veorq_u64(d, vreinterpretq_u64_u8(vld1q_u8(key + 16 * i)));
+                const uint64x2_t product = vmull_u32(vmovn_u64(keyed), vshrn_n_u64(keyed, 32));
+                const uint64x2_t swapped = vextq_u64(d, d, 1);
+                lanes[i] = vaddq_u64(lanes[i], vaddq_u64(product, swapped));
+            }
+        }
+
+        for (int i = 0; i < 4; ++i) {
+            vst1q_u64(acc + 2 * i, lanes[i]);
+        }
+    }
+
+    void scramble(std::uint64_t* acc, const unsigned char* secret) {
+        for (int i = 0; i < 4; ++i) {
+            uint64x2_t a = vld1q_u64(acc + 2 * i);
+            a = veorq_u64(a, vshrq_n_u64(a, 47));
+            a = veorq_u64(a, vreinterpretq_u64_u8(vld1q_u8(secret + 16 * i)));
+
+            // 64x32 bit multiply, from the products of each half
+            const uint64x2_t productHigh = vshlq_n_u64(vmull_n_u32(vshrn_n_u64(a, 32), kPrime32_1), 32);
+            vst1q_u64(acc + 2 * i, vmlal_n_u32(productHigh, vmovn_u64(a), kPrime32_1));
+        }
+    }
+#else
+    void accumulate(std::uint64_t* acc, const unsigned char* data, const unsigned char* secret, std::size_t numStripes) {
+        for (std::size_t s = 0; s < numStripes; ++s) {
+            const unsigned char* stripe = data + s * hasher::kStripeSize;
+            const unsigned char* key = secret + s * kSecretStripeStep;
+
+            for (std::size_t i = 0; i < hasher::kNumLanes; ++i) {
+                const std::uint64_t d = read64(stripe + 8 * i);
+                const std::uint64_t keyed = d ^ read64(key + 8 * i);
+                acc[i ^ 1] += d;
+                acc[i] += (keyed & 0xFFFFFFFFu) * (keyed >> 32);
+            }
+        }
+    }
+
+    void scramble(std::uint64_t* acc, const unsigned char* secret) {
+        for (std::size_t i = 0; i < hasher::kNumLanes; ++i) {
+            std::uint64_t a = acc[i];
+            a ^= a >> 47;
+            a ^= read64(secret + 8 * i);
+            acc[i] = a * kPrime32_1;
+        }
+    }
+#endif
+
+    void consume_block(std::uint64_t* acc, const unsigned char* block, const unsigned char* secret) {
+        accumulate(acc, block, secret, kStripesPerBlock);
+        scramble(acc, secret + kScrambleSecretOffset);
+    }
+
+} // anonymous namespace
+
+namespace content_hash {
+
+    const std::size_t hasher::kNumLanes;
+    const std::size_t hasher::kStripeSize;
+    const std::size_t hasher::kBlockSize;
+
+    hasher::hasher()
+            : mBufferSize(0),
+              mTotalSize(0) {
+        const std::uint64_t initial[kNumLanes] = {
+                kPrime32_3, kPrime64_1, kPrime64_2, kPrime64_3, kPrime64_4, kPrime32_2, kPrime64_5, kPrime32_1
+        };
+        std::copy(initial, initial + kNumLanes, mAccumulators);
+    }
+
+    void hasher::update(const void* data, std::size_t numBytes) {
+        if (0 == numBytes) return;
+
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        const unsigned char* secret = get_secret();
+
+        mTotalSize += numBytes;
+
+        if (mBufferSize > 0) {
+            const std::size_t numCopied = std::min(numBytes, kBlockSize - mBufferSize);
+            std::memcpy(mBuffer + mBufferSize, bytes, numCopied);
+            mBufferSize += numCopied;
+            bytes += numCopied;
+            numBytes -= numCopied;
+
+            if (kBlockSize == mBufferSize) {
+                consume_block(mAccumulators, mBuffer, secret);
+                mBufferSize = 0;
+            }
+        }
+
+        for (; numBytes >= kBlockSize; bytes += kBlockSize, numBytes -= kBlockSize) {
+            consume_block(mAccumulators, bytes, secret);
+        }
+
+        if (numBytes > 0) {
+            std::memcpy(mBuffer, bytes, numBytes);
+            mBufferSize = numBytes;
+        }
+    }
+
+    std::uint64_t hasher::digest() const {
+        const unsigned char* secret = get_secret();
+
+        std::uint64_t acc[kNumLanes];
+        std::copy(mAccumulators, mAccumulators + kNumLanes, acc);
+
+        // the partial block left in the buffer, with its last stripe padded with zeros
+        const std::size_t numStripes = mBufferSize / kStripeSize;
+        accumulate(acc, mBuffer, secret, numStripes);
+
+        const std::size_t tailSize = mBufferSize % kStripeSize;
+        if (tailSize > 0) {
+            unsigned char lastStripe[kStripeSize] = {};
+            std::memcpy(lastStripe, mBuffer + numStripes * kStripeSize, tailSize);
+            accumulate(acc, lastStripe, secret + numStripes * kSecretStripeStep, 1);
+        }
+
+        // the total size distinguishes inputs which differ only in trailing zeros
+        std::uint64_t result = mTotalSize * kPrime64_1;
+        for (std::size_t i = 0; i < kNumLanes; i += 2) {
+            result += mul_fold64(acc[i] ^ read64(secret + kMergeSecretOffset + 8 * i),
+                                 acc[i + 1] ^ read64(secret + kMergeSecretOffset + 8 * i + 8));
+        }
+
+        return avalanche(result);
+    }
+
+}
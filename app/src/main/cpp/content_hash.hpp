@@ -0,0 +1,41 @@
+//
+// Created by Eric Berdahl on 5/18/18.
+//
+
+#ifndef CLSPVTEST_CONTENT_HASH_HPP
+#define CLSPVTEST_CONTENT_HASH_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace content_hash {
+
+    //
+    // Streaming 64-bit hash of a sequence of bytes, built like XXH3: eight 64-bit lanes accumulate
+    // 64-byte stripes with 32x32->64 bit multiplies, which map directly onto SSE2 and NEON, so
+    // hashing is bound by memory bandwidth. The result depends only on the bytes hashed, not on how
+    // they were split between calls to update, and is the same on every platform. It is not
+    // compatible with the reference xxHash implementation.
+    //
+    class hasher {
+    public:
+        static const std::size_t kNumLanes      = 8;
+        static const std::size_t kStripeSize    = 64;
+        static const std::size_t kBlockSize     = 16 * kStripeSize;
+
+                        hasher();
+
+        void            update(const void* data, std::size_t numBytes);
+
+        std::uint64_t   digest() const;
+
+    private:
+        std::uint64_t   mAccumulators[kNumLanes];
+        unsigned char   mBuffer[kBlockSize];
+        std::size_t     mBufferSize;
+        std::uint64_t   mTotalSize;
+    };
+
+}
+
+#endif //CLSPVTEST_CONTENT_HASH_HPP
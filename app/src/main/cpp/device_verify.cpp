@@ -0,0 +1,206 @@
+//
+// Created by Eric Berdahl on 5/18/18.
+//
+
+#include "device_verify.hpp"
+
+#include "clspv_utils/invocation.hpp"
+#include "clspv_utils/module_cache.hpp"
+#include "file_utils.hpp"
+#include "gpu_types.hpp"
+#include "test_utils.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+
+namespace {
+
+    const std::uint32_t kWorkgroupWidth = 64;
+
+    // keeps each dimension of the dispatch well under the guaranteed minimum of 65535 workgroups
+    const std::uint32_t kMaxWorkgroupsPerRow = 4096;
+
+    // Relative tolerances on the device are tightened by this factor so that rounding differences
+    // between the device and the host can only produce false mismatches, never false matches.
+    const float kToleranceMargin = 1.0f - 1.0f / 256.0f;
+
+    struct dispatch_t {
+        vk::Extent3D    mNumWorkgroups;
+        std::int32_t    mRowLength;
+    };
+
+    dispatch_t compute_dispatch(std::uint32_t numPixels) {
+        const std::uint32_t numWorkgroups = std::max<std::uint32_t>(1, (numPixels + kWorkgroupWidth - 1) / kWorkgroupWidth);
+        const std::uint32_t numWorkgroupsPerRow = std::min(numWorkgroups, kMaxWorkgroupsPerRow);
+
+        dispatch_t result;
+        result.mNumWorkgroups = vk::Extent3D(numWorkgroupsPerRow,
+                                             (numWorkgroups + numWorkgroupsPerRow - 1) / numWorkgroupsPerRow,
+                                             1);
+        result.mRowLength = static_cast<std::int32_t>(numWorkgroupsPerRow * kWorkgroupWidth);
+        return result;
+    }
+
+    clspv_utils::module load_verify_module(clspv_utils::device dev, clspv_utils::module_cache& moduleCache) {
+        std::vector<std::uint32_t> spvWords;
+        file_utils::read_file_contents(std::string(device_verify::kVerifyModuleName) + ".spv", spvWords);
+
+        return clspv_utils::module(dev,
+                                   test_utils::load_module_spec(device_verify::kVerifyModuleName, moduleCache),
+                                   moduleCache.getShaderObjects(dev.getDevice(), spvWords));
+    }
+
+} // anonymous namespace
+
+namespace device_verify {
+
+    const char* const kVerifyModuleName = "shaders_cl/Verify";
+
+    verifier::verifier(clspv_utils::device dev, clspv_utils::module_cache& moduleCache)
+            : mDevice(dev),
+              mModule(load_verify_module(dev, moduleCache)) {
+        const vk::Extent3D workgroupSize(kWorkgroupWidth, 1, 1);
+
+        mFloatKernel = clspv_utils::kernel(mModule.createKernelReq("VerifyFloatPixels"), workgroupSize);
+        mUCharKernel = clspv_utils::kernel(mModule.createKernelReq("VerifyUCharPixels"), workgroupSize);
+        mIntKernel = clspv_utils::kernel(mModule.createKernelReq("VerifyIntPixels"), workgroupSize);
+
+        mSummary = vulkan_utils::storage_buffer(mDevice.getDevice(),
+                                                mDevice.getMemoryProperties(),
+                                                sizeof(std::uint32_t) * (1 + kMaxRecordedMismatches));
+    }
+
+    summary_t verifier::compare_floats(vulkan_utils::storage_buffer&   expected,
+                                       vulkan_utils::storage_buffer&   observed,
+                                       std::uint32_t                   numPixels,
+                                       int                             componentsPerPixel,
+                                       bool                            is16Bit,
+                                       int                             ulp) {
+        struct scalar_args {
+            std::int32_t    inNumPixels;            // offset 0
+            std::int32_t    inComponentsPerPixel;   // offset 4
+            std::int32_t    inRowLength;            // offset 8
+            std::int32_t    inIs16Bit;              // offset 12
+            float           inTolerance;            // offset 16
+            float           inMinNormal;            // offset 20
+        };
+        static_assert(0 == offsetof(scalar_args, inNumPixels), "inNumPixels offset incorrect");
+        static_assert(4 == offsetof(scalar_args, inComponentsPerPixel), "inComponentsPerPixel offset incorrect");
+        static_assert(8 == offsetof(scalar_args, inRowLength), "inRowLength offset incorrect");
+        static_assert(12 == offsetof(scalar_args, inIs16Bit), "inIs16Bit offset incorrect");
+        static_assert(16 == offsetof(scalar_args, inTolerance), "inTolerance offset incorrect");
+        static_assert(20 == offsetof(scalar_args, inMinNormal), "inMinNormal offset incorrect");
+
+        const float epsilon = (is16Bit ? static_cast<float>(std::numeric_limits<gpu_types::half>::epsilon())
+                                       : std::numeric_limits<float>::epsilon());
+        const float minNormal = (is16Bit ? static_cast<float>(std::numeric_limits<gpu_types::half>::min())
+                                         : std::numeric_limits<float>::min());
+
+        const dispatch_t dispatch = compute_dispatch(numPixels);
+
+        vulkan_utils::uniform_buffer scalarBuffer(mDevice.getDevice(),
+                                                  mDevice.getMemoryProperties(),
+                                                  sizeof(scalar_args));
+        auto scalars = scalarBuffer.map<scalar_args>();
+        scalars->inNumPixels = static_cast<std::int32_t>(numPixels);
+        scalars->inComponentsPerPixel = componentsPerPixel;
+        scalars->inRowLength = dispatch.mRowLength;
+        scalars->inIs16Bit = is16Bit;
+        scalars->inTolerance = epsilon * ulp * kToleranceMargin;
+        scalars->inMinNormal = minNormal * kToleranceMargin;
+        scalars.reset();
+
+        return run(mFloatKernel, expected, observed, scalarBuffer, dispatch.mNumWorkgroups);
+    }
+
+    summary_t verifier::compare_uchars(vulkan_utils::storage_buffer&   expected,
+                                       vulkan_utils::storage_buffer&   observed,
+                                       std::uint32_t                   numPixels,
+                                       int                             componentsPerPixel,
+                                       int                             tolerance) {
+        struct scalar_args {
+            std::int32_t    inNumPixels;            // offset 0
+            std::int32_t    inComponentsPerPixel;   // offset 4
+            std::int32_t    inRowLength;            // offset 8
+            std::int32_t    inTolerance;            // offset 12
+        };
+        static_assert(0 == offsetof(scalar_args, inNumPixels), "inNumPixels offset incorrect");
+        static_assert(4 == offsetof(scalar_args, inComponentsPerPixel), "inComponentsPerPixel offset incorrect");
+        static_assert(8 == offsetof(scalar_args, inRowLength), "inRowLength offset incorrect");
+        static_assert(12 == offsetof(scalar_args, inTolerance), "inTolerance offset incorrect");
+
+        const dispatch_t dispatch = compute_dispatch(numPixels);
+
+        vulkan_utils::uniform_buffer scalarBuffer(mDevice.getDevice(),
+                                                  mDevice.getMemoryProperties(),
+                                                  sizeof(scalar_args));
+        auto scalars = scalarBuffer.map<scalar_args>();
+        scalars->inNumPixels = static_cast<std::int32_t>(numPixels);
+        scalars->inComponentsPerPixel = componentsPerPixel;
+        scalars->inRowLength = dispatch.mRowLength;
+        scalars->inTolerance = tolerance;
+        scalars.reset();
+
+        return run(mUCharKernel, expected, observed, scalarBuffer, dispatch.mNumWorkgroups);
+    }
+
+    summary_t verifier::compare_ints(vulkan_utils::storage_buffer& expected,
+                                     vulkan_utils::storage_buffer& observed,
+                                     std::uint32_t                 numPixels,
+                                     int                           componentsPerPixel) {
+        struct scalar_args {
+            std::int32_t    inNumPixels;            // offset 0
+            std::int32_t    inComponentsPerPixel;   // offset 4
+            std::int32_t    inRowLength;            // offset 8
+        };
+        static_assert(0 == offsetof(scalar_args, inNumPixels), "inNumPixels offset incorrect");
+        static_assert(4 == offsetof(scalar_args, inComponentsPerPixel), "inComponentsPerPixel offset incorrect");
+        static_assert(8 == offsetof(scalar_args, inRowLength), "inRowLength offset incorrect");
+
+        const dispatch_t dispatch = compute_dispatch(numPixels);
+
+        vulkan_utils::uniform_buffer scalarBuffer(mDevice.getDevice(),
+                                                  mDevice.getMemoryProperties(),
+                                                  sizeof(scalar_args));
+        auto scalars = scalarBuffer.map<scalar_args>();
+        scalars->inNumPixels = static_cast<std::int32_t>(numPixels);
+        scalars->inComponentsPerPixel = componentsPerPixel;
+        scalars->inRowLength = dispatch.mRowLength;
+        scalars.reset();
+
+        return run(mIntKernel, expected, observed, scalarBuffer, dispatch.mNumWorkgroups);
+    }
+
+    summary_t verifier::run(clspv_utils::kernel&            kernel,
+                            vulkan_utils::storage_buffer&   expected,
+                            vulkan_utils::storage_buffer&   observed,
+                            vulkan_utils::uniform_buffer&   scalars,
+                            const vk::Extent3D&             numWorkgroups) {
+        {
+            auto summaryMap = mSummary.map<std::uint32_t>();
+            std::fill(summaryMap.get(), summaryMap.get() + 1 + kMaxRecordedMismatches, 0);
+        }
+
+        clspv_utils::invocation invocation(kernel.createInvocationReq());
+
+        invocation.addStorageBufferArgument(expected);
+        invocation.addStorageBufferArgument(observed);
+        invocation.addStorageBufferArgument(mSummary);
+        invocation.addUniformBufferArgument(scalars);
+
+        invocation.run(numWorkgroups);
+
+        summary_t result;
+
+        auto summaryMap = mSummary.map<std::uint32_t>();
+        result.mNumMismatches = summaryMap.get()[0];
+
+        const std::uint32_t numRecorded = std::min(result.mNumMismatches, kMaxRecordedMismatches);
+        result.mMismatches.assign(summaryMap.get() + 1, summaryMap.get() + 1 + numRecorded);
+        std::sort(result.mMismatches.begin(), result.mMismatches.end());
+
+        return result;
+    }
+
+}
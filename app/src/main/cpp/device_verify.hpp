@@ -0,0 +1,77 @@
+//
+// Created by Eric Berdahl on 5/18/18.
+//
+
+#ifndef CLSPVTEST_DEVICE_VERIFY_HPP
+#define CLSPVTEST_DEVICE_VERIFY_HPP
+
+#include "clspv_utils/clspv_utils_fwd.hpp"
+#include "clspv_utils/device.hpp"
+#include "clspv_utils/kernel.hpp"
+#include "clspv_utils/module.hpp"
+#include "vulkan_utils/vulkan_utils.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace device_verify {
+
+    // the module holding the comparison kernels (kernels/Verify.cl)
+    extern const char* const kVerifyModuleName;
+
+    // must match VERIFY_MAX_RECORDED in Verify.cl
+    const std::uint32_t kMaxRecordedMismatches = 16;
+
+    struct summary_t {
+        std::uint32_t               mNumMismatches  = 0;
+        std::vector<std::uint32_t>  mMismatches;        // indices of up to kMaxRecordedMismatches incorrect pixels, ascending
+    };
+
+    //
+    // Compares buffers of pixels on the device, reading back only a summary of the comparison.
+    // The comparisons are conservative: pixels the host comparison (test_utils::pixel_compare)
+    // would reject are always reported, but a few pixels the host would accept, at the very edge
+    // of the float tolerance, may be reported as well. Callers should confirm reported mismatches
+    // on the host.
+    //
+    class verifier {
+    public:
+                    verifier(clspv_utils::device dev, clspv_utils::module_cache& moduleCache);
+
+        summary_t   compare_floats(vulkan_utils::storage_buffer&   expected,
+                                   vulkan_utils::storage_buffer&   observed,
+                                   std::uint32_t                   numPixels,
+                                   int                             componentsPerPixel,
+                                   bool                            is16Bit,
+                                   int                             ulp);
+
+        summary_t   compare_uchars(vulkan_utils::storage_buffer&   expected,
+                                   vulkan_utils::storage_buffer&   observed,
+                                   std::uint32_t                   numPixels,
+                                   int                             componentsPerPixel,
+                                   int                             tolerance);
+
+        summary_t   compare_ints(vulkan_utils::storage_buffer&     expected,
+                                 vulkan_utils::storage_buffer&     observed,
+                                 std::uint32_t                     numPixels,
+                                 int                               componentsPerPixel);
+
+    private:
+        summary_t   run(clspv_utils::kernel&            kernel,
+                        vulkan_utils::storage_buffer&   expected,
+                        vulkan_utils::storage_buffer&   observed,
+                        vulkan_utils::uniform_buffer&   scalars,
+                        const vk::Extent3D&             numWorkgroups);
+
+    private:
+        clspv_utils::device             mDevice;
+        clspv_utils::module             mModule;
+        clspv_utils::kernel             mFloatKernel;
+        clspv_utils::kernel             mUCharKernel;
+        clspv_utils::kernel             mIntKernel;
+        vulkan_utils::storage_buffer    mSummary;
+    };
+
+}
+
+#endif //CLSPVTEST_DEVICE_VERIFY_HPP
@@ -0,0 +1,245 @@
+//
+// Created by Eric Berdahl on 5/18/18.
+//
+
+#include "expected_cache.hpp"
+
+#include "content_hash.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+namespace {
+
+    const char          kMagic[8] = { 'C', 'L', 'S', 'P', 'V', 'E', 'X', 'P' };
+    const std::uint32_t kVersion = 1;
+
+    // keeps the elements aligned for any pixel type, since mappings start on a page boundary
+    const std::uint64_t kDataAlignment = 64;
+
+    // each store trims the cache to this size, evicting the least recently used files first
+    const std::uint64_t kMaxCacheBytes = 256 << 20;
+
+    const char          kExtension[] = ".expected";
+
+    struct header_t {
+        char            mMagic[8];
+        std::uint32_t   mVersion;
+        std::uint32_t   mKeySize;
+        std::uint64_t   mElementSize;
+        std::uint64_t   mCount;
+        std::uint64_t   mDataOffset;
+    };
+
+    std::mutex  gDirectoryMutex;
+    std::string gDirectory;
+
+    std::uint64_t data_offset(std::size_t keySize) {
+        return (sizeof(header_t) + keySize + kDataAlignment - 1) / kDataAlignment * kDataAlignment;
+    }
+
+    // files are named for a hash of the key; the key itself is kept in the file to catch collisions
+    std::string cache_path(const std::string& directory, const std::string& key) {
+        content_hash::hasher hasher;
+        hasher.update(key.data(), key.size());
+
+        std::ostringstream os;
+        os << directory << '/' << std::hex << std::setw(16) << std::setfill('0') << hasher.digest() << kExtension;
+        return os.str();
+    }
+
+    struct cache_file_t {
+        std::string     mPath;
+        std::uint64_t   mSize;
+        time_t          mLastUsed;  // the modification time, which find updates on every hit
+    };
+
+    void evict(const std::string& directory, const std::string& keepPath) {
+        DIR* dir = opendir(directory.c_str());
+        if (!dir) return;
+
+        const std::size_t extensionLength = sizeof(kExtension) - 1;
+
+        std::vector<cache_file_t> files;
+        std::uint64_t totalSize = 0;
+        while (const dirent* entry = readdir(dir)) {
+            const std::string name(entry->d_name);
+            if (name.size() <= extensionLength || 0 != name.compare(name.size() - extensionLength, extensionLength, kExtension)) continue;
+
+            cache_file_t file;
+            file.mPath = directory + '/' + name;
+
+            struct stat info;
+            if (0 != stat(file.mPath.c_str(), &info)) continue;
+            file.mSize = static_cast<std::uint64_t>(info.st_size);
+            file.mLastUsed = info.st_mtime;
+
+            files.push_back(file);
+            totalSize += file.mSize;
+        }
+        closedir(dir);
+
+        if (totalSize <= kMaxCacheBytes) return;
+
+        std::sort(files.begin(), files.end(), [](const cache_file_t& lhs, const cache_file_t& rhs) {
+            return lhs.mLastUsed < rhs.mLastUsed;
+        });
+
+        for (const auto& file : files) {
+            if (totalSize <= kMaxCacheBytes) break;
+            if (file.mPath == keepPath) continue;
+
+            if (0 == std::remove(file.mPath.c_str())) {
+                totalSize -= file.mSize;
+            }
+        }
+    }
+
+} // anonymous namespace
+
+namespace expected_cache {
+
+    void set_directory(const std::string& directory) {
+        if (!directory.empty() && 0 != mkdir(directory.c_str(), 0700) && EEXIST != errno) {
+            throw std::runtime_error("cannot create expected results cache " + directory + ": " + std::strerror(errno));
+        }
+
+        std::lock_guard<std::mutex> lock(gDirectoryMutex);
+        gDirectory = directory;
+    }
+
+    std::string get_directory() {
+        std::lock_guard<std::mutex> lock(gDirectoryMutex);
+        return gDirectory;
+    }
+
+    mapping::mapping() : mData(nullptr), mSize(0) {
+    }
+
+    mapping::mapping(const std::string& path) : mapping() {
+        const int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) return;
+
+        struct stat info;
+        if (0 == fstat(fd, &info) && info.st_size > 0) {
+            void* data = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (MAP_FAILED != data) {
+                mData = data;
+                mSize = static_cast<std::size_t>(info.st_size);
+            }
+        }
+
+        // the mapping keeps the file contents alive
+        ::close(fd);
+    }
+
+    mapping::mapping(mapping&& other) : mapping() {
+        swap(other);
+    }
+
+    mapping::~mapping() {
+        close();
+    }
+
+    mapping& mapping::operator=(mapping&& other) {
+        swap(other);
+        return *this;
+    }
+
+    void mapping::close() {
+        if (mData) {
+            munmap(mData, mSize);
+            mData = nullptr;
+            mSize = 0;
+        }
+    }
+
+    void mapping::swap(mapping& other) {
+        std::swap(mData, other.mData);
+        std::swap(mSize, other.mSize);
+    }
+
+    bool find(const std::string& key, std::size_t elementSize, std::size_t count, mapping& result, std::size_t& dataOffset) {
+        const std::string directory = get_directory();
+        if (directory.empty()) return false;
+
+        const std::string path = cache_path(directory, key);
+        mapping cached(path);
+        if (!cached.is_open() || cached.size() < sizeof(header_t)) return false;
+
+        header_t header;
+        std::memcpy(&header, cached.data(), sizeof(header));
+
+        const char* keyBytes = static_cast<const char*>(cached.data()) + sizeof(header);
+        const bool isMatch = (0 == std::memcmp(header.mMagic, kMagic, sizeof(kMagic))
+                              && kVersion == header.mVersion
+                              && key.size() == header.mKeySize
+                              && elementSize == header.mElementSize
+                              && count == header.mCount
+                              && data_offset(key.size()) == header.mDataOffset
+                              && header.mDataOffset + static_cast<std::uint64_t>(count) * elementSize == cached.size()
+                              && 0 == key.compare(0, key.size(), keyBytes, header.mKeySize));
+        if (!isMatch) return false;
+
+        // marks the file as recently used, for eviction
+        utimes(path.c_str(), nullptr);
+
+        result = std::move(cached);
+        dataOffset = static_cast<std::size_t>(header.mDataOffset);
+        return true;
+    }
+
+    void store(const std::string& key, std::size_t elementSize, std::size_t count, const void* data) {
+        const std::string directory = get_directory();
+        if (directory.empty()) return;
+
+        header_t header;
+        std::memcpy(header.mMagic, kMagic, sizeof(kMagic));
+        header.mVersion = kVersion;
+        header.mKeySize = static_cast<std::uint32_t>(key.size());
+        header.mElementSize = elementSize;
+        header.mCount = count;
+        header.mDataOffset = data_offset(key.size());
+
+        const std::vector<char> padding(static_cast<std::size_t>(header.mDataOffset - sizeof(header) - key.size()), 0);
+
+        // written to a temporary file and renamed, so a reader never maps a partial file
+        const std::string path = cache_path(directory, key);
+        const std::string tempPath = path + ".tmp";
+        {
+            std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+            out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            out.write(key.data(), key.size());
+            out.write(padding.data(), padding.size());
+            out.write(static_cast<const char*>(data), static_cast<std::streamsize>(elementSize * count));
+            out.close();
+            if (!out) {
+                std::remove(tempPath.c_str());
+                return;
+            }
+        }
+
+        if (0 != std::rename(tempPath.c_str(), path.c_str())) {
+            std::remove(tempPath.c_str());
+            return;
+        }
+
+        evict(directory, path);
+    }
+
+}
@@ -0,0 +1,141 @@
+//
+// Created by Eric Berdahl on 5/18/18.
+//
+
+#ifndef CLSPVTEST_EXPECTED_CACHE_HPP
+#define CLSPVTEST_EXPECTED_CACHE_HPP
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace expected_cache {
+
+    //
+    // Expected results which are expensive to compute on the CPU are saved as raw files in the
+    // cache directory, and memory mapped when a later run asks for the same key. An empty
+    // directory (the default) disables the cache. The cache holds at most 256 MiB; storing more
+    // evicts the files least recently stored or found.
+    //
+    void set_directory(const std::string& directory);
+
+    std::string get_directory();
+
+    // read-only mapping of an entire file
+    class mapping {
+    public:
+                    mapping();
+
+        explicit    mapping(const std::string& path);
+
+                    mapping(const mapping&) = delete;
+
+                    mapping(mapping&& other);
+
+                    ~mapping();
+
+        mapping&    operator=(const mapping&) = delete;
+
+        mapping&    operator=(mapping&& other);
+
+        bool        is_open() const { return nullptr != mData; }
+
+        const void* data() const { return mData; }
+
+        std::size_t size() const { return mSize; }
+
+        void        close();
+
+        void        swap(mapping& other);
+
+    private:
+        void*       mData;
+        std::size_t mSize;
+    };
+
+    // Expected pixels, either computed in this run or mapped from the cache
+    template<typename T>
+    class pixels {
+    public:
+                    pixels() : mData(nullptr), mSize(0) {}
+
+        explicit    pixels(std::vector<T> computed)
+                            : mComputed(std::move(computed)),
+                              mData(mComputed.data()),
+                              mSize(mComputed.size()) {}
+
+                    pixels(mapping cached, std::size_t offset, std::size_t count)
+                            : mCached(std::move(cached)),
+                              mData(reinterpret_cast<const T*>(static_cast<const char*>(mCached.data()) + offset)),
+                              mSize(count) {}
+
+                    pixels(const pixels&) = delete;
+
+                    pixels(pixels&& other) : pixels() { swap(other); }
+
+        pixels&     operator=(const pixels&) = delete;
+
+        pixels&     operator=(pixels&& other) { swap(other); return *this; }
+
+        const T*    data() const { return mData; }
+
+        std::size_t size() const { return mSize; }
+
+        const T&    operator[](std::size_t i) const { return mData[i]; }
+
+        void        swap(pixels& other) {
+            mComputed.swap(other.mComputed);
+            mCached.swap(other.mCached);
+            std::swap(mData, other.mData);
+            std::swap(mSize, other.mSize);
+        }
+
+    private:
+        std::vector<T>  mComputed;
+        mapping         mCached;
+        const T*        mData;
+        std::size_t     mSize;
+    };
+
+    // Maps the cached data for the key, if the cache holds count elements of elementSize bytes for
+    // it, and sets dataOffset to the offset of the elements within the mapping
+    bool find(const std::string& key, std::size_t elementSize, std::size_t count, mapping& result, std::size_t& dataOffset);
+
+    // Saves the data for the key, replacing any data already cached for it. Failures are ignored;
+    // the data is simply computed again next time.
+    void store(const std::string& key, std::size_t elementSize, std::size_t count, const void* data);
+
+    //
+    // Returns the count elements cached for the key, or calls compute() to produce them (as a
+    // std::vector<T>) and caches the result. referenceVersion is part of the key; callers bump it
+    // whenever compute() changes, so that data cached by an older build is never served for it.
+    //
+    template<typename T, typename ComputeFn>
+    pixels<T> get_or_compute(const std::string& unversionedKey, unsigned int referenceVersion, std::size_t count, ComputeFn compute) {
+        // elements are saved and mapped as raw bytes (gpu_types vectors declare their own copy
+        // constructors, so cannot require is_trivially_copyable)
+        static_assert(std::is_standard_layout<T>::value, "cached elements must have standard layout");
+
+        const std::string key = unversionedKey + " reference:" + std::to_string(referenceVersion);
+
+        mapping cached;
+        std::size_t offset = 0;
+        if (find(key, sizeof(T), count, cached, offset)) {
+            return pixels<T>(std::move(cached), offset, count);
+        }
+
+        std::vector<T> computed = compute();
+        if (computed.size() != count) {
+            throw std::runtime_error("computed expected results have the wrong size");
+        }
+
+        store(key, sizeof(T), count, computed.data());
+        return pixels<T>(std::move(computed));
+    }
+
+}
+
+#endif //CLSPVTEST_EXPECTED_CACHE_HPP
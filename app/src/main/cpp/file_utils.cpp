@@ -4,7 +4,9 @@
 
 #include "file_utils.hpp"
 
-#include "util.hpp" // AndroidFopen
+#include "util.hpp" // AndroidFopen, AndroidOpenAsset
+
+#include <android/asset_manager.h>
 
 #include <algorithm>
 #include <cstdio>
@@ -191,4 +193,60 @@ namespace file_utils {
         mStreamBuf.swap(other.mStreamBuf);
     }
 
+    AndroidAssetMapping::AndroidAssetMapping()
+            : mAsset(nullptr),
+              mData(nullptr),
+              mSize(0)
+    {
+    }
+
+    AndroidAssetMapping::AndroidAssetMapping(const std::string& filename)
+            : AndroidAssetMapping()
+    {
+        mAsset = AndroidOpenAsset(filename.c_str(), AASSET_MODE_BUFFER);
+        if (mAsset)
+        {
+            mData = AAsset_getBuffer(mAsset);
+            mSize = (mData ? AAsset_getLength(mAsset) : 0);
+        }
+    }
+
+    AndroidAssetMapping::AndroidAssetMapping(AndroidAssetMapping&& other)
+            : AndroidAssetMapping()
+    {
+        swap(other);
+    }
+
+    AndroidAssetMapping::~AndroidAssetMapping()
+    {
+        close();
+    }
+
+    AndroidAssetMapping& AndroidAssetMapping::operator=(AndroidAssetMapping&& other)
+    {
+        swap(other);
+        return *this;
+    }
+
+    void AndroidAssetMapping::close()
+    {
+        if (mAsset)
+        {
+            AAsset_close(mAsset);
+        }
+
+        mAsset = nullptr;
+        mData = nullptr;
+        mSize = 0;
+    }
+
+    void AndroidAssetMapping::swap(AndroidAssetMapping& other)
+    {
+        using std::swap;
+
+        swap(mAsset, other.mAsset);
+        swap(mData, other.mData);
+        swap(mSize, other.mSize);
+    }
+
 }   // namespace file_utils
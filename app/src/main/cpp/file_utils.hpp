@@ -13,6 +13,8 @@
 #include <streambuf>
 #include <vector>
 
+struct AAsset;
+
 namespace file_utils {
 
     typedef std::unique_ptr<std::FILE, decltype(&std::fclose)> UniqueFILE;
@@ -88,6 +90,43 @@ namespace file_utils {
         FILE_buffer mStreamBuf;
     };
 
+    //
+    // AndroidAssetMapping provides read-only access to the entire contents of an asset in place.
+    // Assets stored uncompressed in the APK (see noCompress in build.gradle) are memory mapped
+    // directly; others are decompressed into a buffer owned by the asset manager.
+    //
+    class AndroidAssetMapping {
+    public:
+                                AndroidAssetMapping();
+
+        explicit                AndroidAssetMapping(const std::string& filename);
+
+                                AndroidAssetMapping(const AndroidAssetMapping&) = delete;
+
+                                AndroidAssetMapping(AndroidAssetMapping&& other);
+
+                                ~AndroidAssetMapping();
+
+        AndroidAssetMapping&    operator=(const AndroidAssetMapping&) = delete;
+
+        AndroidAssetMapping&    operator=(AndroidAssetMapping&& other);
+
+        bool                    is_open() const { return nullptr != mData; }
+
+        const void*             data() const { return mData; }
+
+        std::size_t             size() const { return mSize; }
+
+        void                    close();
+
+        void                    swap(AndroidAssetMapping& other);
+
+    private:
+        AAsset*         mAsset;
+        const void*     mData;
+        std::size_t     mSize;
+    };
+
     template<typename Container>
     void read_file_contents(const std::string &filename, Container &fileContents) {
         const std::size_t wordSize = sizeof(typename Container::value_type);
@@ -74,27 +74,19 @@ namespace copybuffertobuffer_kernel {
     }
 
     TestBase::TestBase(clspv_utils::kernel& kernel, const std::vector<std::string>& args, std::size_t sizeofPixelComponent, unsigned int numComponents) :
-            mBufferExtent(64, 64, 1)
+            mBufferExtent(test_utils::read_extent_args(args,
+                                                       vk::Extent3D(64, 64, 1),
+                                                       3,
+                                                       sizeofPixelComponent * numComponents,
+                                                       kernel.getDevice(),
+                                                       "copybuffertobuffer"))
     {
         auto& device = kernel.getDevice();
 
-        for (auto arg = args.begin(); arg != args.end(); arg = std::next(arg)) {
-            if (*arg == "-w") {
-                arg = std::next(arg);
-                if (arg == args.end()) throw std::runtime_error("badly formed arguments to copybuffertoboffer test");
-                mBufferExtent.width = std::atoi(arg->c_str());
-            }
-            else if (*arg == "-h") {
-                arg = std::next(arg);
-                if (arg == args.end()) throw std::runtime_error("badly formed arguments to copybuffertoboffer test");
-                mBufferExtent.height = std::atoi(arg->c_str());
-            }
-        }
-
-        const std::size_t buffer_length =
-                mBufferExtent.width * mBufferExtent.height * mBufferExtent.depth;
+        const std::size_t buffer_length = test_utils::count_pixels(mBufferExtent);
         const std::size_t buffer_size = buffer_length * sizeofPixelComponent * numComponents;
         mIs32Bit = (sizeofPixelComponent == 4);
+        mPixelSize = sizeofPixelComponent * numComponents;
 
         // allocate buffers and images
         mSrcBuffer = vulkan_utils::storage_buffer(device.getDevice(),
@@ -112,6 +104,20 @@ namespace copybuffertobuffer_kernel {
 
     }
 
+    vk::Extent3D TestBase::getExtent() const
+    {
+        return mBufferExtent;
+    }
+
+    test_utils::Workload TestBase::getWorkload() const
+    {
+        // every pixel is read once and written once
+        test_utils::Workload result;
+        result.mBytesRead = test_utils::count_pixels(mBufferExtent) * mPixelSize;
+        result.mBytesWritten = result.mBytesRead;
+        return result;
+    }
+
     clspv_utils::execution_time_t TestBase::run(clspv_utils::kernel& kernel)
     {
         return invoke(kernel,
@@ -123,7 +129,7 @@ namespace copybuffertobuffer_kernel {
                       0,                    // dst_offset
                       mIs32Bit,             // is32Bit
                       mBufferExtent.width,  // width
-                      mBufferExtent.height);// height
+                      mBufferExtent.height * mBufferExtent.depth);  // height; slices are copied as consecutive rows
     }
 
 
@@ -35,12 +35,17 @@ namespace copybuffertobuffer_kernel {
 
         ~TestBase();
 
+        virtual vk::Extent3D getExtent() const override;
+
+        virtual test_utils::Workload getWorkload() const override;
+
         virtual clspv_utils::execution_time_t run(clspv_utils::kernel& kernel) override;
 
         vk::Extent3D                    mBufferExtent;
         vulkan_utils::storage_buffer    mSrcBuffer;
         vulkan_utils::storage_buffer    mDstBuffer;
         bool                            mIs32Bit;
+        std::size_t                     mPixelSize;
     };
 
     template <typename PixelType>
@@ -55,8 +60,7 @@ namespace copybuffertobuffer_kernel {
             static_assert(4 == PixelType::num_components, "copybuffertoboffer_kernel requires 4-vector pixels");
             static_assert(2 == sizeof(typename PixelType::component_type) || 4 == sizeof(typename PixelType::component_type), "copybuffertoboffer_kernel requires half4 or float4 pixels");
 
-            const std::size_t buffer_length =
-                    mBufferExtent.width * mBufferExtent.height * mBufferExtent.depth;
+            const std::size_t buffer_length = test_utils::count_pixels(mBufferExtent);
 
             // initialize source memory with random data
             auto srcBufferMap = mSrcBuffer.map<PixelType>();
@@ -66,8 +70,7 @@ namespace copybuffertobuffer_kernel {
 
         virtual void prepare() override
         {
-            const std::size_t buffer_length =
-                    mBufferExtent.width * mBufferExtent.height * mBufferExtent.depth;
+            const std::size_t buffer_length = test_utils::count_pixels(mBufferExtent);
 
             // initialize destination memory (copy source and invert, thereby forcing the kernel to make the change back to the source value)
             auto srcBufferMap = mSrcBuffer.map<PixelType>();
@@ -84,13 +87,10 @@ namespace copybuffertobuffer_kernel {
 
         virtual test_utils::Evaluation evaluate(bool verbose) override
         {
-            auto srcBufferMap = mSrcBuffer.map<PixelType>();
-            auto dstBufferMap = mDstBuffer.map<PixelType>();
-            return test_utils::check_results(srcBufferMap.get(),
-                                             dstBufferMap.get(),
-                                             mBufferExtent,
-                                             mBufferExtent.width,
-                                             verbose);
+            return test_utils::check_buffer_results<PixelType>(mSrcBuffer,
+                                                               mDstBuffer,
+                                                               mBufferExtent,
+                                                               verbose);
         }
     };
 
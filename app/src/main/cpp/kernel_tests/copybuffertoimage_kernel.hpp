@@ -36,7 +36,7 @@ namespace copybuffertoimage_kernel {
     struct Test : public test_utils::Test
     {
         Test(clspv_utils::kernel& kernel, const std::vector<std::string>& args) :
-                mBufferExtent(64, 64, 1)
+                mBufferExtent(test_utils::read_extent_args(args, vk::Extent3D(64, 64, 1), 2, sizeof(BufferPixelType), kernel.getDevice(), "copybuffertoimage"))
         {
             auto& device = kernel.getDevice();
 
@@ -51,8 +51,7 @@ namespace copybuffertoimage_kernel {
             mComputeQueue = device.getComputeQueue();
             mCommandPool = device.getCommandPool();
 
-            const std::size_t buffer_length =
-                    mBufferExtent.width * mBufferExtent.height * mBufferExtent.depth;
+            const std::size_t buffer_length = test_utils::count_pixels(mBufferExtent);
             const std::size_t buffer_size = buffer_length * sizeof(BufferPixelType);
 
             // allocate buffers and images
@@ -74,8 +73,7 @@ namespace copybuffertoimage_kernel {
 
         virtual void prepare() override
         {
-            const std::size_t buffer_length =
-                    mBufferExtent.width * mBufferExtent.height * mBufferExtent.depth;
+            const std::size_t buffer_length = test_utils::count_pixels(mBufferExtent);
 
             // initialize destination memory (copy source and invert, thereby forcing the kernel to make the change back to the source value)
             auto srcBufferMap = mSrcBuffer.map<BufferPixelType>();
@@ -88,6 +86,19 @@ namespace copybuffertoimage_kernel {
                                                             dstImageMap.get() + buffer_length);
         }
 
+        virtual vk::Extent3D getExtent() const override
+        {
+            return mBufferExtent;
+        }
+
+        virtual test_utils::Workload getWorkload() const override
+        {
+            test_utils::Workload result;
+            result.mBytesRead = test_utils::count_pixels(mBufferExtent) * sizeof(BufferPixelType);
+            result.mBytesWritten = test_utils::count_pixels(mBufferExtent) * sizeof(ImagePixelType);
+            return result;
+        }
+
         virtual clspv_utils::execution_time_t run(clspv_utils::kernel& kernel) override
         {
             return invoke(kernel,
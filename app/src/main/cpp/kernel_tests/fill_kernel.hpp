@@ -32,33 +32,20 @@ namespace fill_kernel {
     struct Test : public test_utils::Test
     {
         Test(clspv_utils::kernel& kernel, const std::vector<std::string>& args) :
-            mBufferExtent(64, 64, 1),
+            mBufferExtent(test_utils::read_extent_args(args, vk::Extent3D(64, 64, 1), 3, sizeof(PixelType), kernel.getDevice(), "fill")),
             mFillColor(0.25f, 0.50f, 0.75f, 1.0f)
         {
             auto& device = kernel.getDevice();
 
-            for (auto arg = args.begin(); arg != args.end(); arg = std::next(arg)) {
-                if (*arg == "-w") {
-                    arg = std::next(arg);
-                    if (arg == args.end()) throw std::runtime_error("badly formed arguments to fill test");
-                    mBufferExtent.width = std::atoi(arg->c_str());
-                }
-                else if (*arg == "-h") {
-                    arg = std::next(arg);
-                    if (arg == args.end()) throw std::runtime_error("badly formed arguments to fill test");
-                    mBufferExtent.height = std::atoi(arg->c_str());
-                }
-            }
-
             // allocate image buffer
-            const std::size_t buffer_length = mBufferExtent.width * mBufferExtent.height * mBufferExtent.depth;
+            const std::size_t buffer_length = test_utils::count_pixels(mBufferExtent);
             const std::size_t buffer_size = buffer_length * sizeof(PixelType);
             mDstBuffer = vulkan_utils::storage_buffer(device.getDevice(), device.getMemoryProperties(), buffer_size);
         }
 
         virtual void prepare() override
         {
-            const std::size_t buffer_length = mBufferExtent.width * mBufferExtent.height * mBufferExtent.depth;
+            const std::size_t buffer_length = test_utils::count_pixels(mBufferExtent);
 
             const PixelType src_value = pixels::traits<PixelType>::translate((gpu_types::float4){ 0.0f, 0.0f, 0.0f, 0.0f });
             auto dstBufferMap = mDstBuffer.map<PixelType>();
@@ -72,6 +59,18 @@ namespace fill_kernel {
             return os.str();
         }
 
+        virtual vk::Extent3D getExtent() const override
+        {
+            return mBufferExtent;
+        }
+
+        virtual test_utils::Workload getWorkload() const override
+        {
+            test_utils::Workload result;
+            result.mBytesWritten = test_utils::count_pixels(mBufferExtent) * sizeof(PixelType);
+            return result;
+        }
+
         virtual clspv_utils::execution_time_t run(clspv_utils::kernel& kernel) override
         {
 
@@ -80,7 +79,7 @@ namespace fill_kernel {
                           mBufferExtent.width,   // pitch
                           pixels::traits<PixelType>::device_pixel_format, // device_format
                           0, 0, // offset_x, offset_y
-                          mBufferExtent.width, mBufferExtent.height, // width, height
+                          mBufferExtent.width, mBufferExtent.height * mBufferExtent.depth, // width, height; slices are filled as consecutive rows
                           mFillColor); // color
         }
 
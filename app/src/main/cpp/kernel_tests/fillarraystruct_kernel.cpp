@@ -34,7 +34,7 @@ namespace fillarraystruct_kernel {
     }
 
     Test::Test(clspv_utils::kernel& kernel, const std::vector<std::string>& args) :
-        mBufferWidth(32)
+        mBufferWidth(test_utils::read_extent_args(args, vk::Extent3D(32, 1, 1), 1, sizeof(FloatArrayWrapper), kernel.getDevice(), "fillarraystruct").width)
     {
         auto& device = kernel.getDevice();
 
@@ -70,6 +70,20 @@ namespace fillarraystruct_kernel {
 
     }
 
+    vk::Extent3D Test::getExtent() const
+    {
+        return vk::Extent3D(mBufferWidth, 1, 1);
+    }
+
+    test_utils::Workload Test::getWorkload() const
+    {
+        // each element is a multiply and two adds
+        test_utils::Workload result;
+        result.mBytesWritten = static_cast<std::uint64_t>(mBufferWidth) * sizeof(FloatArrayWrapper);
+        result.mOperations = static_cast<std::uint64_t>(mBufferWidth) * kWrapperArraySize * 3;
+        return result;
+    }
+
     clspv_utils::execution_time_t Test::run(clspv_utils::kernel& kernel)
     {
         return invoke(kernel,
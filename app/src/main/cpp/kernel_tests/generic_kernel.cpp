@@ -4,32 +4,9 @@
 
 #include "generic_kernel.hpp"
 
+#include "clspv_utils/hex_utils.hpp"
 #include "clspv_utils/kernel.hpp"
 
-namespace {
-    std::vector<std::uint8_t> hexToBytes(std::string hexString) {
-        std::vector<std::uint8_t> result;
-
-        if (0 != (hexString.length() % 2)) {
-            clspv_utils::fail_runtime_error("hex string must have even number of characters");
-        }
-
-        result.reserve(hexString.length() / 2);
-
-        for (std::string::size_type i = 0; i < hexString.length(); i +=2) {
-            const std::string   byteString = hexString.substr(i, 2);
-            const int           byteInt = std::stoi(byteString, nullptr, 16);
-
-            assert(0 <= byteInt);
-            assert(byteInt <= std::numeric_limits<std::uint8_t>::max());
-
-            result.push_back(static_cast<std::uint8_t>(byteInt));
-        }
-
-        return result;
-    }
-}
-
 namespace generic_kernel {
 
     Test::Test(clspv_utils::kernel& kernel, const std::vector<std::string>& args)
@@ -64,7 +41,7 @@ namespace generic_kernel {
                 // add a storage buffer argument
                 arg = std::next(arg);
                 if (arg == args.end()) clspv_utils::fail_runtime_error("badly formed arguments to generic test");
-                const auto bufferContents = hexToBytes(*arg);
+                const auto bufferContents = clspv_utils::hexToBytes(*arg);
 
                 mStorageBuffers.push_back(vulkan_utils::storage_buffer(device.getDevice(), device.getMemoryProperties(), bufferContents.size()));
                 mArgOrder.push_back(kind_storageBuffer);
@@ -76,7 +53,7 @@ namespace generic_kernel {
                 // add a uniform buffer argument
                 arg = std::next(arg);
                 if (arg == args.end()) clspv_utils::fail_runtime_error("badly formed arguments to generic test");
-                const auto bufferContents = hexToBytes(*arg);
+                const auto bufferContents = clspv_utils::hexToBytes(*arg);
 
                 mUniformBuffers.push_back(vulkan_utils::uniform_buffer(device.getDevice(), device.getMemoryProperties(), bufferContents.size()));
                 mArgOrder.push_back(kind_uniformBuffer);
@@ -40,11 +40,11 @@ namespace readconstantdata_kernel {
     }
 
     Test::Test(clspv_utils::kernel& kernel, const std::vector<std::string>& args) :
-        mBufferExtent(64, 1, 1)
+        mBufferExtent(test_utils::read_extent_args(args, vk::Extent3D(64, 1, 1), 1, sizeof(float), kernel.getDevice(), "readconstantdata"))
     {
         auto& device = kernel.getDevice();
 
-        const std::size_t buffer_length = mBufferExtent.width * mBufferExtent.height * mBufferExtent.depth;
+        const std::size_t buffer_length = test_utils::count_pixels(mBufferExtent);
         const std::size_t buffer_size = buffer_length * sizeof(float);
 
         // number of elements in the constant data array (in the kernel itself)
@@ -70,13 +70,26 @@ namespace readconstantdata_kernel {
 
     void Test::prepare()
     {
-        const std::size_t buffer_length = mBufferExtent.width * mBufferExtent.height * mBufferExtent.depth;
+        const std::size_t buffer_length = test_utils::count_pixels(mBufferExtent);
 
         // initialize destination memory with random data
         auto dstBufferMap = mDstBuffer.map<float>();
         test_utils::fill_random_pixels<float>(dstBufferMap.get(), dstBufferMap.get() + buffer_length);
     }
 
+    vk::Extent3D Test::getExtent() const
+    {
+        return mBufferExtent;
+    }
+
+    test_utils::Workload Test::getWorkload() const
+    {
+        // the constant table is too small to count
+        test_utils::Workload result;
+        result.mBytesWritten = test_utils::count_pixels(mBufferExtent) * sizeof(float);
+        return result;
+    }
+
     clspv_utils::execution_time_t Test::run(clspv_utils::kernel& kernel)
     {
         return invoke(kernel,
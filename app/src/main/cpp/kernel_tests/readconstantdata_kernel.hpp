@@ -25,6 +25,10 @@ namespace readconstantdata_kernel {
 
         virtual void prepare() override;
 
+        virtual vk::Extent3D getExtent() const override;
+
+        virtual test_utils::Workload getWorkload() const override;
+
         virtual clspv_utils::execution_time_t run(clspv_utils::kernel& kernel) override;
 
         virtual test_utils::Evaluation evaluate(bool verbose) override;
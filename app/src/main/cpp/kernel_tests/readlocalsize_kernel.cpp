@@ -6,9 +6,15 @@
 
 #include "clspv_utils/kernel.hpp"
 
+#include <numeric>
+
 namespace {
     using namespace readlocalsize_kernel;
 
+    // the version of compute_expected_results, which keys its cached results; bump it whenever the
+    // function changes
+    const unsigned int kExpectedResultsVersion = 1;
+
     auto idtype_string_map = {
             std::make_pair("global_size_x", idtype_globalsize_x),
             std::make_pair("global_size_y", idtype_globalsize_y),
@@ -54,7 +60,7 @@ namespace {
     }
 
     std::vector<std::int32_t> compute_expected_global_id_x(int width, int height, int pitch) {
-        std::vector<std::int32_t> expected(pitch * height);
+        std::vector<std::int32_t> expected(static_cast<std::size_t>(pitch) * height);
 
         auto rowIter = expected.begin();
         for (int i = 0; i < height; ++i) {
@@ -66,7 +72,7 @@ namespace {
     }
 
     std::vector<std::int32_t> compute_expected_global_id_y(int width, int height, int pitch) {
-        std::vector<std::int32_t> expected(pitch * height);
+        std::vector<std::int32_t> expected(static_cast<std::size_t>(pitch) * height);
 
         auto rowIter = expected.begin();
         for (int i = 0; i < height; ++i) {
@@ -78,7 +84,7 @@ namespace {
     }
 
     std::vector<std::int32_t> compute_expected_global_id_z(int width, int height, int pitch) {
-        std::vector<std::int32_t> expected(pitch * height);
+        std::vector<std::int32_t> expected(static_cast<std::size_t>(pitch) * height);
 
         auto rowIter = expected.begin();
         for (int i = 0; i < height; ++i) {
@@ -90,7 +96,7 @@ namespace {
     }
 
     std::vector<std::int32_t> compute_expected_global_size_x(int width, int height, int pitch) {
-        std::vector<std::int32_t> expected(pitch * height);
+        std::vector<std::int32_t> expected(static_cast<std::size_t>(pitch) * height);
 
         auto rowIter = expected.begin();
         for (int i = 0; i < height; ++i) {
@@ -102,7 +108,7 @@ namespace {
     }
 
     std::vector<std::int32_t> compute_expected_global_size_y(int width, int height, int pitch) {
-        std::vector<std::int32_t> expected(pitch * height);
+        std::vector<std::int32_t> expected(static_cast<std::size_t>(pitch) * height);
 
         auto rowIter = expected.begin();
         for (int i = 0; i < height; ++i) {
@@ -114,7 +120,7 @@ namespace {
     }
 
     std::vector<std::int32_t> compute_expected_global_size_z(int width, int height, int pitch) {
-        std::vector<std::int32_t> expected(pitch * height);
+        std::vector<std::int32_t> expected(static_cast<std::size_t>(pitch) * height);
 
         auto rowIter = expected.begin();
         for (int i = 0; i < height; ++i) {
@@ -126,7 +132,7 @@ namespace {
     }
 
     std::vector<std::int32_t> compute_expected_group_id_x(int width, int height, int pitch, int group_width) {
-        std::vector<std::int32_t> expected(pitch * height);
+        std::vector<std::int32_t> expected(static_cast<std::size_t>(pitch) * height);
 
         const int num_groups = (width + group_width - 1) / group_width;
         auto rowIter = expected.begin();
@@ -142,7 +148,7 @@ namespace {
     }
 
     std::vector<std::int32_t> compute_expected_group_id_y(int width, int height, int pitch, int group_height) {
-        std::vector<std::int32_t> expected(pitch * height);
+        std::vector<std::int32_t> expected(static_cast<std::size_t>(pitch) * height);
 
         auto rowIter = expected.begin();
         for (int i = 0; i < height; ++i) {
@@ -154,7 +160,7 @@ namespace {
     }
 
     std::vector<std::int32_t> compute_expected_group_id_z(int width, int height, int pitch, int group_depth) {
-        std::vector<std::int32_t> expected(pitch * height);
+        std::vector<std::int32_t> expected(static_cast<std::size_t>(pitch) * height);
 
         auto rowIter = expected.begin();
         for (int i = 0; i < height; ++i) {
@@ -166,7 +172,7 @@ namespace {
     }
 
     std::vector<std::int32_t> compute_expected_local_id_x(int width, int height, int pitch, int group_width) {
-        std::vector<std::int32_t> expected(pitch * height);
+        std::vector<std::int32_t> expected(static_cast<std::size_t>(pitch) * height);
 
         const int num_groups = (width + group_width - 1) / group_width;
         auto rowIter = expected.begin();
@@ -184,7 +190,7 @@ namespace {
     }
 
     std::vector<std::int32_t> compute_expected_local_id_y(int width, int height, int pitch, int group_height) {
-        std::vector<std::int32_t> expected(pitch * height);
+        std::vector<std::int32_t> expected(static_cast<std::size_t>(pitch) * height);
 
         auto rowIter = expected.begin();
         for (int i = 0; i < height; ++i) {
@@ -196,7 +202,7 @@ namespace {
     }
 
     std::vector<std::int32_t> compute_expected_local_id_z(int width, int height, int pitch, int group_depth) {
-        std::vector<std::int32_t> expected(pitch * height);
+        std::vector<std::int32_t> expected(static_cast<std::size_t>(pitch) * height);
 
         auto rowIter = expected.begin();
         for (int i = 0; i < height; ++i) {
@@ -208,7 +214,7 @@ namespace {
     }
 
     std::vector<std::int32_t> compute_expected_local_size_x(int width, int height, int pitch, int group_width) {
-        std::vector<std::int32_t> expected(pitch * height);
+        std::vector<std::int32_t> expected(static_cast<std::size_t>(pitch) * height);
 
         auto rowIter = expected.begin();
         for (int i = 0; i < height; ++i) {
@@ -220,7 +226,7 @@ namespace {
     }
 
     std::vector<std::int32_t> compute_expected_local_size_y(int width, int height, int pitch, int group_height) {
-        std::vector<std::int32_t> expected(pitch * height);
+        std::vector<std::int32_t> expected(static_cast<std::size_t>(pitch) * height);
 
         auto rowIter = expected.begin();
         for (int i = 0; i < height; ++i) {
@@ -232,7 +238,7 @@ namespace {
     }
 
     std::vector<std::int32_t> compute_expected_local_size_z(int width, int height, int pitch, int group_depth) {
-        std::vector<std::int32_t> expected(pitch * height);
+        std::vector<std::int32_t> expected(static_cast<std::size_t>(pitch) * height);
 
         auto rowIter = expected.begin();
         for (int i = 0; i < height; ++i) {
@@ -362,30 +368,40 @@ namespace readlocalsize_kernel {
     }
 
     Test::Test(clspv_utils::kernel& kernel, const std::vector<std::string>& args) :
-            mBufferExtent(64, 64, 1),
+            mBufferExtent(test_utils::read_extent_args(args, vk::Extent3D(64, 64, 1), 2, sizeof(std::int32_t), kernel.getDevice(), "readlocalsize")),
             mIdType(idtype_globalid_x)
     {
         auto& device = kernel.getDevice();
 
-        if (!args.empty())
+        // the id type, if given, comes before any size arguments
+        if (!args.empty() && '-' != args[0][0])
         {
             mIdType = idtype_from_string(args[0]);
         }
 
         // allocate data buffer
-        auto num_elements = mBufferExtent.width * mBufferExtent.height * mBufferExtent.depth;
+        const std::size_t num_elements = test_utils::count_pixels(mBufferExtent);
         const std::size_t buffer_size = num_elements * sizeof(std::int32_t);
         mDstBuffer = vulkan_utils::storage_buffer(device.getDevice(), device.getMemoryProperties(), buffer_size);
 
-        mExpectedResults = compute_expected_results(mIdType,
-                                                        mBufferExtent.width,
-                                                        mBufferExtent.height,
-                                                        kernel.getWorkgroupSize());
+        const vk::Extent3D workgroupSize = kernel.getWorkgroupSize();
+
+        std::ostringstream cacheKey;
+        cacheKey << test_utils::get_invocation_identity() << " readlocalsize " << string_from_idtype(mIdType) << ' '
+                 << mBufferExtent.width << 'x' << mBufferExtent.height
+                 << " workgroup:" << workgroupSize.width << 'x' << workgroupSize.height << 'x' << workgroupSize.depth;
+
+        mExpectedResults = expected_cache::get_or_compute<std::int32_t>(cacheKey.str(), kExpectedResultsVersion, num_elements, [&]() {
+            return compute_expected_results(mIdType,
+                                            mBufferExtent.width,
+                                            mBufferExtent.height,
+                                            workgroupSize);
+        });
     }
 
     void Test::prepare()
     {
-        const auto num_elements = mBufferExtent.width * mBufferExtent.height * mBufferExtent.depth;
+        const std::size_t num_elements = test_utils::count_pixels(mBufferExtent);
 
         auto dstBufferMap = mDstBuffer.map<std::int32_t>();
         test_utils::fill_random_pixels<std::int32_t>(dstBufferMap.get(), dstBufferMap.get() + num_elements);
@@ -397,6 +413,18 @@ namespace readlocalsize_kernel {
         return string_from_idtype(mIdType);
     }
 
+    vk::Extent3D Test::getExtent() const
+    {
+        return mBufferExtent;
+    }
+
+    test_utils::Workload Test::getWorkload() const
+    {
+        test_utils::Workload result;
+        result.mBytesWritten = test_utils::count_pixels(mBufferExtent) * sizeof(std::int32_t);
+        return result;
+    }
+
     clspv_utils::execution_time_t Test::run(clspv_utils::kernel& kernel)
     {
         return invoke(kernel,
@@ -6,6 +6,7 @@
 #define CLSPVTEST_READLOCALSIZE_KERNEL_HPP
 
 #include "clspv_utils/clspv_utils_fwd.hpp"
+#include "expected_cache.hpp"
 #include "test_utils.hpp"
 
 #include <vulkan/vulkan.hpp>
@@ -52,13 +53,17 @@ namespace readlocalsize_kernel {
 
         virtual std::string getParameterString() const override;
 
+        virtual vk::Extent3D getExtent() const override;
+
+        virtual test_utils::Workload getWorkload() const override;
+
         virtual clspv_utils::execution_time_t run(clspv_utils::kernel& kernel) override;
 
         virtual test_utils::Evaluation  evaluate(bool verbose) override;
 
         vk::Extent3D                    mBufferExtent;
         vulkan_utils::storage_buffer    mDstBuffer;
-        std::vector<std::int32_t>       mExpectedResults;
+        expected_cache::pixels<std::int32_t>    mExpectedResults;
         idtype_t                        mIdType;
     };
 
@@ -12,6 +12,10 @@
 #include <util.hpp>
 
 namespace {
+    // identifies the expected results computed in prepare; bump it whenever that computation
+    // changes, so that results cached by earlier builds are recomputed
+    const unsigned int kExpectedResultsVersion = 1;
+
     float normalize_coord(int coord, int range)
     {
         return ((float)coord) / ((float)(range - 1));
@@ -93,7 +97,7 @@ namespace resample2dimage_kernel {
     }
 
     Test::Test(clspv_utils::kernel& kernel, const std::vector<std::string>& args) :
-        mBufferExtent(64, 64, 1)
+        mBufferExtent(test_utils::read_extent_args(args, vk::Extent3D(64, 64, 1), 2, sizeof(BufferPixelType), kernel.getDevice(), "resample2dimage"))
     {
         auto& device = kernel.getDevice();
 
@@ -106,7 +110,7 @@ namespace resample2dimage_kernel {
                 { 0.0f, 1.0f, 0.0f, 0.0f }, { 0.5f, 1.0f, 0.0f, 0.0f }, { 1.0f, 1.0f, 0.0f, 0.0f }
         };
 
-        const std::size_t buffer_length = mBufferExtent.width * mBufferExtent.height * mBufferExtent.depth;
+        const std::size_t buffer_length = test_utils::count_pixels(mBufferExtent);
         const std::size_t buffer_size = buffer_length * sizeof(BufferPixelType);
 
         // allocate buffers and images
@@ -125,24 +129,32 @@ namespace resample2dimage_kernel {
         std::copy(std::begin(image_buffer_data), std::end(image_buffer_data), srcImageMap.get());
         srcImageMap.reset();
 
-        mExpectedDstBuffer.resize(buffer_length);
-        for (int row = 0; row < mBufferExtent.height; ++row)
-        {
-            for (int col = 0; col < mBufferExtent.width; ++col)
-            {
-                gpu_types::float2 normalizedCoordinate(((float)col + 0.5f) / ((float)mBufferExtent.width),
-                                                       ((float)row + 0.5f) / ((float)mBufferExtent.height));
-
-                gpu_types::float2 sampledCoordinate(clampf(normalizedCoordinate.x*image_width - 0.5f, 0.0f, image_width - 1)/(image_width - 1),
-                                                    clampf(normalizedCoordinate.y*image_height - 0.5f, 0.0f, image_height - 1)/(image_height - 1));
+        std::ostringstream cacheKey;
+        // the source image is fixed, so the seed has no place in the key
+        cacheKey << test_utils::get_invocation_identity() << " resample2dimage "
+                 << mBufferExtent.width << 'x' << mBufferExtent.height << 'x' << mBufferExtent.depth;
 
-                auto index = (row * mBufferExtent.width) + col;
-                mExpectedDstBuffer[index] = BufferPixelType(sampledCoordinate.x,
-                                                             sampledCoordinate.y,
-                                                             0.0f,
-                                                             0.0f);
+        mExpectedDstBuffer = expected_cache::get_or_compute<BufferPixelType>(cacheKey.str(), kExpectedResultsVersion, buffer_length, [&]() {
+            std::vector<BufferPixelType> expected(buffer_length);
+            for (int row = 0; row < mBufferExtent.height; ++row)
+            {
+                for (int col = 0; col < mBufferExtent.width; ++col)
+                {
+                    gpu_types::float2 normalizedCoordinate(((float)col + 0.5f) / ((float)mBufferExtent.width),
+                                                           ((float)row + 0.5f) / ((float)mBufferExtent.height));
+
+                    gpu_types::float2 sampledCoordinate(clampf(normalizedCoordinate.x*image_width - 0.5f, 0.0f, image_width - 1)/(image_width - 1),
+                                                        clampf(normalizedCoordinate.y*image_height - 0.5f, 0.0f, image_height - 1)/(image_height - 1));
+
+                    const std::size_t index = (static_cast<std::size_t>(row) * mBufferExtent.width) + col;
+                    expected[index] = BufferPixelType(sampledCoordinate.x,
+                                                      sampledCoordinate.y,
+                                                      0.0f,
+                                                      0.0f);
+                }
             }
-        }
+            return expected;
+        });
 
         // complete setup of the image
         mSetupCommand = vulkan_utils::allocate_command_buffer(device.getDevice(), device.getCommandPool());
@@ -160,13 +172,28 @@ namespace resample2dimage_kernel {
 
     void Test::prepare()
     {
-        const std::size_t buffer_length = mBufferExtent.width * mBufferExtent.height * mBufferExtent.depth;
+        const std::size_t buffer_length = test_utils::count_pixels(mBufferExtent);
 
         // initialize destination memory to zero
         auto dstBufferMap = mDstBuffer.map<BufferPixelType>();
         std::fill(dstBufferMap.get(), dstBufferMap.get() + buffer_length, BufferPixelType(0.0f, 0.0f, 0.0f, 0.0f));
     }
 
+    vk::Extent3D Test::getExtent() const
+    {
+        return mBufferExtent;
+    }
+
+    test_utils::Workload Test::getWorkload() const
+    {
+        // the 3x3 source image is too small to count; each pixel computes its coordinate with two
+        // adds and two divides, leaving the filtering to the sampler
+        test_utils::Workload result;
+        result.mBytesWritten = test_utils::count_pixels(mBufferExtent) * sizeof(BufferPixelType);
+        result.mOperations = test_utils::count_pixels(mBufferExtent) * 4;
+        return result;
+    }
+
     clspv_utils::execution_time_t Test::run(clspv_utils::kernel& kernel)
     {
         return invoke(kernel,
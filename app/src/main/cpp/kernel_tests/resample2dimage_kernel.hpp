@@ -6,6 +6,7 @@
 #define CLSPVTEST_RESAMPLE2DIMAGE_KERNEL_HPP
 
 #include "clspv_utils/clspv_utils_fwd.hpp"
+#include "expected_cache.hpp"
 #include "test_utils.hpp"
 #include "vulkan_utils/vulkan_utils.hpp"
 
@@ -29,6 +30,10 @@ namespace resample2dimage_kernel {
 
         virtual void prepare() override;
 
+        virtual vk::Extent3D getExtent() const override;
+
+        virtual test_utils::Workload getWorkload() const override;
+
         virtual clspv_utils::execution_time_t run(clspv_utils::kernel& kernel) override;
 
         virtual test_utils::Evaluation evaluate(bool verbose) override;
@@ -37,7 +42,7 @@ namespace resample2dimage_kernel {
         vulkan_utils::image             mSrcImage;
         vulkan_utils::staging_buffer    mSrcImageStaging;
         vulkan_utils::storage_buffer    mDstBuffer;
-        std::vector<BufferPixelType>    mExpectedDstBuffer;
+        expected_cache::pixels<BufferPixelType> mExpectedDstBuffer;
         vk::UniqueCommandBuffer         mSetupCommand;
     };
 
@@ -10,6 +10,9 @@
 #include <vulkan/vulkan.hpp>
 
 namespace {
+    // bump whenever the expected results computed in prepare change, invalidating cached copies
+    const unsigned int kExpectedResultsVersion = 1;
+
     float clampf(float value, float lo, float hi)
     {
         if (value < lo) return lo;
@@ -62,11 +65,11 @@ namespace resample3dimage_kernel {
     }
 
     Test::Test(clspv_utils::kernel& kernel, const std::vector<std::string>& args) :
-        mBufferExtent(64, 64, 64)
+        mBufferExtent(test_utils::read_extent_args(args, vk::Extent3D(64, 64, 64), 3, sizeof(BufferPixelType), kernel.getDevice(), "resample3dimage"))
     {
         auto& device = kernel.getDevice();
 
-        const std::size_t buffer_length = mBufferExtent.width * mBufferExtent.height * mBufferExtent.depth;
+        const std::size_t buffer_length = test_utils::count_pixels(mBufferExtent);
         const std::size_t buffer_size = buffer_length * sizeof(BufferPixelType);
 
         const vk::Extent3D imageExtent(3, 3, 3);
@@ -115,40 +118,62 @@ namespace resample3dimage_kernel {
 
         device.getComputeQueue().submit(submitInfo, nullptr);
 
-        // compute expected results
-        mExpectedDstBuffer.resize(buffer_length);
-        for (int row = 0; row < mBufferExtent.height; ++row)
-        {
-            for (int col = 0; col < mBufferExtent.width; ++col)
+        // compute expected results, unless a previous run cached them; they are the same for any seed
+        std::ostringstream cacheKey;
+        cacheKey << test_utils::get_invocation_identity() << " resample3dimage "
+                 << mBufferExtent.width << 'x' << mBufferExtent.height << 'x' << mBufferExtent.depth;
+
+        mExpectedDstBuffer = expected_cache::get_or_compute<BufferPixelType>(cacheKey.str(), kExpectedResultsVersion, buffer_length, [&]() {
+            std::vector<BufferPixelType> expected(buffer_length);
+            for (int row = 0; row < mBufferExtent.height; ++row)
             {
-                for (int slice = 0; slice < mBufferExtent.depth; ++slice) {
-                    gpu_types::float4 normalizedCoordinate(
-                            ((float) col + 0.5f) / ((float) mBufferExtent.width),
-                            ((float) row + 0.5f) / ((float) mBufferExtent.height),
-                            ((float) slice + 0.5f) / ((float) mBufferExtent.depth),
-                            0.0f);
-
-                    gpu_types::float4 sampledCoordinate(
-                            clampf(normalizedCoordinate.x * imageExtent.width - 0.5f, 0.0f, imageExtent.width - 1) / (imageExtent.width - 1),
-                            clampf(normalizedCoordinate.y * imageExtent.height - 0.5f, 0.0f, imageExtent.height - 1) / (imageExtent.height - 1),
-                            clampf(normalizedCoordinate.z * imageExtent.depth - 0.5f, 0.0f, imageExtent.depth - 1) / (imageExtent.depth - 1),
-                            0.0f);
-
-                    mExpectedDstBuffer[(((slice * mBufferExtent.height) + row) * mBufferExtent.width) + col] = sampledCoordinate;
+                for (int col = 0; col < mBufferExtent.width; ++col)
+                {
+                    for (int slice = 0; slice < mBufferExtent.depth; ++slice) {
+                        gpu_types::float4 normalizedCoordinate(
+                                ((float) col + 0.5f) / ((float) mBufferExtent.width),
+                                ((float) row + 0.5f) / ((float) mBufferExtent.height),
+                                ((float) slice + 0.5f) / ((float) mBufferExtent.depth),
+                                0.0f);
+
+                        gpu_types::float4 sampledCoordinate(
+                                clampf(normalizedCoordinate.x * imageExtent.width - 0.5f, 0.0f, imageExtent.width - 1) / (imageExtent.width - 1),
+                                clampf(normalizedCoordinate.y * imageExtent.height - 0.5f, 0.0f, imageExtent.height - 1) / (imageExtent.height - 1),
+                                clampf(normalizedCoordinate.z * imageExtent.depth - 0.5f, 0.0f, imageExtent.depth - 1) / (imageExtent.depth - 1),
+                                0.0f);
+
+                        expected[(((static_cast<std::size_t>(slice) * mBufferExtent.height) + row) * mBufferExtent.width) + col] = sampledCoordinate;
+                    }
                 }
             }
-        }
+            return expected;
+        });
     }
 
     void Test::prepare()
     {
-        const std::size_t buffer_length = mBufferExtent.width * mBufferExtent.height * mBufferExtent.depth;
+        const std::size_t buffer_length = test_utils::count_pixels(mBufferExtent);
 
         // initialize destination memory to zero
         auto dstBufferMap = mDstBuffer.map<BufferPixelType>();
         std::fill(dstBufferMap.get(), dstBufferMap.get() + buffer_length, gpu_types::float4(0.0f, 0.0f, 0.0f, 0.0f));
     }
 
+    vk::Extent3D Test::getExtent() const
+    {
+        return mBufferExtent;
+    }
+
+    test_utils::Workload Test::getWorkload() const
+    {
+        // the 3x3x3 source image is too small to count; each pixel computes its coordinate with three
+        // adds and three divides, leaving the filtering to the sampler
+        test_utils::Workload result;
+        result.mBytesWritten = test_utils::count_pixels(mBufferExtent) * sizeof(BufferPixelType);
+        result.mOperations = test_utils::count_pixels(mBufferExtent) * 6;
+        return result;
+    }
+
     clspv_utils::execution_time_t Test::run(clspv_utils::kernel& kernel)
     {
         return invoke(kernel,
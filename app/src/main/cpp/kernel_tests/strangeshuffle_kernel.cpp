@@ -6,6 +6,8 @@
 
 #include "clspv_utils/kernel.hpp"
 
+#include <numeric>
+
 namespace strangeshuffle_kernel {
 
     clspv_utils::execution_time_t
@@ -34,7 +36,7 @@ namespace strangeshuffle_kernel {
     }
 
     Test::Test(clspv_utils::kernel& kernel, const std::vector<std::string>& args) :
-        mBufferWidth(4096)
+        mBufferWidth(test_utils::read_extent_args(args, vk::Extent3D(4096, 1, 1), 1, sizeof(gpu_types::float4), kernel.getDevice(), "strangeshuffle").width)
     {
         auto& device = kernel.getDevice();
 
@@ -60,6 +62,21 @@ namespace strangeshuffle_kernel {
         test_utils::fill_random_pixels<gpu_types::float4>(dstBufferMap.get(), dstBufferMap.get() + mBufferWidth);
     }
 
+    vk::Extent3D Test::getExtent() const
+    {
+        return vk::Extent3D(mBufferWidth, 1, 1);
+    }
+
+    test_utils::Workload Test::getWorkload() const
+    {
+        // each pixel reads its index and source, and writes its destination; the index staged in
+        // local memory is not counted
+        test_utils::Workload result;
+        result.mBytesRead = static_cast<std::uint64_t>(mBufferWidth) * (sizeof(std::int32_t) + sizeof(gpu_types::float4));
+        result.mBytesWritten = static_cast<std::uint64_t>(mBufferWidth) * sizeof(gpu_types::float4);
+        return result;
+    }
+
     clspv_utils::execution_time_t Test::run(clspv_utils::kernel& kernel)
     {
         return invoke(kernel,
@@ -71,13 +88,10 @@ namespace strangeshuffle_kernel {
 
     test_utils::Evaluation Test::evaluate(bool verbose)
     {
-        auto srcBufferMap = mSrcBuffer.map<gpu_types::float4>();
-        auto dstBufferMap = mDstBuffer.map<gpu_types::float4>();
-        return test_utils::check_results(srcBufferMap.get(),
-                                         dstBufferMap.get(),
-                                         vk::Extent3D(mBufferWidth, 1, 1),
-                                         mBufferWidth,
-                                         verbose);
+        return test_utils::check_buffer_results<gpu_types::float4>(mSrcBuffer,
+                                                                   mDstBuffer,
+                                                                   vk::Extent3D(mBufferWidth, 1, 1),
+                                                                   verbose);
     }
 
 
@@ -48,11 +48,11 @@ namespace testgreaterthanorequalto_kernel {
     }
 
     Test::Test(clspv_utils::kernel& kernel, const std::vector<std::string>& args) :
-            mBufferExtent(64, 64, 1)
+            mBufferExtent(test_utils::read_extent_args(args, vk::Extent3D(64, 64, 1), 2, sizeof(float), kernel.getDevice(), "testgreaterthanorequalto"))
     {
         auto& device = kernel.getDevice();
 
-        const std::size_t buffer_length = mBufferExtent.width * mBufferExtent.height * mBufferExtent.depth;
+        const std::size_t buffer_length = test_utils::count_pixels(mBufferExtent);
         const std::size_t buffer_size = buffer_length * sizeof(float);
 
         // allocate buffers and images
@@ -73,7 +73,7 @@ namespace testgreaterthanorequalto_kernel {
 
     void Test::prepare()
     {
-        const std::size_t buffer_length = mBufferExtent.width * mBufferExtent.height * mBufferExtent.depth;
+        const std::size_t buffer_length = test_utils::count_pixels(mBufferExtent);
 
         // initialize destination memory with unexpected value. the kernel should write either 0 or
         // 1. so, initialize the destination with 2.
@@ -82,6 +82,18 @@ namespace testgreaterthanorequalto_kernel {
         dstBufferMap.reset();
     }
 
+    vk::Extent3D Test::getExtent() const
+    {
+        return mBufferExtent;
+    }
+
+    test_utils::Workload Test::getWorkload() const
+    {
+        test_utils::Workload result;
+        result.mBytesWritten = test_utils::count_pixels(mBufferExtent) * sizeof(float);
+        return result;
+    }
+
     clspv_utils::execution_time_t Test::run(clspv_utils::kernel& kernel)
     {
         return invoke(kernel,
@@ -0,0 +1,201 @@
+//
+// Created by Eric Berdahl on 5/18/18.
+//
+
+#include "random_utils.hpp"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define CLSPVTEST_RANDOM_SSE2 1
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define CLSPVTEST_RANDOM_NEON 1
+#endif
+
+namespace {
+    using namespace random_utils;
+
+    const std::uint32_t kPhiloxM0 = 0xD2511F53;
+    const std::uint32_t kPhiloxM1 = 0xCD9E8D57;
+    const std::uint32_t kPhiloxW0 = 0x9E3779B9;
+    const std::uint32_t kPhiloxW1 = 0xBB67AE85;
+    const int           kPhiloxRounds = 10;
+
+    // 24 random bits scaled into [0,1); every such value is exactly representable as a float
+    const float kUnitScale = 1.0f / 16777216.0f;
+
+    inline float to_unit_float(std::uint32_t bits) {
+        return static_cast<float>(bits >> 8) * kUnitScale;
+    }
+
+#if CLSPVTEST_RANDOM_SSE2
+    // Computes the 32-bit high and low halves of m * x for each lane
+    inline void mulhilo(__m128i x, __m128i m, __m128i* hi, __m128i* lo) {
+        const __m128i lowMask = _mm_set_epi32(0, -1, 0, -1);
+
+        const __m128i even = _mm_mul_epu32(x, m);
+        const __m128i odd = _mm_mul_epu32(_mm_srli_epi64(x, 32), m);
+
+        *lo = _mm_or_si128(_mm_and_si128(even, lowMask), _mm_slli_epi64(odd, 32));
+        *hi = _mm_or_si128(_mm_srli_epi64(even, 32), _mm_andnot_si128(lowMask, odd));
+    }
+
+    inline __m128 to_unit_floats(__m128i bits) {
+        return _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(bits, 8)), _mm_set1_ps(kUnitScale));
+    }
+
+    // generates counters [first, first + 4), one per lane
+    void uniform_floats_x4(const stream_t& stream, std::uint64_t first, float* out) {
+        const std::uint32_t firstLow = static_cast<std::uint32_t>(first);
+        const std::uint32_t firstHigh = static_cast<std::uint32_t>(first >> 32);
+
+        // the low word of the counter may carry into the high word part way through the group
+        __m128i c0 = _mm_add_epi32(_mm_set1_epi32(static_cast<int>(firstLow)), _mm_set_epi32(3, 2, 1, 0));
+        const __m128i carry = _mm_cmplt_epi32(_mm_xor_si128(c0, _mm_set1_epi32(static_cast<int>(0x80000000u))),
+                                              _mm_set1_epi32(static_cast<int>(firstLow ^ 0x80000000u)));
+        __m128i c1 = _mm_sub_epi32(_mm_set1_epi32(static_cast<int>(firstHigh)), carry);
+        __m128i c2 = _mm_set1_epi32(static_cast<int>(static_cast<std::uint32_t>(stream.mStream)));
+        __m128i c3 = _mm_set1_epi32(static_cast<int>(static_cast<std::uint32_t>(stream.mStream >> 32)));
+
+        std::uint32_t k0 = static_cast<std::uint32_t>(stream.mSeed);
+        std::uint32_t k1 = static_cast<std::uint32_t>(stream.mSeed >> 32);
+
+        const __m128i m0 = _mm_set1_epi32(static_cast<int>(kPhiloxM0));
+        const __m128i m1 = _mm_set1_epi32(static_cast<int>(kPhiloxM1));
+
+        for (int round = 0; round < kPhiloxRounds; ++round) {
+            if (round > 0) {
+                k0 += kPhiloxW0;
+                k1 += kPhiloxW1;
+            }
+
+            __m128i hi0, lo0, hi1, lo1;
+            mulhilo(c0, m0, &hi0, &lo0);
+            mulhilo(c2, m1, &hi1, &lo1);
+
+            c0 = _mm_xor_si128(_mm_xor_si128(hi1, c1), _mm_set1_epi32(static_cast<int>(k0)));
+            c1 = lo1;
+            c2 = _mm_xor_si128(_mm_xor_si128(hi0, c3), _mm_set1_epi32(static_cast<int>(k1)));
+            c3 = lo0;
+        }
+
+        __m128 x = to_unit_floats(c0);
+        __m128 y = to_unit_floats(c1);
+        __m128 z = to_unit_floats(c2);
+        __m128 w = to_unit_floats(c3);
+        _MM_TRANSPOSE4_PS(x, y, z, w);
+
+        _mm_storeu_ps(out + 0, x);
+        _mm_storeu_ps(out + 4, y);
+        _mm_storeu_ps(out + 8, z);
+        _mm_storeu_ps(out + 12, w);
+    }
+#elif CLSPVTEST_RANDOM_NEON
+    inline void mulhilo(uint32x4_t x, uint32_t m, uint32x4_t* hi, uint32x4_t* lo) {
+        const uint64x2_t low = vmull_n_u32(vget_low_u32(x), m);
+        const uint64x2_t high = vmull_high_n_u32(x, m);
+
+        // even words are the low halves of the products, odd words the high halves
+        const uint32x4x2_t parts = vuzpq_u32(vreinterpretq_u32_u64(low), vreinterpretq_u32_u64(high));
+        *lo = parts.val[0];
+        *hi = parts.val[1];
+    }
+
+    inline float32x4_t to_unit_floats(uint32x4_t bits) {
+        return vmulq_n_f32(vcvtq_f32_u32(vshrq_n_u32(bits, 8)), kUnitScale);
+    }
+
+    void uniform_floats_x4(const stream_t& stream, std::uint64_t first, float* out) {
+        const std::uint32_t lanes[4] = { 0, 1, 2, 3 };
+        const std::uint32_t firstLow = static_cast<std::uint32_t>(first);
+
+        // the low word of the counter may carry into the high word part way through the group
+        uint32x4_t c0 = vaddq_u32(vdupq_n_u32(firstLow), vld1q_u32(lanes));
+        uint32x4_t c1 = vsubq_u32(vdupq_n_u32(static_cast<std::uint32_t>(first >> 32)),
+                                  vcltq_u32(c0, vdupq_n_u32(firstLow)));
+        uint32x4_t c2 = vdupq_n_u32(static_cast<std::uint32_t>(stream.mStream));
+        uint32x4_t c3 = vdupq_n_u32(static_cast<std::uint32_t>(stream.mStream >> 32));
+
+        std::uint32_t k0 = static_cast<std::uint32_t>(stream.mSeed);
+        std::uint32_t k1 = static_cast<std::uint32_t>(stream.mSeed >> 32);
+
+        for (int round = 0; round < kPhiloxRounds; ++round) {
+            if (round > 0) {
+                k0 += kPhiloxW0;
+                k1 += kPhiloxW1;
+            }
+
+            uint32x4_t hi0, lo0, hi1, lo1;
+            mulhilo(c0, kPhiloxM0, &hi0, &lo0);
+            mulhilo(c2, kPhiloxM1, &hi1, &lo1);
+
+            c0 = veorq_u32(veorq_u32(hi1, c1), vdupq_n_u32(k0));
+            c1 = lo1;
+            c2 = veorq_u32(veorq_u32(hi0, c3), vdupq_n_u32(k1));
+            c3 = lo0;
+        }
+
+        // interleaving stores each counter's four values together
+        float32x4x4_t values;
+        values.val[0] = to_unit_floats(c0);
+        values.val[1] = to_unit_floats(c1);
+        values.val[2] = to_unit_floats(c2);
+        values.val[3] = to_unit_floats(c3);
+        vst4q_f32(out, values);
+    }
+#endif
+
+} // anonymous namespace
+
+namespace random_utils {
+
+    void philox4x32(const stream_t& stream, std::uint64_t counter, std::uint32_t out[4]) {
+        std::uint32_t c0 = static_cast<std::uint32_t>(counter);
+        std::uint32_t c1 = static_cast<std::uint32_t>(counter >> 32);
+        std::uint32_t c2 = static_cast<std::uint32_t>(stream.mStream);
+        std::uint32_t c3 = static_cast<std::uint32_t>(stream.mStream >> 32);
+
+        std::uint32_t k0 = static_cast<std::uint32_t>(stream.mSeed);
+        std::uint32_t k1 = static_cast<std::uint32_t>(stream.mSeed >> 32);
+
+        for (int round = 0; round < kPhiloxRounds; ++round) {
+            if (round > 0) {
+                k0 += kPhiloxW0;
+                k1 += kPhiloxW1;
+            }
+
+            const std::uint64_t p0 = static_cast<std::uint64_t>(kPhiloxM0) * c0;
+            const std::uint64_t p1 = static_cast<std::uint64_t>(kPhiloxM1) * c2;
+
+            c0 = static_cast<std::uint32_t>(p1 >> 32) ^ c1 ^ k0;
+            c1 = static_cast<std::uint32_t>(p1);
+            c2 = static_cast<std::uint32_t>(p0 >> 32) ^ c3 ^ k1;
+            c3 = static_cast<std::uint32_t>(p0);
+        }
+
+        out[0] = c0;
+        out[1] = c1;
+        out[2] = c2;
+        out[3] = c3;
+    }
+
+    void uniform_floats(const stream_t& stream, std::uint64_t first, std::size_t count, float* out) {
+        std::size_t i = 0;
+
+#if CLSPVTEST_RANDOM_SSE2 || CLSPVTEST_RANDOM_NEON
+        for (; i + 4 <= count; i += 4) {
+            uniform_floats_x4(stream, first + i, out + 4 * i);
+        }
+#endif
+
+        for (; i < count; ++i) {
+            std::uint32_t bits[4];
+            philox4x32(stream, first + i, bits);
+
+            for (int c = 0; c < 4; ++c) {
+                out[4 * i + c] = to_unit_float(bits[c]);
+            }
+        }
+    }
+
+}
@@ -0,0 +1,32 @@
+//
+// Created by Eric Berdahl on 5/18/18.
+//
+
+#ifndef CLSPVTEST_RANDOM_UTILS_HPP
+#define CLSPVTEST_RANDOM_UTILS_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace random_utils {
+
+    //
+    // Philox4x32-10 counter-based generator (Salmon et al., "Parallel Random Numbers: As Easy as
+    // 1, 2, 3"). Each (seed, stream, counter) triple maps to four independent 32-bit values, so any
+    // element of a sequence can be generated without generating those before it.
+    //
+
+    struct stream_t {
+        std::uint64_t   mSeed   = 0;
+        std::uint64_t   mStream = 0;
+    };
+
+    void philox4x32(const stream_t& stream, std::uint64_t counter, std::uint32_t out[4]);
+
+    // Writes 4 * count floats, uniformly distributed in [0,1). The four floats for counter
+    // (first + i) are written to out[4*i] through out[4*i + 3], and depend only on the stream and
+    // the counter.
+    void uniform_floats(const stream_t& stream, std::uint64_t first, std::size_t count, float* out);
+}
+
+#endif //CLSPVTEST_RANDOM_UTILS_HPP
@@ -0,0 +1,315 @@
+//
+// Created by Eric Berdahl on 5/18/18.
+//
+
+#include "results_sink.hpp"
+
+#include "benchmark_stats.hpp"
+#include "vulkan_utils/vulkan_utils.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+namespace {
+
+    struct field_t {
+        std::string mValue;
+        bool        mIsText;    // quoted in JSON; numbers and null are not
+    };
+
+    typedef std::vector<std::pair<std::string, field_t>> record_t;
+
+    // the timing components, in the order and units of the log
+    const char* const kTimeNames[] = { "wall_clock_s", "execution_ns", "host_barrier_ns", "gpu_barrier_ns" };
+
+    const char* const kStatNames[] = { "mean", "variance", "ci_low", "ci_high", "median", "p90", "p95", "p99", "min", "max", "outliers" };
+
+    const char* const kRecordColumns[] = {
+        "record", "module", "entry_point", "workgroup", "arguments", "sweep_size", "variation", "parameters",
+        "timing", "iteration", "iterations", "warmup_iterations", "result", "correct", "errors", "pass", "fail",
+        "skip", "compiled", "exception", "messages", "pixels", "bytes_read", "bytes_written", "operations",
+        "prepare_s", "descriptor_update_s", "record_s", "submit_s", "wait_s", "eval_s", "submission_latency_ns",
+        "completion_latency_ns", "calibration_error_ns"
+    };
+
+    void add_text(record_t& record, const std::string& name, const std::string& value) {
+        field_t f;
+        f.mValue = value;
+        f.mIsText = true;
+        record.push_back(std::make_pair(name, f));
+    }
+
+    template <typename T>
+    void add_number(record_t& record, const std::string& name, T value) {
+        field_t f;
+        f.mIsText = false;
+
+        const double asDouble = static_cast<double>(value);
+        if (std::isfinite(asDouble)) {
+            std::ostringstream os;
+            os << std::setprecision(10) << value;
+            f.mValue = os.str();
+        }
+        else {
+            f.mValue = "null";
+        }
+
+        record.push_back(std::make_pair(name, f));
+    }
+
+    std::string json_escape(const std::string& s) {
+        std::string result;
+        result.reserve(s.size() + 2);
+
+        for (char c : s) {
+            switch (c) {
+                case '"':   result += "\\\""; break;
+                case '\\':  result += "\\\\"; break;
+                case '\n':  result += "\\n"; break;
+                case '\r':  result += "\\r"; break;
+                case '\t':  result += "\\t"; break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20) {
+                        char escaped[8];
+                        std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned int>(static_cast<unsigned char>(c)));
+                        result += escaped;
+                    }
+                    else {
+                        result += c;
+                    }
+                    break;
+            }
+        }
+
+        return result;
+    }
+
+    std::string csv_escape(const std::string& s) {
+        if (std::string::npos == s.find_first_of(",\"\r\n")) return s;
+
+        std::string result = "\"";
+        for (char c : s) {
+            if ('"' == c) result += '"';
+            result += c;
+        }
+        result += '"';
+        return result;
+    }
+
+    std::vector<std::string> csv_columns() {
+        std::vector<std::string> result(std::begin(kRecordColumns), std::end(kRecordColumns));
+
+        for (auto time : kTimeNames) {
+            result.push_back(time);
+        }
+        for (auto time : kTimeNames) {
+            for (auto stat : kStatNames) {
+                result.push_back(std::string(time) + "_" + stat);
+            }
+        }
+
+        return result;
+    }
+
+    std::string join(const std::vector<std::string>& strings, const char* separator) {
+        std::string result;
+        for (const auto& s : strings) {
+            if (!result.empty()) result += separator;
+            result += s;
+        }
+        return result;
+    }
+
+    std::string extent_string(const vk::Extent3D& extent) {
+        std::ostringstream os;
+        os << extent.width << "x" << extent.height << "x" << extent.depth;
+        return os.str();
+    }
+
+    const char* timing_string(const test_utils::KernelTest& kernelTest) {
+        if (0 == kernelTest.mTimingIterations) return "correctness";
+        return (test_utils::KernelTest::timing_throughput == kernelTest.mTiming ? "throughput" : "per_submission");
+    }
+
+    // the fields which identify the kernel test a record belongs to
+    void add_kernel_identity(record_t&                          record,
+                             const char*                        recordType,
+                             const test_utils::ModuleTest&      moduleTest,
+                             const test_utils::KernelTest&      kernelTest) {
+        add_text(record, "record", recordType);
+        add_text(record, "module", moduleTest.mName);
+        add_text(record, "entry_point", kernelTest.mEntryName);
+        add_text(record, "workgroup", extent_string(kernelTest.mWorkgroupSize));
+        add_text(record, "arguments", join(kernelTest.mArguments, " "));
+        if (!kernelTest.mSweepSize.empty()) {
+            add_text(record, "sweep_size", kernelTest.mSweepSize);
+        }
+        add_text(record, "timing", timing_string(kernelTest));
+    }
+
+    // pass, fail or skip, by the same rule as the log
+    const char* invocation_result(const test_utils::InvocationResult& ir) {
+        if (ir.mEvaluation.mSkipped) return "skip";
+        return (ir.mEvaluation.mNumCorrect > 0 && ir.mEvaluation.mNumErrors == 0 ? "pass" : "fail");
+    }
+
+    void add_stats(record_t& record, const std::string& time, const benchmark_stats::summary_t& stats) {
+        add_number(record, time + "_mean", stats.mMean);
+        add_number(record, time + "_variance", stats.mVariance);
+        add_number(record, time + "_ci_low", stats.mMeanLow);
+        add_number(record, time + "_ci_high", stats.mMeanHigh);
+        add_number(record, time + "_median", stats.mMedian);
+        add_number(record, time + "_p90", stats.mP90);
+        add_number(record, time + "_p95", stats.mP95);
+        add_number(record, time + "_p99", stats.mP99);
+        add_number(record, time + "_min", stats.mMin);
+        add_number(record, time + "_max", stats.mMax);
+        add_number(record, time + "_outliers", stats.mNumOutliers);
+    }
+
+    void write_record(std::ostream& os, results_sink::format recordFormat, const record_t& record) {
+        if (results_sink::format_jsonl == recordFormat) {
+            os << '{';
+            for (std::size_t i = 0; i < record.size(); ++i) {
+                if (i > 0) os << ',';
+                os << '"' << json_escape(record[i].first) << "\":";
+                if (record[i].second.mIsText) {
+                    os << '"' << json_escape(record[i].second.mValue) << '"';
+                }
+                else {
+                    os << record[i].second.mValue;
+                }
+            }
+            os << "}\n";
+        }
+        else {
+            static const std::vector<std::string> columns = csv_columns();
+
+            std::map<std::string, const field_t*> byName;
+            for (const auto& f : record) {
+                byName[f.first] = &f.second;
+            }
+
+            for (std::size_t i = 0; i < columns.size(); ++i) {
+                if (i > 0) os << ',';
+
+                auto found = byName.find(columns[i]);
+                if (found != byName.end() && (found->second->mIsText || "null" != found->second->mValue)) {
+                    os << csv_escape(found->second->mValue);
+                }
+            }
+            os << '\n';
+        }
+    }
+
+} // anonymous namespace
+
+namespace results_sink {
+
+    writer::writer(const std::string&                   path,
+                   format                               recordFormat,
+                   const vk::PhysicalDeviceProperties&  deviceProperties,
+                   const vk::QueueFamilyProperties&     queueFamilyProperties) :
+        mOut(path, std::ios::out | std::ios::trunc),
+        mFormat(recordFormat),
+        mDeviceProperties(deviceProperties),
+        mQueueFamilyProperties(queueFamilyProperties)
+    {
+        if (format_csv == mFormat && mOut) {
+            std::vector<std::string> header = csv_columns();
+            std::transform(header.begin(), header.end(), header.begin(), csv_escape);
+            mOut << join(header, ",") << '\n';
+            mOut.flush();
+        }
+    }
+
+    void writer::writeKernel(const test_utils::ModuleTest& moduleTest, const test_utils::KernelTest::result& kernelResult) {
+        const test_utils::KernelTest& kernelTest = *kernelResult.first;
+        const test_utils::KernelResult& result = kernelResult.second;
+
+        std::vector<double> times[4];
+        unsigned int counts[3] = { 0, 0, 0 };  // pass, fail, skip
+
+        for (std::size_t iteration = 0; iteration < result.mInvocationResults.size(); ++iteration) {
+            const test_utils::InvocationTest& invocationTest = *result.mInvocationResults[iteration].first;
+            const test_utils::InvocationResult& ir = result.mInvocationResults[iteration].second;
+            const auto& timestamps = ir.mExecutionTime.timestamps;
+
+            const double invocationTimes[4] = {
+                ir.mExecutionTime.cpu_duration.count(),
+                vulkan_utils::timestamp_delta_ns(timestamps.host_barrier, timestamps.execution, mDeviceProperties, mQueueFamilyProperties),
+                vulkan_utils::timestamp_delta_ns(timestamps.start, timestamps.host_barrier, mDeviceProperties, mQueueFamilyProperties),
+                vulkan_utils::timestamp_delta_ns(timestamps.execution, timestamps.gpu_barrier, mDeviceProperties, mQueueFamilyProperties)
+            };
+
+            const char* outcome = invocation_result(ir);
+            ++counts[('p' == outcome[0] ? 0 : ('f' == outcome[0] ? 1 : 2))];
+
+            record_t record;
+            add_kernel_identity(record, "invocation", moduleTest, kernelTest);
+            add_text(record, "variation", invocationTest.mVariation);
+            add_text(record, "parameters", ir.mParameters);
+            add_number(record, "iteration", iteration);
+            add_text(record, "result", outcome);
+            add_number(record, "correct", ir.mEvaluation.mNumCorrect);
+            add_number(record, "errors", ir.mEvaluation.mNumErrors);
+            if (!ir.mEvaluation.mMessages.empty()) {
+                add_text(record, "messages", join(ir.mEvaluation.mMessages, "; "));
+            }
+            add_number(record, "pixels", ir.mNumPixels);
+            for (int t = 0; t < 4; ++t) {
+                add_number(record, kTimeNames[t], invocationTimes[t]);
+                times[t].push_back(invocationTimes[t]);
+            }
+            add_number(record, "prepare_s", ir.mPrepareTime.count());
+            add_number(record, "descriptor_update_s", ir.mExecutionTime.descriptor_update_duration.count());
+            add_number(record, "record_s", ir.mExecutionTime.record_duration.count());
+            add_number(record, "submit_s", ir.mExecutionTime.submit_duration.count());
+            add_number(record, "wait_s", ir.mExecutionTime.wait_duration.count());
+            add_number(record, "eval_s", ir.mEvalTime.count());
+            if (ir.mExecutionTime.has_latency) {
+                add_number(record, "submission_latency_ns", ir.mExecutionTime.submission_latency.count() * 1.0e9);
+                add_number(record, "completion_latency_ns", ir.mExecutionTime.completion_latency.count() * 1.0e9);
+                add_number(record, "calibration_error_ns", ir.mExecutionTime.calibration_error.count() * 1.0e9);
+            }
+
+            write_record(mOut, mFormat, record);
+        }
+
+        record_t record;
+        add_kernel_identity(record, "kernel", moduleTest, kernelTest);
+        add_number(record, "iterations", result.mInvocationResults.size());
+        add_number(record, "warmup_iterations", kernelTest.mWarmupIterations);
+        add_number(record, "pass", counts[0]);
+        add_number(record, "fail", counts[1]);
+        add_number(record, "skip", counts[2]);
+        add_text(record, "compiled", result.mSkipped ? "skipped" : (result.mCompiledCorrectly ? "yes" : "no"));
+        if (!result.mExceptionString.empty()) {
+            add_text(record, "exception", result.mExceptionString);
+        }
+
+        if (!result.mInvocationResults.empty()) {
+            const test_utils::InvocationResult& first = result.mInvocationResults.front().second;
+            add_number(record, "pixels", first.mNumPixels);
+            add_number(record, "bytes_read", first.mWorkload.mBytesRead);
+            add_number(record, "bytes_written", first.mWorkload.mBytesWritten);
+            add_number(record, "operations", first.mWorkload.mOperations);
+        }
+
+        if (kernelTest.mTimingIterations > 0 && !result.mInvocationResults.empty()) {
+            for (int t = 0; t < 4; ++t) {
+                add_stats(record, kTimeNames[t], benchmark_stats::summarize(std::move(times[t])));
+            }
+        }
+
+        write_record(mOut, mFormat, record);
+        mOut.flush();
+    }
+
+}
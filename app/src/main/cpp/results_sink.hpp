@@ -0,0 +1,51 @@
+//
+// Created by Eric Berdahl on 5/18/18.
+//
+
+#ifndef CLSPVTEST_RESULTS_SINK_HPP
+#define CLSPVTEST_RESULTS_SINK_HPP
+
+#include "test_utils.hpp"
+
+#include <vulkan/vulkan.hpp>
+
+#include <fstream>
+#include <string>
+
+namespace results_sink {
+
+    enum format {
+        format_jsonl,   // one JSON object per line
+        format_csv      // one row per record, under a header naming every field
+    };
+
+    //
+    // Writes machine readable results as tests complete. Each kernel test produces one record per
+    // invocation, followed by one summarizing the kernel, with pass/fail counts and statistics of
+    // every timing component. Records are written and flushed as they are made, and nothing is kept
+    // afterwards, so a long run costs no memory here and a crash loses at most the kernel under way.
+    //
+    class writer {
+    public:
+                    writer(const std::string&                   path,
+                           format                               recordFormat,
+                           const vk::PhysicalDeviceProperties&  deviceProperties,
+                           const vk::QueueFamilyProperties&     queueFamilyProperties);
+
+                    writer(const writer&) = delete;
+
+        writer&     operator=(const writer&) = delete;
+
+        bool        is_open() const { return mOut.is_open() && mOut.good(); }
+
+        void        writeKernel(const test_utils::ModuleTest& moduleTest, const test_utils::KernelTest::result& kernelResult);
+
+    private:
+        std::ofstream                   mOut;
+        format                          mFormat;
+        vk::PhysicalDeviceProperties    mDeviceProperties;
+        vk::QueueFamilyProperties       mQueueFamilyProperties;
+    };
+}
+
+#endif //CLSPVTEST_RESULTS_SINK_HPP
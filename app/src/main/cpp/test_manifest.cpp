@@ -5,6 +5,12 @@
 #include "test_manifest.hpp"
 
 #include "clspv_utils/interface.hpp"
+#include "clspv_utils/module_cache.hpp"
+
+#include "expected_cache.hpp"
+#include "file_utils.hpp"
+#include "results_sink.hpp"
+#include "trace_events.hpp"
 
 #include "kernel_tests/copybuffertoimage_kernel.hpp"
 #include "kernel_tests/copyimagetobuffer_kernel.hpp"
@@ -19,14 +25,22 @@
 #include "kernel_tests/strangeshuffle_kernel.hpp"
 #include "kernel_tests/testgreaterthanorequalto_kernel.hpp"
 
-#include "crlf_savvy.hpp"
-#include "file_utils.hpp"
 #include "util.hpp" // for LOGxx macros
 
+#include <algorithm>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <random>
+
 namespace
 {
     using namespace test_manifest;
 
+    // adaptive timing runs at least this many iterations, and stops after this long by default
+    const unsigned int  kFirstAdaptiveBatch     = 10;
+    const double        kDefaultTimeBudget_s    = 10.0;
+
     typedef test_utils::KernelTest::invocation_tests (series_gen_signature)();
 
     typedef std::function<series_gen_signature>  series_gen_fn;
@@ -77,10 +91,35 @@ namespace
         return result;
     }
 
-    void read_module_op(std::istream& is, manifest_t& manifest)
+    std::uint64_t random_seed()
+    {
+        std::random_device rd;
+        return (static_cast<std::uint64_t>(rd()) << 32) | rd();
+    }
+
+    bool uses_verification(const manifest_t& manifest, test_utils::KernelTest::verification verification)
+    {
+        for (auto& m : manifest.tests)
+        {
+            for (auto& k : m.mKernelTests)
+            {
+                if (verification == k.mVerification)
+                {
+                    return true;
+                }
+            }
+        }
+
+        return false;
+    }
+
+    void read_module_op(std::istream&                           is,
+                        manifest_t&                             manifest,
+                        test_utils::ModuleTest::reflection      reflection)
     {
         // add module to list of modules to load
         test_utils::ModuleTest moduleEntry;
+        moduleEntry.mReflection = reflection;
         is >> moduleEntry.mName;
 
         manifest.tests.push_back(moduleEntry);
@@ -122,6 +161,182 @@ namespace
         }
     }
 
+    void read_expectedcache_op(std::istream& is, manifest_t& manifest)
+    {
+        // keep expected results computed on the CPU between runs
+        std::string on_off;
+        is >> on_off;
+
+        if (on_off == "on")
+        {
+            manifest.use_expected_cache = true;
+        }
+        else if (on_off == "off")
+        {
+            manifest.use_expected_cache = false;
+        }
+        else
+        {
+            throw std::runtime_error("unrecognized expectedCache value");
+        }
+    }
+
+    void read_results_op(std::istream& is, manifest_t& manifest)
+    {
+        // stream machine readable results to a file as tests complete
+        std::string format;
+        is >> format;
+
+        if (format == "off")
+        {
+            manifest.write_results = false;
+        }
+        else if (format == "jsonl")
+        {
+            manifest.write_results = true;
+            manifest.results_format = results_sink::format_jsonl;
+        }
+        else if (format == "csv")
+        {
+            manifest.write_results = true;
+            manifest.results_format = results_sink::format_csv;
+        }
+        else
+        {
+            throw std::runtime_error("unrecognized results value");
+        }
+    }
+
+    void read_trace_op(std::istream& is, manifest_t& manifest)
+    {
+        // record a timeline of the run for chrome://tracing or Perfetto
+        std::string on_off;
+        is >> on_off;
+
+        if (on_off == "on")
+        {
+            manifest.write_trace = true;
+        }
+        else if (on_off == "off")
+        {
+            manifest.write_trace = false;
+        }
+        else
+        {
+            throw std::runtime_error("unrecognized trace value");
+        }
+    }
+
+    void read_baseline_op(std::istream& is, manifest_t& manifest)
+    {
+        // compare timings against those of a previous run's results file
+        std::string path;
+        is >> path;
+        if (path.empty())
+        {
+            throw std::runtime_error("baseline requires a results file");
+        }
+
+        manifest.baseline_path = path;
+
+        std::string threshold;
+        is >> threshold;
+        if (!threshold.empty())
+        {
+            std::istringstream threshold_is(threshold);
+            double percent = 0.0;
+            if (!(threshold_is >> percent) || threshold_is.get() != '%' || percent < 0.0)
+            {
+                throw std::runtime_error("unrecognized baseline threshold " + threshold);
+            }
+
+            manifest.regression_threshold = percent / 100.0;
+        }
+    }
+
+    void read_warmup_op(std::istream& is, test_utils::KernelTest& testDefaults)
+    {
+        // iterations subsequent timing tests run before those they report
+        int num_iterations = -1;
+        is >> num_iterations;
+        if (!is || num_iterations < 0)
+        {
+            throw std::runtime_error("unrecognized warmup value");
+        }
+
+        testDefaults.mWarmupIterations = num_iterations;
+    }
+
+    void read_evalthreads_op(std::istream& is, manifest_t& manifest)
+    {
+        // number of host threads used to check test results
+        std::string num_threads;
+        is >> num_threads;
+
+        if (num_threads == "auto")
+        {
+            manifest.evaluation_threads = 0;
+        }
+        else
+        {
+            std::istringstream num_is(num_threads);
+            unsigned int n = 0;
+            if (!(num_is >> n) || !num_is.eof() || 0 == n)
+            {
+                throw std::runtime_error("unrecognized evalThreads value");
+            }
+
+            manifest.evaluation_threads = n;
+        }
+    }
+
+    void read_seed_op(std::istream& is, manifest_t& manifest)
+    {
+        // seed for the random inputs tests generate
+        std::string seed;
+        is >> seed;
+
+        if (seed == "random")
+        {
+            manifest.random_seed = random_seed();
+            manifest.fixed_seed = false;
+        }
+        else
+        {
+            std::istringstream seed_is(seed);
+            std::uint64_t n = 0;
+            if (!(seed_is >> n) || !seed_is.eof())
+            {
+                throw std::runtime_error("unrecognized seed value");
+            }
+
+            manifest.random_seed = n;
+            manifest.fixed_seed = true;
+        }
+    }
+
+    test_utils::ModuleTest::reflection read_reflection_op(std::istream& is)
+    {
+        // choose how subsequent modules derive their interface
+        std::string mode;
+        is >> mode;
+
+        if (mode == "off")
+        {
+            return test_utils::ModuleTest::reflection_off;
+        }
+        else if (mode == "on")
+        {
+            return test_utils::ModuleTest::reflection_on;
+        }
+        else if (mode == "verify")
+        {
+            return test_utils::ModuleTest::reflection_verify;
+        }
+
+        throw std::runtime_error("unrecognized reflection value");
+    }
+
     bool read_verbosity_op(std::istream& is)
     {
         bool result = false;
@@ -146,6 +361,43 @@ namespace
         return result;
     }
 
+    void read_verify_op(std::istream& is, test_utils::KernelTest& testDefaults)
+    {
+        // choose where subsequent tests compare their results
+        std::string mode;
+        is >> mode;
+
+        unsigned int numSamples = 0;
+        if (mode == "full")
+        {
+            testDefaults.mVerification = test_utils::KernelTest::verification_full;
+        }
+        else if (mode == "device")
+        {
+            testDefaults.mVerification = test_utils::KernelTest::verification_device;
+        }
+        else if (mode == "golden")
+        {
+            testDefaults.mVerification = test_utils::KernelTest::verification_golden;
+        }
+        else if (mode == "sampled")
+        {
+            is >> numSamples;
+            if (!is || 0 == numSamples)
+            {
+                throw std::runtime_error("sampled verification requires a positive number of samples");
+            }
+
+            testDefaults.mVerification = test_utils::KernelTest::verification_sampled;
+        }
+        else
+        {
+            throw std::runtime_error("unrecognized verify value");
+        }
+
+        testDefaults.mVerificationSamples = numSamples;
+    }
+
     test_utils::KernelTest::test_arguments read_test_args(std::istream& is)
     {
         test_utils::KernelTest::test_arguments result;
@@ -184,18 +436,18 @@ namespace
         }
     }
 
-    void read_test_op(std::istream&         is,
-                      const std::string&    op,
-                      manifest_t&           manifest,
-                      bool                  verbose)
+    void read_test_op(std::istream&                    is,
+                      const std::string&               op,
+                      manifest_t&                      manifest,
+                      const test_utils::KernelTest&    testDefaults)
     {
         if (manifest.tests.empty())
         {
             throw std::runtime_error("no module for test");
         }
 
-        test_utils::KernelTest testEntry;
-        testEntry.mIsVerbose = verbose;
+        // starts with the settings of earlier verbosity and verify verbs
+        test_utils::KernelTest testEntry = testDefaults;
 
         std::string testName;
         is >> testEntry.mEntryName
@@ -219,27 +471,94 @@ namespace
         manifest.tests.back().mKernelTests.push_back(testEntry);
     }
 
-    void read_time_op(std::istream&         is,
-                      const std::string&    op,
-                      manifest_t&           manifest,
-                      bool                  verbose)
+    // Reads "target% [budget-s]", the part of an adaptive timing verb that follows auto, and
+    // returns the token after it
+    std::string read_adaptive_timing(std::istream& is, test_utils::KernelTest& testEntry)
+    {
+        std::string precision;
+        is >> precision;
+
+        std::istringstream precision_is(precision);
+        double percent = 0.0;
+        if (!(precision_is >> percent) || precision_is.get() != '%' || percent <= 0.0)
+        {
+            throw std::runtime_error("adaptive timing requires a target precision such as 2%");
+        }
+
+        testEntry.mTargetPrecision = percent / 100.0;
+        testEntry.mTimeBudget_s = kDefaultTimeBudget_s;
+        testEntry.mTimingIterations = kFirstAdaptiveBatch;
+
+        // the budget is optional, and told apart from what follows by its unit
+        std::string next;
+        is >> next;
+        if (!next.empty() && next.back() == 's')
+        {
+            std::istringstream budget_is(next);
+            if (!(budget_is >> testEntry.mTimeBudget_s) || budget_is.get() != 's' || testEntry.mTimeBudget_s <= 0.0)
+            {
+                throw std::runtime_error("unrecognized adaptive timing budget " + next);
+            }
+
+            next.clear();
+            is >> next;
+        }
+
+        return next;
+    }
+
+    // Reads the iteration count of a timing verb, either num-iterations or "auto target% [budget-s]",
+    // and returns the token after it
+    std::string read_timing_iterations(std::istream& is, test_utils::KernelTest& testEntry)
+    {
+        std::string iterations;
+        is >> iterations;
+
+        if (iterations == "auto")
+        {
+            return read_adaptive_timing(is, testEntry);
+        }
+
+        std::istringstream iterations_is(iterations);
+        iterations_is >> testEntry.mTimingIterations;
+
+        std::string next;
+        is >> next;
+        return next;
+    }
+
+    void read_time_op(std::istream&                    is,
+                      const std::string&               op,
+                      manifest_t&                      manifest,
+                      const test_utils::KernelTest&    testDefaults)
     {
         if (manifest.tests.empty())
         {
             throw std::runtime_error("no module for test");
         }
 
-        test_utils::KernelTest testEntry;
-        testEntry.mIsVerbose = verbose;
+        // starts with the settings of earlier verbosity, verify and warmup verbs
+        test_utils::KernelTest testEntry = testDefaults;
 
         std::string testName;
         is >> testEntry.mEntryName
-           >> testName
-           >> testEntry.mTimingIterations
-           >> testEntry.mWorkgroupSize.width
-           >> testEntry.mWorkgroupSize.height
+           >> testName;
+
+        std::istringstream width_is(read_timing_iterations(is, testEntry));
+        width_is >> testEntry.mWorkgroupSize.width;
+
+        is >> testEntry.mWorkgroupSize.height
            >> testEntry.mWorkgroupSize.depth;
 
+        if (op == "throughput")
+        {
+            testEntry.mTiming = test_utils::KernelTest::timing_throughput;
+        }
+        else if (op == "calibrate")
+        {
+            testEntry.mIsCalibration = true;
+        }
+
         testEntry.mArguments = read_test_args(is);
         testEntry.mInvocationTests = lookup_test_series(testName);
 
@@ -252,24 +571,177 @@ namespace
         manifest.tests.back().mKernelTests.push_back(testEntry);
     }
 
-    void ensure_all_entries_tested(test_utils::ModuleTest& moduleTest)
+    // Reads "WxHxD", with trailing dimensions optional
+    std::vector<std::uint64_t> read_sweep_extent(const std::string& token)
+    {
+        std::vector<std::uint64_t> result;
+
+        std::istringstream is(token);
+        do
+        {
+            std::uint64_t dimension = 0;
+            if (!(is >> dimension) || 0 == dimension)
+            {
+                throw std::runtime_error("bad sweep extent " + token);
+            }
+            result.push_back(dimension);
+        } while (result.size() < 3 && is.get() == 'x');
+
+        if (!is.eof() || result.size() > 3)
+        {
+            throw std::runtime_error("bad sweep extent " + token);
+        }
+
+        return result;
+    }
+
+    //
+    // Reads a comma separated list of extents. An entry "first..last" stands for first and the
+    // extents reached by doubling each of its dimensions, up to the corresponding one of last.
+    //
+    std::vector<std::vector<std::uint64_t>> read_sweep_extents(const std::string& token)
+    {
+        std::vector<std::vector<std::uint64_t>> result;
+
+        std::istringstream is(token);
+        std::string entry;
+        while (std::getline(is, entry, ','))
+        {
+            const auto range = entry.find("..");
+            if (std::string::npos == range)
+            {
+                result.push_back(read_sweep_extent(entry));
+                continue;
+            }
+
+            auto extent = read_sweep_extent(entry.substr(0, range));
+            const auto last = read_sweep_extent(entry.substr(range + 2));
+            if (extent.size() != last.size() || !std::equal(extent.begin(), extent.end(), last.begin(), std::less_equal<std::uint64_t>()))
+            {
+                throw std::runtime_error("bad sweep range " + entry);
+            }
+
+            for (;;)
+            {
+                result.push_back(extent);
+                if (extent == last) break;
+
+                for (std::size_t d = 0; d < extent.size(); ++d)
+                {
+                    extent[d] = std::min(2 * extent[d], last[d]);
+                }
+            }
+        }
+
+        if (result.empty())
+        {
+            throw std::runtime_error("empty sweep list " + token);
+        }
+
+        return result;
+    }
+
+    std::string sweep_extent_string(const std::vector<std::uint64_t>& extent)
     {
-        file_utils::AndroidAssetStream spvmapStream(moduleTest.mName + ".spvmap");
-        if (!spvmapStream.good())
+        std::ostringstream os;
+        for (std::size_t d = 0; d < extent.size(); ++d)
         {
-            throw std::runtime_error("cannot open module interface for " + moduleTest.mName);
+            os << (d > 0 ? "x" : "") << extent[d];
+        }
+        return os.str();
+    }
+
+    void read_sweep_op(std::istream&                    is,
+                       manifest_t&                      manifest,
+                       const test_utils::KernelTest&    testDefaults)
+    {
+        if (manifest.tests.empty())
+        {
+            throw std::runtime_error("no module for test");
+        }
+
+        // starts with the settings of earlier verbosity, verify and warmup verbs
+        test_utils::KernelTest testEntry = testDefaults;
+
+        std::string testName;
+        is >> testEntry.mEntryName
+           >> testName;
+
+        const auto sizes = read_sweep_extents(read_timing_iterations(is, testEntry));
+
+        std::string workgroupList;
+        is >> workgroupList;
+        const auto workgroupSizes = read_sweep_extents(workgroupList);
+
+        const auto arguments = read_test_args(is);
+        testEntry.mInvocationTests = lookup_test_series(testName);
+        testEntry.mSweep = testEntry.mEntryName + " " + testName;
+
+        if (0 >= testEntry.mTimingIterations)
+        {
+            throw std::runtime_error("illegal iteration count requested");
         }
 
-        // spvmap files may have been generated on a system which uses different line ending
-        // conventions than the system on which the consumer runs. Safer to fetch lines
-        // using a function which recognizes multiple line endings.
-        crlf_savvy::crlf_filter_buffer filter(spvmapStream.rdbuf());
-        spvmapStream.rdbuf(&filter);
+        const char* const sizeOptions[] = { "-w", "-h", "-d" };
+
+        for (const auto& workgroupSize : workgroupSizes)
+        {
+            for (const auto& size : sizes)
+            {
+                test_utils::KernelTest point = testEntry;
+
+                point.mWorkgroupSize = vk::Extent3D(1, 1, 1);
+                std::uint32_t* const workgroupDimensions[] = { &point.mWorkgroupSize.width, &point.mWorkgroupSize.height, &point.mWorkgroupSize.depth };
+                for (std::size_t d = 0; d < workgroupSize.size(); ++d)
+                {
+                    *workgroupDimensions[d] = static_cast<std::uint32_t>(std::min<std::uint64_t>(workgroupSize[d], std::numeric_limits<std::uint32_t>::max()));
+                }
+
+                point.mArguments = arguments;
+                for (std::size_t d = 0; d < size.size(); ++d)
+                {
+                    point.mArguments.push_back(sizeOptions[d]);
+                    point.mArguments.push_back(std::to_string(size[d]));
+                }
+                point.mSweepSize = sweep_extent_string(size);
+
+                validate_kernel_test(point, testName);
+
+                manifest.tests.back().mKernelTests.push_back(point);
+            }
+        }
+    }
+
+    void ensure_all_entries_tested(test_utils::ModuleTest&      moduleTest,
+                                   clspv_utils::module_cache&   moduleCache)
+    {
+        //
+        // The interface stays in the cache, so loading the module later does not derive it a
+        // second time. A reflected interface is derived as test_module will, from the SPIR-V.
+        //
+        // Errors deriving it are left for test_module to report against the module, rather than
+        // failing the whole manifest here, so the spvmap's own entry points are used instead.
+        //
+        clspv_utils::module::spec_ptr moduleInterface;
+        if (test_utils::ModuleTest::reflection_on == moduleTest.mReflection)
+        {
+            try
+            {
+                std::vector<std::uint32_t> spvWords;
+                file_utils::read_file_contents(moduleTest.mName + ".spv", spvWords);
+                moduleInterface = test_utils::get_module_spec(moduleTest, moduleCache, spvWords);
+            }
+            catch (const std::exception&)
+            {
+            }
+        }
 
-        clspv_utils::module_spec_t moduleInterface = clspv_utils::createModuleSpec(spvmapStream);
-        spvmapStream.close();
+        if (!moduleInterface)
+        {
+            moduleInterface = test_utils::load_module_spec(moduleTest.mName, moduleCache);
+        }
 
-        for (auto& entryPoint : getEntryPointNames(moduleInterface.mKernels))
+        for (auto& entryPoint : getEntryPointNames(moduleInterface->mKernels))
         {
             auto found = std::find_if(moduleTest.mKernelTests.begin(), moduleTest.mKernelTests.end(),
                          [&entryPoint](const test_utils::KernelTest& kt) {
@@ -297,11 +769,123 @@ namespace test_manifest
     {
         test_manifest::results results;
 
+        clspv_utils::module_cache localCache;
+        clspv_utils::module_cache& moduleCache = (manifest.modules ? *manifest.modules : localCache);
+
+        test_utils::set_evaluation_threads(manifest.evaluation_threads);
+
+        // the seed is logged so that a run can be reproduced by adding it to the manifest
+        test_utils::set_random_seed(manifest.random_seed);
+        LOGI("%s: random seed %llu", __func__, static_cast<unsigned long long>(manifest.random_seed));
+
+        if (uses_verification(manifest, test_utils::KernelTest::verification_device))
+        {
+            try
+            {
+                test_utils::set_device_verifier(std::make_shared<device_verify::verifier>(inDevice, moduleCache));
+            }
+            catch (const std::exception& e)
+            {
+                // tests requesting device verification fall back to comparing on the host
+                LOGE("%s: cannot load verification kernels: %s", __func__, e.what());
+            }
+        }
+
+        if (manifest.use_expected_cache)
+        {
+            try
+            {
+                expected_cache::set_directory(std::string(AndroidGetInternalDataPath()) + "/expected");
+            }
+            catch (const std::exception& e)
+            {
+                // tests compute their expected results every time
+                LOGE("%s: %s", __func__, e.what());
+            }
+        }
+
+        const bool usesGolden = uses_verification(manifest, test_utils::KernelTest::verification_golden);
+        const std::string goldenPath = std::string(AndroidGetInternalDataPath()) + "/golden_hashes.txt";
+        if (usesGolden)
+        {
+            std::ifstream in(goldenPath);
+            test_utils::read_golden_hashes(in);
+
+            if (!manifest.fixed_seed)
+            {
+                LOGW("%s: golden hashes of tests with random inputs only match between runs with a fixed seed", __func__);
+            }
+        }
+
+        std::shared_ptr<results_sink::writer> resultsWriter;
+        if (manifest.write_results)
+        {
+            const bool isCsv = (results_sink::format_csv == manifest.results_format);
+            const std::string resultsPath = std::string(AndroidGetInternalDataPath()) + (isCsv ? "/results.csv" : "/results.jsonl");
+            // timestamps are converted for the queue family the device runs its tests on
+            resultsWriter = std::make_shared<results_sink::writer>(resultsPath,
+                                                                   manifest.results_format,
+                                                                   inDevice.getProperties(),
+                                                                   inDevice.getComputeQueueFamilyProperties());
+
+            if (resultsWriter->is_open())
+            {
+                LOGI("%s: writing results to %s", __func__, resultsPath.c_str());
+                test_utils::set_kernel_observer(std::bind(&results_sink::writer::writeKernel,
+                                                          resultsWriter,
+                                                          std::placeholders::_1,
+                                                          std::placeholders::_2));
+            }
+            else
+            {
+                LOGE("%s: cannot write results to %s", __func__, resultsPath.c_str());
+            }
+        }
+
+        trace_events::set_enabled(manifest.write_trace);
+
         for (auto& m : manifest.tests)
         {
-            results.push_back(test_utils::test_module(inDevice, m));
+            results.push_back(test_utils::test_module(inDevice, m, moduleCache));
+        }
+
+        test_utils::set_kernel_observer(nullptr);
+
+        if (manifest.write_trace)
+        {
+            trace_events::set_enabled(false);
+
+            const std::string tracePath = std::string(AndroidGetInternalDataPath()) + "/trace.json";
+            std::ofstream out(tracePath);
+            trace_events::write(out);
+            if (out)
+            {
+                LOGI("%s: wrote trace to %s", __func__, tracePath.c_str());
+            }
+            else
+            {
+                LOGE("%s: cannot write trace to %s", __func__, tracePath.c_str());
+            }
+        }
+
+        if (usesGolden)
+        {
+            std::ofstream out(goldenPath);
+            test_utils::write_golden_hashes(out);
+            if (!out)
+            {
+                LOGE("%s: cannot write golden hashes to %s", __func__, goldenPath.c_str());
+            }
         }
 
+        expected_cache::set_directory(std::string());
+
+        // The verifier holds shader objects from the module cache, so release it first.
+        test_utils::set_device_verifier(nullptr);
+
+        // The manifest may outlive the device, so don't leave Vulkan objects behind in its cache.
+        moduleCache.releaseDeviceObjects(inDevice.getDevice());
+
         return results;
     }
 
@@ -314,8 +898,11 @@ namespace test_manifest
     manifest_t read(std::istream &in)
     {
         manifest_t result;
+        result.modules = std::make_shared<clspv_utils::module_cache>();
+        result.random_seed = random_seed();
         unsigned int iterations = 1;
-        bool verbose = false;
+        test_utils::KernelTest testDefaults;
+        test_utils::ModuleTest::reflection reflection = test_utils::ModuleTest::reflection_off;
 
         while (!in.eof())
         {
@@ -334,15 +921,19 @@ namespace test_manifest
                 }
                 else if (op == "module")
                 {
-                    read_module_op(in_line, result);
+                    read_module_op(in_line, result, reflection);
                 }
                 else if (op == "test" || op == "test2d" || op == "test3d")
                 {
-                    read_test_op(in_line, op, result, verbose);
+                    read_test_op(in_line, op, result, testDefaults);
                 }
-                else if (op == "time")
+                else if (op == "time" || op == "throughput" || op == "calibrate")
                 {
-                    read_time_op(in_line, op, result, verbose);
+                    read_time_op(in_line, op, result, testDefaults);
+                }
+                else if (op == "sweep")
+                {
+                    read_sweep_op(in_line, result, testDefaults);
                 }
                 else if (op == "skip")
                 {
@@ -352,9 +943,45 @@ namespace test_manifest
                 {
                     read_vkvalidation_op(in_line, result);
                 }
+                else if (op == "expectedCache")
+                {
+                    read_expectedcache_op(in_line, result);
+                }
+                else if (op == "results")
+                {
+                    read_results_op(in_line, result);
+                }
+                else if (op == "trace")
+                {
+                    read_trace_op(in_line, result);
+                }
+                else if (op == "baseline")
+                {
+                    read_baseline_op(in_line, result);
+                }
+                else if (op == "evalThreads")
+                {
+                    read_evalthreads_op(in_line, result);
+                }
+                else if (op == "seed")
+                {
+                    read_seed_op(in_line, result);
+                }
+                else if (op == "reflection")
+                {
+                    reflection = read_reflection_op(in_line);
+                }
                 else if (op == "verbosity")
                 {
-                    verbose = read_verbosity_op(in_line);
+                    testDefaults.mIsVerbose = read_verbosity_op(in_line);
+                }
+                else if (op == "verify")
+                {
+                    read_verify_op(in_line, testDefaults);
+                }
+                else if (op == "warmup")
+                {
+                    read_warmup_op(in_line, testDefaults);
                 }
                 else if (op == "end")
                 {
@@ -381,7 +1008,7 @@ namespace test_manifest
 
         for (auto& mt : result.tests)
         {
-            ensure_all_entries_tested(mt);
+            ensure_all_entries_tested(mt, *result.modules);
         }
 
         return result;
@@ -6,17 +6,30 @@
 #define CLSPVTEST_TEST_MANIFEST_HPP
 
 #include "clspv_utils/clspv_utils_fwd.hpp"
+#include "results_sink.hpp"
 #include "test_utils.hpp"
 
+#include <cstdint>
 #include <iostream>
+#include <memory>
 #include <string>
 #include <vector>
 
 namespace test_manifest {
 
     struct manifest_t {
-        bool                                use_validation_layer = true;
-        std::vector<test_utils::ModuleTest> tests;
+        bool                                        use_validation_layer = true;
+        unsigned int                                evaluation_threads = 0;  // 0 is one per core
+        std::uint64_t                               random_seed = 0;
+        bool                                        fixed_seed = false;  // false if random_seed was chosen at random
+        bool                                        use_expected_cache = false;
+        bool                                        write_results = false;
+        results_sink::format                        results_format = results_sink::format_jsonl;
+        bool                                        write_trace = false;
+        std::string                                 baseline_path;  // empty if not comparing against a previous run
+        double                                      regression_threshold = 0.05;
+        std::vector<test_utils::ModuleTest>         tests;
+        std::shared_ptr<clspv_utils::module_cache>  modules;
     };
 
     typedef std::vector<test_utils::ModuleTest::result> results;
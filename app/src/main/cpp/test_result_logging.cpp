@@ -4,6 +4,8 @@
 
 #include "test_result_logging.hpp"
 
+#include "baseline_compare.hpp"
+#include "benchmark_stats.hpp"
 #include "test_utils.hpp"
 #include "util.hpp"
 #include "vulkan_utils/vulkan_utils.hpp"
@@ -11,6 +13,7 @@
 #include <vulkan/vulkan.hpp>
 
 #include <algorithm>
+#include <numeric>
 #include <sstream>
 #include <utility>
 
@@ -57,12 +60,48 @@ namespace {
         double gpuBarrierTime_ns    = 0.0;
     };
 
+    struct execution_stats {
+        benchmark_stats::summary_t  wallClockTime_s;
+        benchmark_stats::summary_t  executionTime_ns;
+        benchmark_stats::summary_t  hostBarrierTime_ns;
+        benchmark_stats::summary_t  gpuBarrierTime_ns;
+    };
+
+    // host time spent on each phase of an invocation before its results are evaluated
+    struct host_phase_times {
+        double prepareTime_s            = 0.0;
+        double descriptorUpdateTime_s   = 0.0;
+        double recordTime_s             = 0.0;
+        double submitTime_s             = 0.0;
+        double waitTime_s               = 0.0;
+        bool   hasLatency               = false;
+        double submissionLatency_s      = 0.0;
+        double completionLatency_s      = 0.0;
+    };
+
+    struct host_phase_stats {
+        benchmark_stats::summary_t  prepareTime_s;
+        benchmark_stats::summary_t  descriptorUpdateTime_s;
+        benchmark_stats::summary_t  recordTime_s;
+        benchmark_stats::summary_t  submitTime_s;
+        benchmark_stats::summary_t  waitTime_s;
+    };
+
+    // of the invocations whose device timestamps could be placed on the host clock
+    struct latency_stats {
+        std::size_t                 mNumSamples         = 0;
+        benchmark_stats::summary_t  submissionLatency_s;
+        benchmark_stats::summary_t  completionLatency_s;
+        double                      mCalibrationError_s = 0.0;  // the largest of any sample
+    };
+
     struct InvocationSummary {
         typedef decltype(test_utils::Evaluation::mMessages)::const_iterator   message_iterator;
         typedef iter_pair_range<message_iterator>   messages_t;
 
         ResultCounts        mCounts     = ResultCounts::null();
         execution_times     mTimes;
+        host_phase_times    mHostTimes;
         double              mTestTime_s = 0.0;
         const std::string*  mVariation  = nullptr;
         const std::string*  mParameters = nullptr;
@@ -73,13 +112,28 @@ namespace {
 
     struct KernelSummary {
         std::string                     mEntryPoint;
+        std::string                     mArguments;
+        std::string                     mSweep;
+        std::string                     mSweepSize;
+        vk::Extent3D                    mWorkgroupSize;
         ResultCounts                    mCounts             = ResultCounts::null();
         std::vector<InvocationSummary>  mInvocationSummaries;
         const std::string*              mExceptionMessage   = nullptr;
 
         unsigned int                    mTimingIterations   = 0;
-        execution_times                 mMeanTimes;
-        execution_times                 mVarianceTimes;
+        unsigned int                    mWarmupIterations   = 0;
+        double                          mTargetPrecision    = 0.0;
+        double                          mTimeBudget_s       = 0.0;
+        bool                            mIsThroughput       = false;
+        std::uint64_t                   mNumPixels          = 0;
+        test_utils::Workload            mWorkload;
+        bool                            mIsCalibration      = false;
+        double                          mPeakBandwidth_GBps = 0.0;  // measured by the manifest's calibrate verbs; 0 if none
+        baseline_compare::comparison_t  mComparison;
+        execution_stats                 mStats;
+        host_phase_stats                mHostStats;
+        latency_stats                   mLatencyStats;
+        execution_times                 mTotalTimes;
     };
 
     struct ModuleSummary {
@@ -91,11 +145,16 @@ namespace {
         std::vector<KernelSummary>  mKernelSummaries;
         const std::string*          mExceptionMessage   = nullptr;
         untested_entries_t          mUntestedEntries;
+        unsigned int                mNumRegressions     = 0;
+        unsigned int                mNumImprovements    = 0;
     };
 
     struct ManifestSummary {
         std::vector<ModuleSummary>  mModuleSummaries;
         ResultCounts                mCounts = ResultCounts::null();
+        bool                        mHasBaseline        = false;
+        unsigned int                mNumRegressions     = 0;
+        unsigned int                mNumImprovements    = 0;
     };
 
     ResultCounts operator+(ResultCounts lhs, const ResultCounts& rhs) {
@@ -132,6 +191,19 @@ namespace {
         return result;
     }
 
+    host_phase_times measureHostPhases(const test_utils::InvocationResult &ir) {
+        host_phase_times result;
+        result.prepareTime_s = ir.mPrepareTime.count();
+        result.descriptorUpdateTime_s = ir.mExecutionTime.descriptor_update_duration.count();
+        result.recordTime_s = ir.mExecutionTime.record_duration.count();
+        result.submitTime_s = ir.mExecutionTime.submit_duration.count();
+        result.waitTime_s = ir.mExecutionTime.wait_duration.count();
+        result.hasLatency = ir.mExecutionTime.has_latency;
+        result.submissionLatency_s = ir.mExecutionTime.submission_latency.count();
+        result.completionLatency_s = ir.mExecutionTime.completion_latency.count();
+        return result;
+    }
+
     void logInfo(const std::string& s, unsigned int indentLevel) {
         LOGI("%*s%s", indentLevel*3, "", s.c_str());
     }
@@ -140,59 +212,79 @@ namespace {
         LOGD("%*s%s", indentLevel*3, "", s.c_str());
     }
 
-    std::pair<execution_times, execution_times>
-    computeSummaryStats(const sample_info &info, const test_utils::KernelResult::results &resultSet) {
-        std::vector<execution_times> times;
-        times.reserve(resultSet.size());
-        transform(resultSet.begin(), resultSet.end(), std::back_inserter(times),
-                  [&info](const test_utils::InvocationTest::result &ir) {
-                      return measureInvocationTime(info, ir.second);
-                  });
-        auto num_times = times.size();
-
-        execution_times mean = accumulate(times.begin(), times.end(), execution_times(),
-                                          [&info](execution_times accum, const execution_times &t) {
-                                              accum.wallClockTime_s += t.wallClockTime_s;
-                                              accum.executionTime_ns += t.executionTime_ns;
-                                              accum.hostBarrierTime_ns += t.hostBarrierTime_ns;
-                                              accum.gpuBarrierTime_ns += t.gpuBarrierTime_ns;
-                                              return accum;
-                                          });
-        mean.wallClockTime_s /= num_times;
-        mean.executionTime_ns /= num_times;
-        mean.hostBarrierTime_ns /= num_times;
-        mean.gpuBarrierTime_ns /= num_times;
-
-        execution_times variance;
-        if (num_times > 1) {
-            variance = accumulate(times.begin(), times.end(), execution_times(),
-                                  [mean](execution_times accum, const execution_times &t) {
-                                      accum.wallClockTime_s += pow(
-                                              mean.wallClockTime_s -
-                                              t.wallClockTime_s, 2);
-                                      accum.executionTime_ns += pow(
-                                              mean.executionTime_ns -
-                                              t.executionTime_ns, 2);
-                                      accum.hostBarrierTime_ns += pow(
-                                              mean.hostBarrierTime_ns -
-                                              t.hostBarrierTime_ns, 2);
-                                      accum.gpuBarrierTime_ns += pow(
-                                              mean.gpuBarrierTime_ns -
-                                              t.gpuBarrierTime_ns, 2);
-                                      return accum;
-                                  });
-            variance.wallClockTime_s /= (num_times - 1);
-            variance.executionTime_ns /= (num_times - 1);
-            variance.hostBarrierTime_ns /= (num_times - 1);
-            variance.gpuBarrierTime_ns /= (num_times - 1);
-        }
-
-        return std::make_pair(mean, variance);
+    execution_stats computeSummaryStats(const sample_info &info, const test_utils::KernelResult::results &resultSet) {
+        std::vector<double> wallClockTimes;
+        std::vector<double> executionTimes;
+        std::vector<double> hostBarrierTimes;
+        std::vector<double> gpuBarrierTimes;
+
+        for (auto& ir : resultSet) {
+            const execution_times t = measureInvocationTime(info, ir.second);
+            wallClockTimes.push_back(t.wallClockTime_s);
+            executionTimes.push_back(t.executionTime_ns);
+            hostBarrierTimes.push_back(t.hostBarrierTime_ns);
+            gpuBarrierTimes.push_back(t.gpuBarrierTime_ns);
+        }
+
+        execution_stats result;
+        result.wallClockTime_s = benchmark_stats::summarize(std::move(wallClockTimes));
+        result.executionTime_ns = benchmark_stats::summarize(std::move(executionTimes));
+        result.hostBarrierTime_ns = benchmark_stats::summarize(std::move(hostBarrierTimes));
+        result.gpuBarrierTime_ns = benchmark_stats::summarize(std::move(gpuBarrierTimes));
+        return result;
     };
 
+    host_phase_stats computeHostPhaseStats(const test_utils::KernelResult::results &resultSet) {
+        std::vector<double> prepareTimes;
+        std::vector<double> descriptorUpdateTimes;
+        std::vector<double> recordTimes;
+        std::vector<double> submitTimes;
+        std::vector<double> waitTimes;
+
+        for (auto& ir : resultSet) {
+            const host_phase_times t = measureHostPhases(ir.second);
+            prepareTimes.push_back(t.prepareTime_s);
+            descriptorUpdateTimes.push_back(t.descriptorUpdateTime_s);
+            recordTimes.push_back(t.recordTime_s);
+            submitTimes.push_back(t.submitTime_s);
+            waitTimes.push_back(t.waitTime_s);
+        }
+
+        host_phase_stats result;
+        result.prepareTime_s = benchmark_stats::summarize(std::move(prepareTimes));
+        result.descriptorUpdateTime_s = benchmark_stats::summarize(std::move(descriptorUpdateTimes));
+        result.recordTime_s = benchmark_stats::summarize(std::move(recordTimes));
+        result.submitTime_s = benchmark_stats::summarize(std::move(submitTimes));
+        result.waitTime_s = benchmark_stats::summarize(std::move(waitTimes));
+        return result;
+    }
+
+    latency_stats computeLatencyStats(const test_utils::KernelResult::results &resultSet) {
+        std::vector<double> submissionLatencies;
+        std::vector<double> completionLatencies;
+
+        latency_stats result;
+        for (auto& ir : resultSet) {
+            const clspv_utils::execution_time_t& time = ir.second.mExecutionTime;
+            if (!time.has_latency) continue;
+
+            submissionLatencies.push_back(time.submission_latency.count());
+            completionLatencies.push_back(time.completion_latency.count());
+            result.mCalibrationError_s = std::max(result.mCalibrationError_s, time.calibration_error.count());
+        }
+
+        result.mNumSamples = submissionLatencies.size();
+        if (result.mNumSamples > 0) {
+            result.submissionLatency_s = benchmark_stats::summarize(std::move(submissionLatencies));
+            result.completionLatency_s = benchmark_stats::summarize(std::move(completionLatencies));
+        }
+        return result;
+    }
+
     InvocationSummary summarizeInvocation(const sample_info &info, const test_utils::InvocationTest::result& ir) {
         InvocationSummary result;
         result.mTimes = measureInvocationTime(info, ir.second);
+        result.mHostTimes = measureHostPhases(ir.second);
         result.mTestTime_s = ir.second.mEvalTime.count();
         result.mNumCorrect = ir.second.mEvaluation.mNumCorrect;
         result.mNumErrors = ir.second.mEvaluation.mNumErrors;
@@ -215,7 +307,18 @@ namespace {
     KernelSummary summarizeKernel(const sample_info &info, const test_utils::KernelTest::result& kr) {
         KernelSummary result;
         result.mEntryPoint = kr.first->mEntryName;
+        for (const auto& arg : kr.first->mArguments) {
+            result.mArguments += (result.mArguments.empty() ? "" : " ") + arg;
+        }
+        result.mSweep = kr.first->mSweep;
+        result.mSweepSize = kr.first->mSweepSize;
+        result.mWorkgroupSize = kr.first->mWorkgroupSize;
         result.mTimingIterations = kr.first->mTimingIterations;
+        result.mTargetPrecision = kr.first->mTargetPrecision;
+        result.mTimeBudget_s = kr.first->mTimeBudget_s;
+        result.mWarmupIterations = kr.first->mWarmupIterations;
+        result.mIsThroughput = (test_utils::KernelTest::timing_throughput == kr.first->mTiming);
+        result.mIsCalibration = kr.first->mIsCalibration;
 
         if (!kr.second.mExceptionString.empty()) result.mExceptionMessage = &kr.second.mExceptionString;
 
@@ -229,13 +332,35 @@ namespace {
                                          [](ResultCounts r, const InvocationSummary& is) { return r + is.mCounts; });
 
         if (result.mTimingIterations > 0) {
-            std::tie(result.mMeanTimes, result.mVarianceTimes) = computeSummaryStats(info, kr.second.mInvocationResults);
+            result.mStats = computeSummaryStats(info, kr.second.mInvocationResults);
+            result.mHostStats = computeHostPhaseStats(kr.second.mInvocationResults);
+            result.mLatencyStats = computeLatencyStats(kr.second.mInvocationResults);
+            if (result.mTargetPrecision > 0.0) {
+                // adaptive timing chose the number of iterations
+                result.mTimingIterations = kr.second.mInvocationResults.size();
+            }
+            result.mTotalTimes = std::accumulate(kr.second.mInvocationResults.begin(), kr.second.mInvocationResults.end(),
+                                                 execution_times(),
+                                                 [&info](execution_times accum, const test_utils::InvocationTest::result& ir) {
+                                                     const execution_times t = measureInvocationTime(info, ir.second);
+                                                     accum.wallClockTime_s += t.wallClockTime_s;
+                                                     accum.executionTime_ns += t.executionTime_ns;
+                                                     accum.hostBarrierTime_ns += t.hostBarrierTime_ns;
+                                                     accum.gpuBarrierTime_ns += t.gpuBarrierTime_ns;
+                                                     return accum;
+                                                 });
+            if (!kr.second.mInvocationResults.empty()) {
+                result.mNumPixels = kr.second.mInvocationResults.front().second.mNumPixels;
+                result.mWorkload = kr.second.mInvocationResults.front().second.mWorkload;
+            }
         }
 
         return result;
     }
 
-    ModuleSummary summarizeModule(const sample_info &info, const test_utils::ModuleTest::result& mr) {
+    ModuleSummary summarizeModule(const sample_info &info,
+                                  const test_utils::ModuleTest::result& mr,
+                                  const baseline_compare::baseline_t* baseline = nullptr) {
         ModuleSummary result;
         result.mName = mr.first->mName;
         result.mUntestedEntries = std::make_pair(mr.second.mUntestedEntryPoints.begin(), mr.second.mUntestedEntryPoints.end());
@@ -251,16 +376,46 @@ namespace {
                                          ResultCounts::null(),
                                          [](ResultCounts r, const KernelSummary& ks) { return r + ks.mCounts; });
 
+        if (baseline) {
+            for (std::size_t i = 0; i < result.mKernelSummaries.size(); ++i) {
+                KernelSummary& ks = result.mKernelSummaries[i];
+                const test_utils::KernelTest::result& kr = mr.second.mKernelResults[i];
+                if (0 == ks.mTimingIterations) continue;
+
+                const auto found = baseline->mExecutionTimes_ns.find(baseline_compare::kernel_key(result.mName, *kr.first));
+                if (found == baseline->mExecutionTimes_ns.end()) continue;
+
+                std::vector<double> executionTimes;
+                for (const auto& ir : kr.second.mInvocationResults) {
+                    executionTimes.push_back(measureInvocationTime(info, ir.second).executionTime_ns);
+                }
+
+                ks.mComparison = baseline_compare::compare(found->second, executionTimes, baseline->mThreshold);
+                if (baseline_compare::verdict_regression == ks.mComparison.mVerdict) ++result.mNumRegressions;
+                if (baseline_compare::verdict_improvement == ks.mComparison.mVerdict) ++result.mNumImprovements;
+            }
+        }
+
         return result;
     }
 
-    ManifestSummary summarizeManifest(const sample_info& info, const test_manifest::results& manifestResults) {
+    // bytes moved per nanosecond of average execution time, which is GB/s
+    double achievedBandwidth_GBps(const KernelSummary& summary) {
+        const double executionTime_ns = summary.mStats.executionTime_ns.mMean;
+        if (executionTime_ns <= 0.0) return 0.0;
+
+        return (summary.mWorkload.mBytesRead + summary.mWorkload.mBytesWritten) / executionTime_ns;
+    }
+
+    ManifestSummary summarizeManifest(const sample_info& info,
+                                      const test_manifest::results& manifestResults,
+                                      const baseline_compare::baseline_t* baseline = nullptr) {
         ManifestSummary result;
 
         result.mModuleSummaries.reserve(manifestResults.size());
         std::transform(manifestResults.begin(), manifestResults.end(),
                        std::back_inserter(result.mModuleSummaries),
-                       std::bind(summarizeModule, std::cref(info), std::placeholders::_1));
+                       std::bind(summarizeModule, std::cref(info), std::placeholders::_1, baseline));
 
         result.mCounts = std::accumulate(result.mModuleSummaries.begin(), result.mModuleSummaries.end(),
                                          ResultCounts::null(),
@@ -268,6 +423,27 @@ namespace {
                                              return r + ms.mCounts;
                                          });
 
+        // the fastest calibration anywhere in the manifest sets the roof for every kernel
+        double peakBandwidth_GBps = 0.0;
+        for (const auto& ms : result.mModuleSummaries) {
+            for (const auto& ks : ms.mKernelSummaries) {
+                if (ks.mIsCalibration && !ks.mExceptionMessage) {
+                    peakBandwidth_GBps = std::max(peakBandwidth_GBps, achievedBandwidth_GBps(ks));
+                }
+            }
+        }
+        for (auto& ms : result.mModuleSummaries) {
+            for (auto& ks : ms.mKernelSummaries) {
+                ks.mPeakBandwidth_GBps = peakBandwidth_GBps;
+            }
+        }
+
+        result.mHasBaseline = (nullptr != baseline);
+        for (const auto& ms : result.mModuleSummaries) {
+            result.mNumRegressions += ms.mNumRegressions;
+            result.mNumImprovements += ms.mNumImprovements;
+        }
+
         return result;
     }
 
@@ -294,10 +470,19 @@ namespace {
             os << " correctValues:" << summary.mNumCorrect
                << " incorrectValues:" << summary.mNumErrors
                << " wallClockTime:" << summary.mTimes.wallClockTime_s * 1000.0f << "ms"
+               << " prepareTime:" << summary.mHostTimes.prepareTime_s * 1000.0f << "ms"
+               << " descriptorUpdateTime:" << summary.mHostTimes.descriptorUpdateTime_s * 1000.0f << "ms"
+               << " recordTime:" << summary.mHostTimes.recordTime_s * 1000.0f << "ms"
+               << " submitTime:" << summary.mHostTimes.submitTime_s * 1000.0f << "ms"
+               << " waitTime:" << summary.mHostTimes.waitTime_s * 1000.0f << "ms"
                << " resultEvalTime:" << summary.mTestTime_s << "s"
                << " executionTime:" << summary.mTimes.executionTime_ns / 1000.0f << "µs"
                << " hostBarrierTime:" << summary.mTimes.hostBarrierTime_ns / 1000.0f << "µs"
                << " gpuBarrierTime:" << summary.mTimes.gpuBarrierTime_ns / 1000.0f << "µs";
+            if (summary.mHostTimes.hasLatency) {
+                os << " submissionLatency:" << summary.mHostTimes.submissionLatency_s * 1000000.0f << "µs"
+                   << " completionLatency:" << summary.mHostTimes.completionLatency_s * 1000000.0f << "µs";
+            }
         }
 
         logInfo(os.str(), indent);
@@ -307,6 +492,119 @@ namespace {
         }
     }
 
+    // one statistic of each of the times, in the units of the other summary lines
+    template <typename StatFn>
+    std::string composeTimesLine(const char* label, const execution_stats& stats, StatFn stat) {
+        std::ostringstream os;
+        os << label
+           << " wallClockTime:" << stat(stats.wallClockTime_s) * 1000.0f << "ms"
+           << " executionTime:" << stat(stats.executionTime_ns) / 1000.0f << "µs"
+           << " hostBarrierTime:" << stat(stats.hostBarrierTime_ns) / 1000.0f << "µs"
+           << " gpuBarrierTime:" << stat(stats.gpuBarrierTime_ns) / 1000.0f << "µs";
+        return os.str();
+    }
+
+    template <typename StatFn>
+    std::string composeHostPhasesLine(const char* label, const host_phase_stats& stats, StatFn stat) {
+        std::ostringstream os;
+        os << label
+           << " prepareTime:" << stat(stats.prepareTime_s) * 1000.0f << "ms"
+           << " descriptorUpdateTime:" << stat(stats.descriptorUpdateTime_s) * 1000.0f << "ms"
+           << " recordTime:" << stat(stats.recordTime_s) * 1000.0f << "ms"
+           << " submitTime:" << stat(stats.submitTime_s) * 1000.0f << "ms"
+           << " waitTime:" << stat(stats.waitTime_s) * 1000.0f << "ms";
+        return os.str();
+    }
+
+    template <typename StatFn>
+    std::string composeLatencyLine(const char* label, const latency_stats& stats, StatFn stat) {
+        std::ostringstream os;
+        os << label
+           << " submissionLatency:" << stat(stats.submissionLatency_s) * 1000000.0f << "µs"
+           << " completionLatency:" << stat(stats.completionLatency_s) * 1000000.0f << "µs"
+           << " calibrationError:±" << stats.mCalibrationError_s * 1000000.0f << "µs";
+        return os.str();
+    }
+
+    //
+    // An invocation is host bound when the host work around its submission, waiting aside, takes
+    // longer than the GPU work between the first and last timestamps; making the GPU work faster
+    // would then barely change how many invocations can run per second.
+    //
+    std::string composeBoundLine(const char* label, const KernelSummary& summary) {
+        const host_phase_stats& host = summary.mHostStats;
+        const double hostTime_ms = (host.prepareTime_s.mMean + host.descriptorUpdateTime_s.mMean + host.recordTime_s.mMean + host.submitTime_s.mMean) * 1000.0;
+        const double gpuTime_ms = (summary.mStats.hostBarrierTime_ns.mMean + summary.mStats.executionTime_ns.mMean + summary.mStats.gpuBarrierTime_ns.mMean) / 1000000.0;
+
+        std::ostringstream os;
+        os << label
+           << " hostTime:" << hostTime_ms << "ms"
+           << " gpuTime:" << gpuTime_ms << "ms"
+           << " " << (hostTime_ms > gpuTime_ms ? "host bound" : "GPU bound");
+        return os.str();
+    }
+
+    std::string composeIntervalLine(const char* label, const execution_stats& stats) {
+        std::ostringstream os;
+        os << label
+           << " wallClockTime:[" << stats.wallClockTime_s.mMeanLow * 1000.0f << ", " << stats.wallClockTime_s.mMeanHigh * 1000.0f << "]ms"
+           << " executionTime:[" << stats.executionTime_ns.mMeanLow / 1000.0f << ", " << stats.executionTime_ns.mMeanHigh / 1000.0f << "]µs"
+           << " hostBarrierTime:[" << stats.hostBarrierTime_ns.mMeanLow / 1000.0f << ", " << stats.hostBarrierTime_ns.mMeanHigh / 1000.0f << "]µs"
+           << " gpuBarrierTime:[" << stats.gpuBarrierTime_ns.mMeanLow / 1000.0f << ", " << stats.gpuBarrierTime_ns.mMeanHigh / 1000.0f << "]µs";
+        return os.str();
+    }
+
+    std::string composeComparisonLine(const char* label, const baseline_compare::comparison_t& comparison) {
+        const char* verdicts[] = { "", "unchanged", "REGRESSION", "IMPROVEMENT" };
+
+        std::ostringstream os;
+        os << label
+           << " median:" << comparison.mBaselineMedian_ns / 1000.0 << "µs"
+           << " now:" << comparison.mCurrentMedian_ns / 1000.0 << "µs"
+           << " change:" << std::showpos << comparison.mDelta * 100.0 << std::noshowpos << "%"
+           << " p:" << comparison.mP
+           << " samples:" << comparison.mNumBaseline << "/" << comparison.mNumCurrent
+           << " " << verdicts[comparison.mVerdict];
+        return os.str();
+    }
+
+    // significant changes beyond the threshold, worst regression first
+    void logRegressionReport(const ManifestSummary& summary, unsigned int indent = 0) {
+        std::vector<std::pair<const ModuleSummary*, const KernelSummary*>> changes;
+        for (const auto& ms : summary.mModuleSummaries) {
+            for (const auto& ks : ms.mKernelSummaries) {
+                if (baseline_compare::verdict_regression == ks.mComparison.mVerdict ||
+                    baseline_compare::verdict_improvement == ks.mComparison.mVerdict) {
+                    changes.push_back(std::make_pair(&ms, &ks));
+                }
+            }
+        }
+        std::stable_sort(changes.begin(), changes.end(),
+                         [](const std::pair<const ModuleSummary*, const KernelSummary*>& lhs,
+                            const std::pair<const ModuleSummary*, const KernelSummary*>& rhs) {
+                             return lhs.second->mComparison.mDelta > rhs.second->mComparison.mDelta;
+                         });
+
+        {
+            std::ostringstream os;
+            os << "Regression Report regressions:" << summary.mNumRegressions << " improvements:" << summary.mNumImprovements;
+            logInfo(os.str(), indent);
+        }
+
+        for (const auto& c : changes) {
+            const KernelSummary& ks = *c.second;
+
+            std::ostringstream os;
+            os << c.first->mName << " " << ks.mEntryPoint
+               << " workgroup:" << ks.mWorkgroupSize.width << "x" << ks.mWorkgroupSize.height << "x" << ks.mWorkgroupSize.depth;
+            if (!ks.mArguments.empty()) {
+                os << " args:" << ks.mArguments;
+            }
+            logInfo(os.str(), indent + 1);
+            logInfo(composeComparisonLine("", ks.mComparison), indent + 2);
+        }
+    }
+
     void logKernelSummary(const KernelSummary& summary, unsigned int indent = 0) {
         {
             std::ostringstream os;
@@ -326,53 +624,180 @@ namespace {
             assert(!summary.mInvocationSummaries.empty());
             logInfo(composeBasicInvocationSummary(summary.mInvocationSummaries[0]), indent + 1);
 
-            {
+            if (summary.mIsThroughput) {
+                std::ostringstream os;
+                os << "NUMBER DISPATCHES = " << summary.mTimingIterations << " IN ONE SUBMISSION";
+                logInfo(os.str(), indent + 1);
+            }
+            else {
                 std::ostringstream os;
                 os << "NUMBER ITERATIONS = " << summary.mTimingIterations;
                 logInfo(os.str(), indent + 1);
             }
 
-            {
+            if (summary.mTargetPrecision > 0.0) {
+                const auto& execution = summary.mStats.executionTime_ns;
+                const double precision = (execution.mMean > 0.0 ? (execution.mMeanHigh - execution.mMeanLow) / 2.0 / execution.mMean : 0.0);
+
                 std::ostringstream os;
-                os << "AVERAGE "
-                   << " wallClockTime:" << summary.mMeanTimes.wallClockTime_s * 1000.0f << "ms"
-                   << " executionTime:" << summary.mMeanTimes.executionTime_ns / 1000.0f << "µs"
-                   << " hostBarrierTime:" << summary.mMeanTimes.hostBarrierTime_ns / 1000.0f << "µs"
-                   << " gpuBarrierTime:" << summary.mMeanTimes.gpuBarrierTime_ns / 1000.0f << "µs";
+                os << "ADAPTIVE target:" << summary.mTargetPrecision * 100.0 << "%"
+                   << " reached:" << precision * 100.0 << "%"
+                   << " budget:" << summary.mTimeBudget_s << "s";
+                if (precision > summary.mTargetPrecision) {
+                    os << " (stopped short of the target)";
+                }
                 logInfo(os.str(), indent + 1);
             }
 
-            if (summary.mInvocationSummaries.size() > 1) {
+            if (summary.mWarmupIterations > 0) {
                 std::ostringstream os;
-                os << "STD_DEVIATION "
-                   << " wallClockTime:" << sqrt(summary.mVarianceTimes.wallClockTime_s) * 1000.0f
-                   << "ms"
-                   << " executionTime:" << sqrt(summary.mVarianceTimes.executionTime_ns) / 1000.0f
-                   << "µs"
-                   << " hostBarrierTime:"
-                   << sqrt(summary.mVarianceTimes.hostBarrierTime_ns) / 1000.0f
-                   << "µs"
-                   << " gpuBarrierTime:" << sqrt(summary.mVarianceTimes.gpuBarrierTime_ns) / 1000.0f
-                   << "µs";
+                os << "WARMUP ITERATIONS = " << summary.mWarmupIterations << " (not included below)";
+                logInfo(os.str(), indent + 1);
+            }
 
+            if (summary.mIsThroughput) {
+                // per-dispatch times add up to those of the submission
+                std::ostringstream os;
+                os << "TOTAL "
+                   << " wallClockTime:" << summary.mTotalTimes.wallClockTime_s * 1000.0f << "ms"
+                   << " executionTime:" << summary.mTotalTimes.executionTime_ns / 1000.0f << "µs"
+                   << " hostBarrierTime:" << summary.mTotalTimes.hostBarrierTime_ns / 1000.0f << "µs"
+                   << " gpuBarrierTime:" << summary.mTotalTimes.gpuBarrierTime_ns / 1000.0f << "µs";
                 logInfo(os.str(), indent + 1);
             }
 
+            typedef benchmark_stats::summary_t stats_t;
+
+            logInfo(composeTimesLine("AVERAGE ", summary.mStats, [](const stats_t& s) { return s.mMean; }), indent + 1);
+
+            if (summary.mInvocationSummaries.size() > 1) {
+                logInfo(composeTimesLine("STD_DEVIATION ", summary.mStats, [](const stats_t& s) { return sqrt(s.mVariance); }), indent + 1);
+            }
+
             if (summary.mInvocationSummaries.size() > 1) {
                 std::ostringstream os;
                 os << "VARIANCE "
-                   << " wallClockTime:" << summary.mVarianceTimes.wallClockTime_s * 1000000.0f
+                   << " wallClockTime:" << summary.mStats.wallClockTime_s.mVariance * 1000000.0f
                    << "ms^2"
-                   << " executionTime:" << summary.mVarianceTimes.executionTime_ns / 1000000.0f
+                   << " executionTime:" << summary.mStats.executionTime_ns.mVariance / 1000000.0f
                    << "µs^2"
                    << " hostBarrierTime:"
-                   << summary.mVarianceTimes.hostBarrierTime_ns / 1000000.0f
+                   << summary.mStats.hostBarrierTime_ns.mVariance / 1000000.0f
                    << "µs^2"
-                   << " gpuBarrierTime:" << summary.mVarianceTimes.gpuBarrierTime_ns / 1000000.0f
+                   << " gpuBarrierTime:" << summary.mStats.gpuBarrierTime_ns.mVariance / 1000000.0f
                    << "µs^2";
 
                 logInfo(os.str(), indent + 1);
             }
+
+            if (summary.mInvocationSummaries.size() > 1) {
+                logInfo(composeIntervalLine("MEAN_95%_CI ", summary.mStats), indent + 1);
+                logInfo(composeTimesLine("MEDIAN ", summary.mStats, [](const stats_t& s) { return s.mMedian; }), indent + 1);
+                logInfo(composeTimesLine("P90 ", summary.mStats, [](const stats_t& s) { return s.mP90; }), indent + 1);
+                logInfo(composeTimesLine("P95 ", summary.mStats, [](const stats_t& s) { return s.mP95; }), indent + 1);
+                logInfo(composeTimesLine("P99 ", summary.mStats, [](const stats_t& s) { return s.mP99; }), indent + 1);
+                logInfo(composeTimesLine("MIN ", summary.mStats, [](const stats_t& s) { return s.mMin; }), indent + 1);
+                logInfo(composeTimesLine("MAX ", summary.mStats, [](const stats_t& s) { return s.mMax; }), indent + 1);
+
+                std::ostringstream os;
+                os << "OUTLIERS_REJECTED "
+                   << " wallClockTime:" << summary.mStats.wallClockTime_s.mNumOutliers
+                   << " executionTime:" << summary.mStats.executionTime_ns.mNumOutliers
+                   << " hostBarrierTime:" << summary.mStats.hostBarrierTime_ns.mNumOutliers
+                   << " gpuBarrierTime:" << summary.mStats.gpuBarrierTime_ns.mNumOutliers;
+                logInfo(os.str(), indent + 1);
+            }
+
+            logInfo(composeHostPhasesLine("HOST_AVERAGE ", summary.mHostStats, [](const stats_t& s) { return s.mMean; }), indent + 1);
+            if (summary.mInvocationSummaries.size() > 1) {
+                logInfo(composeHostPhasesLine("HOST_MEDIAN ", summary.mHostStats, [](const stats_t& s) { return s.mMedian; }), indent + 1);
+                logInfo(composeHostPhasesLine("HOST_MAX ", summary.mHostStats, [](const stats_t& s) { return s.mMax; }), indent + 1);
+            }
+            logInfo(composeBoundLine("BOUND ", summary), indent + 1);
+
+            if (summary.mLatencyStats.mNumSamples > 0) {
+                logInfo(composeLatencyLine("LATENCY_AVERAGE ", summary.mLatencyStats, [](const stats_t& s) { return s.mMean; }), indent + 1);
+                if (summary.mLatencyStats.mNumSamples > 1) {
+                    logInfo(composeLatencyLine("LATENCY_MEDIAN ", summary.mLatencyStats, [](const stats_t& s) { return s.mMedian; }), indent + 1);
+                    logInfo(composeLatencyLine("LATENCY_P95 ", summary.mLatencyStats, [](const stats_t& s) { return s.mP95; }), indent + 1);
+                }
+            }
+
+            if (summary.mNumPixels > 0 && summary.mStats.executionTime_ns.mMean > 0.0) {
+                // from the average times
+                std::ostringstream os;
+                os << "THROUGHPUT "
+                   << " pixels:" << summary.mNumPixels
+                   << " execution:" << summary.mNumPixels * 1000.0 / summary.mStats.executionTime_ns.mMean << "Mpix/s";
+                if (summary.mStats.wallClockTime_s.mMean > 0.0) {
+                    os << " wallClock:" << summary.mNumPixels / summary.mStats.wallClockTime_s.mMean / 1000000.0 << "Mpix/s";
+                }
+                logInfo(os.str(), indent + 1);
+            }
+
+            const double bandwidth_GBps = achievedBandwidth_GBps(summary);
+            if (bandwidth_GBps > 0.0) {
+                std::ostringstream os;
+                os << "BANDWIDTH "
+                   << " read:" << summary.mWorkload.mBytesRead << "B"
+                   << " written:" << summary.mWorkload.mBytesWritten << "B"
+                   << " achieved:" << bandwidth_GBps << "GB/s";
+                logInfo(os.str(), indent + 1);
+            }
+
+            if (summary.mWorkload.mOperations > 0 && summary.mStats.executionTime_ns.mMean > 0.0) {
+                const std::uint64_t bytes = summary.mWorkload.mBytesRead + summary.mWorkload.mBytesWritten;
+
+                std::ostringstream os;
+                os << "OPERATIONS "
+                   << " ops:" << summary.mWorkload.mOperations
+                   << " achieved:" << summary.mWorkload.mOperations / summary.mStats.executionTime_ns.mMean << "GFLOP/s";
+                if (bytes > 0) {
+                    os << " intensity:" << static_cast<double>(summary.mWorkload.mOperations) / bytes << "ops/B";
+                }
+                logInfo(os.str(), indent + 1);
+            }
+
+            if (bandwidth_GBps > 0.0 && summary.mPeakBandwidth_GBps > 0.0) {
+                // only the memory roof is calibrated, so every kernel is measured against it
+                std::ostringstream os;
+                os << "ROOFLINE "
+                   << " peak:" << summary.mPeakBandwidth_GBps << "GB/s"
+                   << " achieved:" << bandwidth_GBps * 100.0 / summary.mPeakBandwidth_GBps << "% of peak bandwidth";
+                if (summary.mIsCalibration) {
+                    os << " (calibration)";
+                }
+                logInfo(os.str(), indent + 1);
+            }
+
+            if (baseline_compare::verdict_none != summary.mComparison.mVerdict) {
+                logInfo(composeComparisonLine("BASELINE ", summary.mComparison), indent + 1);
+            }
+        }
+    }
+
+    // one row per point of a sweep, so that throughput can be read against problem size
+    template <typename Iter>
+    void logSweepTable(Iter begin, Iter end, unsigned int indent = 0) {
+        logInfo("SWEEP " + begin->mSweep, indent);
+        logInfo("workgroup size pixels median_execution(µs) execution(Mpix/s) bandwidth(GB/s)", indent + 1);
+
+        for (; begin != end; ++begin) {
+            const auto& execution = begin->mStats.executionTime_ns;
+
+            std::ostringstream os;
+            os << begin->mWorkgroupSize.width << "x" << begin->mWorkgroupSize.height << "x" << begin->mWorkgroupSize.depth
+               << " " << begin->mSweepSize
+               << " " << begin->mNumPixels;
+            if (begin->mExceptionMessage || 0 == execution.mNumSamples || execution.mMean <= 0.0) {
+                os << " - - -";
+            }
+            else {
+                os << " " << execution.mMedian / 1000.0
+                   << " " << begin->mNumPixels * 1000.0 / execution.mMean
+                   << " " << achievedBandwidth_GBps(*begin);
+            }
+            logInfo(os.str(), indent + 1);
         }
     }
 
@@ -389,6 +814,12 @@ namespace {
             logInfo(os.str(), indent + 1);
         }
 
+        if (summary.mNumRegressions > 0 || summary.mNumImprovements > 0) {
+            std::ostringstream os;
+            os << "BASELINE regressions:" << summary.mNumRegressions << " improvements:" << summary.mNumImprovements;
+            logInfo(os.str(), indent + 1);
+        }
+
         for (auto& untested : summary.mUntestedEntries) {
             std::ostringstream os;
             os << "MISSED " << untested;
@@ -397,6 +828,16 @@ namespace {
 
         std::for_each(summary.mKernelSummaries.begin(), summary.mKernelSummaries.end(),
                       std::bind(logKernelSummary, std::placeholders::_1, indent + 1));
+
+        // consecutive points of the same sweep also get a table of their own
+        for (auto i = summary.mKernelSummaries.begin(); i != summary.mKernelSummaries.end(); ) {
+            auto next = std::find_if(i, summary.mKernelSummaries.end(),
+                                     [i](const KernelSummary& ks) { return ks.mSweep != i->mSweep; });
+            if (!i->mSweep.empty()) {
+                logSweepTable(i, next, indent + 1);
+            }
+            i = next;
+        }
     }
 
     void logManifestSummary(const ManifestSummary& summary, unsigned int indent = 0) {
@@ -433,6 +874,10 @@ namespace {
         std::for_each(moduleCountStrings.begin(), moduleCountStrings.end(),
                       std::bind(logInfo, std::placeholders::_1, indent + 1));
         logInfo(overallCountString, indent);
+
+        if (summary.mHasBaseline) {
+            logRegressionReport(summary, indent);
+        }
     }
 }
 
@@ -473,4 +918,15 @@ namespace test_result_logging {
         logManifestSummary(summary);
     }
 
+    unsigned int logResults(const sample_info &info,
+                            const test_manifest::results &moduleResultSet,
+                            const baseline_compare::baseline_t &baseline) {
+        logPhysicalDeviceInfo(info);
+
+        const ManifestSummary summary = summarizeManifest(info, moduleResultSet, &baseline);
+        logManifestSummary(summary);
+
+        return summary.mNumRegressions;
+    }
+
 }
\ No newline at end of file
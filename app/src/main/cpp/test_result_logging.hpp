@@ -5,6 +5,7 @@
 #ifndef CLSPVTEST_TEST_RESULT_LOGGING_HPP
 #define CLSPVTEST_TEST_RESULT_LOGGING_HPP
 
+#include "baseline_compare.hpp"
 #include "test_manifest.hpp"
 #include "test_utils.hpp"
 
@@ -20,6 +21,11 @@ namespace test_result_logging {
     void logResults(const sample_info &info, const test_utils::ModuleTest::result &mr);
 
     void logResults(const sample_info &info, const test_manifest::results &manifestResults);
+
+    // Logs the results compared against a previous run, and returns the number of regressions
+    unsigned int logResults(const sample_info &info,
+                            const test_manifest::results &manifestResults,
+                            const baseline_compare::baseline_t &baseline);
 }
 
 #endif //CLSPVTEST_TEST_RESULT_LOGGING_HPP
@@ -7,9 +7,19 @@
 #include "clspv_utils/interface.hpp"
 #include "clspv_utils/kernel.hpp"
 #include "clspv_utils/module.hpp"
+#include "clspv_utils/module_cache.hpp"
 
-#include "crlf_savvy.hpp"
+#include "benchmark_stats.hpp"
 #include "file_utils.hpp"
+#include "trace_events.hpp"
+
+#include <cerrno>
+#include <cstdlib>
+#include <iomanip>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <set>
 
 namespace {
     using namespace test_utils;
@@ -51,6 +61,155 @@ namespace {
         return result;
     }
 
+    // Calls fn with the bytes of the module's descriptor map, preferring the pre-tokenized binary
+    // form when the build produced one
+    template <typename Fn>
+    clspv_utils::module::spec_ptr with_spvmap(const std::string& moduleName, Fn fn) {
+        const file_utils::AndroidAssetMapping binarySpvmap(moduleName + ".spvmap.bin");
+        if (binarySpvmap.is_open()) {
+            return fn(binarySpvmap.data(), binarySpvmap.size());
+        }
+
+        std::string spvmapContents;
+        file_utils::read_file_contents(moduleName + ".spvmap", spvmapContents);
+
+        return fn(spvmapContents.data(), spvmapContents.size());
+    }
+
+    std::mutex                          gEvaluationPoolMutex;
+    unsigned int                        gEvaluationThreads = 0;
+    std::shared_ptr<thread_pool::pool>  gEvaluationPool;
+
+    std::mutex                          gRandomMutex;
+    std::uint64_t                       gRandomSeed = 0;
+    std::uint64_t                       gRandomSequence = 0;
+    std::string                         gRandomIdentity;
+    std::uint64_t                       gRandomSequenceLength = 0;
+
+    // FNV-1a, so that sequence keys are the same on every platform and in every run
+    std::uint64_t hash_identity(const std::string& identity) {
+        std::uint64_t result = 0xcbf29ce484222325ull;
+        for (char c : identity) {
+            result = (result ^ static_cast<unsigned char>(c)) * 0x100000001b3ull;
+        }
+        return result;
+    }
+
+    std::string invocation_identity(const KernelTest& kernelTest, const InvocationTest& invocationTest) {
+        std::ostringstream os;
+        os << kernelTest.mEntryName << '/' << invocationTest.mVariation;
+        for (const auto& arg : kernelTest.mArguments) {
+            os << ' ' << arg;
+        }
+        return os.str();
+    }
+
+    std::mutex                                  gVerificationMutex;
+    KernelTest::verification                    gVerification = KernelTest::verification_full;
+    unsigned int                                gVerificationSamples = 0;
+    std::shared_ptr<device_verify::verifier>    gDeviceVerifier;
+    unsigned int                                gDeviceComparisonCount = 0;
+
+    std::mutex                                  gObserverMutex;
+    kernel_observer                             gKernelObserver;
+
+    std::mutex                                  gGoldenMutex;
+    unsigned int                                gGoldenSequenceLength = 0;
+    std::map<std::string, std::uint64_t>        gGoldenHashes;
+    std::set<std::string>                       gGoldenKeysUsed;
+
+    void notify_kernel_observer(const ModuleTest& moduleTest, const KernelTest::result& kernelResult)
+    {
+        kernel_observer observer;
+        {
+            std::lock_guard<std::mutex> lock(gObserverMutex);
+            observer = gKernelObserver;
+        }
+
+        if (observer) {
+            observer(moduleTest, kernelResult);
+        }
+    }
+
+    // adaptive timing never runs more than this many iterations of one test
+    const unsigned int kMaxAdaptiveIterations = 100000;
+
+    std::vector<InvocationResult> time_batch(clspv_utils::kernel&    kernel,
+                                             const KernelTest&       kernelTest,
+                                             const InvocationTest&   invocationTest,
+                                             unsigned int            warmupIterations,
+                                             unsigned int            iterations) {
+        const auto& timeFn = (KernelTest::timing_throughput == kernelTest.mTiming ? invocationTest.mThroughputFn : invocationTest.mTimeFn);
+
+        // every run of the batch places its timestamps on the host clock with this one calibration
+        kernel.getDevice().calibrateTimestamps();
+        std::vector<InvocationResult> results = timeFn(kernel, kernelTest.mArguments, warmupIterations + iterations, kernelTest.mIsVerbose);
+
+        // warm-up iterations settle caches and clocks; only those after them count
+        results.erase(results.begin(), results.begin() + std::min<std::size_t>(warmupIterations, results.size()));
+
+        return results;
+    }
+
+    // Adds the GPU execution time of each result to stats. The precision derived from them is a
+    // ratio, so it can be computed in timestamp ticks without knowing the timestamp period.
+    void add_execution_times(benchmark_stats::running_t&            stats,
+                             const std::vector<InvocationResult>&   results,
+                             std::uint32_t                          timestampValidBits) {
+        for (auto& r : results) {
+            const auto& timestamps = r.mExecutionTime.timestamps;
+            benchmark_stats::add_sample(stats, static_cast<double>(vulkan_utils::timestamp_delta(timestamps.host_barrier, timestamps.execution, timestampValidBits)));
+        }
+    }
+
+    //
+    // Times the test in batches until the mean execution time is known to the target precision,
+    // the time budget runs out, or kMaxAdaptiveIterations have run. Each batch is sized from the
+    // precision so far, since the confidence interval narrows with the square root of the number
+    // of samples, but never more than doubles the samples or overruns the budget by much.
+    //
+    // The stopping rule runs after every batch, so it uses the closed-form interval of running
+    // statistics, at constant cost per sample. The bootstrap interval is left to the final report.
+    //
+    std::vector<InvocationResult> time_adaptively(clspv_utils::kernel&    kernel,
+                                                  const KernelTest&       kernelTest,
+                                                  const InvocationTest&   invocationTest) {
+        StopWatch watch;
+
+        std::vector<InvocationResult> results;
+        unsigned int warmupIterations = kernelTest.mWarmupIterations;
+        unsigned int iterationsRun = 0;
+        unsigned int batch = std::max(kernelTest.mTimingIterations, 2u);
+        benchmark_stats::running_t executionTimes;
+        const std::uint32_t timestampValidBits = kernel.getDevice().getComputeQueueFamilyProperties().timestampValidBits;
+
+        for (;;) {
+            auto batchResults = time_batch(kernel, kernelTest, invocationTest, warmupIterations, batch);
+            iterationsRun += warmupIterations + batch;
+            warmupIterations = 0;
+            add_execution_times(executionTimes, batchResults, timestampValidBits);
+            results.insert(results.end(), batchResults.begin(), batchResults.end());
+
+            const double precision = (executionTimes.mMean > 0.0 ? benchmark_stats::mean_half_width(executionTimes) / executionTimes.mMean : 0.0);
+            const double elapsed_s = watch.getSplitTime().count();
+            if (precision <= kernelTest.mTargetPrecision
+                || elapsed_s >= kernelTest.mTimeBudget_s
+                || results.size() >= kMaxAdaptiveIterations) {
+                break;
+            }
+
+            const double needed = results.size() * (precision / kernelTest.mTargetPrecision) * (precision / kernelTest.mTargetPrecision);
+            const double affordable = (kernelTest.mTimeBudget_s - elapsed_s) / (elapsed_s / iterationsRun);
+
+            double next = std::min(needed - results.size(), static_cast<double>(results.size()));
+            next = std::min(next, affordable);
+            next = std::min(next, static_cast<double>(kMaxAdaptiveIterations - results.size()));
+            batch = std::max(static_cast<unsigned int>(next), 1u);
+        }
+
+        return results;
+    }
+
     InvocationResult failTestFn(clspv_utils::kernel &kernel,
                                 const std::vector<std::string> &args,
                                 bool verbose) {
@@ -68,9 +227,12 @@ namespace test_utils {
         result.first = &kernelTest;
         result.second.mSkipped = false;
 
+        trace_events::scope kernelScope(trace_events::is_enabled() ? trace_events::intern(kernelTest.mEntryName) : "", "kernel");
+
         clspv_utils::kernel kernel;
 
 		try {
+            trace_events::scope compileScope("pipeline compile", "kernel");
 	        kernel = clspv_utils::kernel(module.createKernelReq(kernelTest.mEntryName), kernelTest.mWorkgroupSize);
             result.second.mCompiledCorrectly = true;
 		}
@@ -80,7 +242,14 @@ namespace test_utils {
 
         if (!kernelTest.mInvocationTests.empty()) {
             try {
+                set_verification(kernelTest.mVerification, kernelTest.mVerificationSamples);
+
                 for (auto &oneTest : kernelTest.mInvocationTests) {
+                    const std::string identity = invocation_identity(kernelTest, oneTest);
+                    start_random_sequence(identity);
+                    start_golden_sequence();
+                    take_device_comparison_count();
+
                     std::vector<InvocationResult> invocationResults;
                     if (!result.second.mCompiledCorrectly)
                     {
@@ -88,11 +257,24 @@ namespace test_utils {
                     }
                     else if (0 == kernelTest.mTimingIterations)
                     {
+                        kernel.getDevice().calibrateTimestamps();
                         invocationResults.push_back(oneTest.mTestFn(kernel, kernelTest.mArguments, kernelTest.mIsVerbose));
                     }
+                    else if (0.0 < kernelTest.mTargetPrecision)
+                    {
+                        invocationResults = time_adaptively(kernel, kernelTest, oneTest);
+                    }
                     else
                     {
-                        invocationResults = oneTest.mTimeFn(kernel, kernelTest.mArguments, kernelTest.mTimingIterations, kernelTest.mIsVerbose);
+                        invocationResults = time_batch(kernel, kernelTest, oneTest, kernelTest.mWarmupIterations, kernelTest.mTimingIterations);
+                    }
+
+                    // tests whose results are not both in device buffers quietly compare on the host
+                    if (result.second.mCompiledCorrectly
+                        && get_device_verifier()
+                        && 0 == take_device_comparison_count()
+                        && !invocationResults.empty()) {
+                        invocationResults.front().mEvaluation.mMessages.push_back("verify device does not apply to this test; its results were compared on the host");
                     }
 
                     for (auto& oneResult : invocationResults) {
@@ -108,36 +290,58 @@ namespace test_utils {
         return result;
     }
 
-    ModuleTest::result test_module(clspv_utils::device& inDevice,
-                                   const ModuleTest&    moduleTest) {
+    clspv_utils::module::spec_ptr load_module_spec(const std::string&            moduleName,
+                                                   clspv_utils::module_cache&    moduleCache) {
+        return with_spvmap(moduleName, [&moduleCache](const void* spvmap, std::size_t numBytes) {
+            return moduleCache.getModuleSpec(spvmap, numBytes);
+        });
+    }
+
+    clspv_utils::module::spec_ptr get_module_spec(const ModuleTest&                 moduleTest,
+                                                  clspv_utils::module_cache&        moduleCache,
+                                                  const std::vector<std::uint32_t>& spvWords) {
+        if (ModuleTest::reflection_off == moduleTest.mReflection) {
+            return load_module_spec(moduleTest.mName, moduleCache);
+        }
+
+        const auto mode = (ModuleTest::reflection_verify == moduleTest.mReflection
+                           ? clspv_utils::module_cache::reflection_verify
+                           : clspv_utils::module_cache::reflection_combine);
+
+        return with_spvmap(moduleTest.mName, [&moduleCache, &spvWords, mode](const void* spvmap, std::size_t numBytes) {
+            return moduleCache.getModuleSpec(spvWords, spvmap, numBytes, mode);
+        });
+    }
+
+    ModuleTest::result test_module(clspv_utils::device&         inDevice,
+                                   const ModuleTest&            moduleTest,
+                                   clspv_utils::module_cache&   moduleCache) {
         ModuleTest::result result;
         result.first = &moduleTest;
 
+        trace_events::scope moduleScope(trace_events::is_enabled() ? trace_events::intern(moduleTest.mName) : "", "module");
+
         try {
-            file_utils::AndroidAssetStream spvmapStream(moduleTest.mName + ".spvmap");
-            if (!spvmapStream.good())
+            std::vector<std::uint32_t> spvWords;
             {
-                throw std::runtime_error("cannot open spvmap for " + moduleTest.mName);
+                trace_events::scope scope("module load", "module");
+                file_utils::read_file_contents(moduleTest.mName + ".spv", spvWords);
             }
 
-            // spvmap files may have been generated on a system which uses different line ending
-            // conventions than the system on which the consumer runs. Safer to fetch lines
-            // using a function which recognizes multiple line endings.
-            crlf_savvy::crlf_filter_buffer filter(spvmapStream.rdbuf());
-            spvmapStream.rdbuf(&filter);
-
-            clspv_utils::module_spec_t moduleInterface = clspv_utils::createModuleSpec(spvmapStream);
-            spvmapStream.close();
+            clspv_utils::module::spec_ptr spec;
+            {
+                trace_events::scope scope("spvmap parse", "module");
+                spec = get_module_spec(moduleTest, moduleCache, spvWords);
+            }
 
-            file_utils::AndroidAssetStream spvStream(moduleTest.mName + ".spv");
-            if (!spvStream.good())
+            clspv_utils::module::shader_ptr shader;
             {
-                throw std::runtime_error("cannot open spv for " + moduleTest.mName);
+                trace_events::scope scope("shader module creation", "module");
+                shader = moduleCache.getShaderObjects(inDevice.getDevice(), spvWords);
             }
 
-            clspv_utils::module module(spvStream, inDevice, moduleInterface);
+            clspv_utils::module module(inDevice, spec, shader);
             result.second.mLoadedCorrectly = true;
-            spvStream.close();
 
             auto entryPoints = module.getEntryPoints();
             for (const auto& ep : entryPoints) {
@@ -165,6 +369,8 @@ namespace test_utils {
                     } else {
                         result.second.mKernelResults.push_back(test_kernel(module, *epTest));
                     }
+
+                    notify_kernel_observer(moduleTest, result.second.mKernelResults.back());
                 }
             }
         }
@@ -198,6 +404,187 @@ namespace test_utils {
         return endTime - mStartTime;
     }
 
+    void set_evaluation_threads(unsigned int numThreads)
+    {
+        std::lock_guard<std::mutex> lock(gEvaluationPoolMutex);
+
+        if (numThreads != gEvaluationThreads) {
+            gEvaluationThreads = numThreads;
+
+            // evaluations already holding the old pool keep it until they finish
+            gEvaluationPool.reset();
+        }
+    }
+
+    std::shared_ptr<thread_pool::pool> get_evaluation_pool()
+    {
+        std::lock_guard<std::mutex> lock(gEvaluationPoolMutex);
+
+        if (!gEvaluationPool) {
+            gEvaluationPool = std::make_shared<thread_pool::pool>(gEvaluationThreads);
+        }
+
+        return gEvaluationPool;
+    }
+
+    void set_random_seed(std::uint64_t seed)
+    {
+        std::lock_guard<std::mutex> lock(gRandomMutex);
+        gRandomSeed = seed;
+    }
+
+    void start_random_sequence(const std::string& identity)
+    {
+        std::lock_guard<std::mutex> lock(gRandomMutex);
+        gRandomIdentity = identity;
+        gRandomSequence = hash_identity(identity);
+        gRandomSequenceLength = 0;
+    }
+
+    std::string get_invocation_key()
+    {
+        std::lock_guard<std::mutex> lock(gRandomMutex);
+
+        std::ostringstream os;
+        os << gRandomIdentity << " seed:" << gRandomSeed;
+        return os.str();
+    }
+
+    std::string get_invocation_identity()
+    {
+        std::lock_guard<std::mutex> lock(gRandomMutex);
+        return gRandomIdentity;
+    }
+
+    bool invocation_uses_random_inputs()
+    {
+        std::lock_guard<std::mutex> lock(gRandomMutex);
+        return (0 < gRandomSequenceLength);
+    }
+
+    random_utils::stream_t next_random_stream()
+    {
+        std::lock_guard<std::mutex> lock(gRandomMutex);
+
+        random_utils::stream_t result;
+        result.mSeed = gRandomSeed;
+        result.mStream = gRandomSequence + gRandomSequenceLength++;
+        return result;
+    }
+
+    void set_device_verifier(std::shared_ptr<device_verify::verifier> verifier)
+    {
+        std::lock_guard<std::mutex> lock(gVerificationMutex);
+        gDeviceVerifier = verifier;
+    }
+
+    void set_verification(KernelTest::verification verification, unsigned int numSamples)
+    {
+        std::lock_guard<std::mutex> lock(gVerificationMutex);
+        gVerification = verification;
+        gVerificationSamples = numSamples;
+    }
+
+    unsigned int get_verification_samples()
+    {
+        std::lock_guard<std::mutex> lock(gVerificationMutex);
+        return (KernelTest::verification_sampled == gVerification ? gVerificationSamples : 0);
+    }
+
+    std::shared_ptr<device_verify::verifier> get_device_verifier()
+    {
+        std::lock_guard<std::mutex> lock(gVerificationMutex);
+        return (KernelTest::verification_device == gVerification ? gDeviceVerifier : nullptr);
+    }
+
+    void note_device_comparison()
+    {
+        std::lock_guard<std::mutex> lock(gVerificationMutex);
+        ++gDeviceComparisonCount;
+    }
+
+    unsigned int take_device_comparison_count()
+    {
+        std::lock_guard<std::mutex> lock(gVerificationMutex);
+        const unsigned int result = gDeviceComparisonCount;
+        gDeviceComparisonCount = 0;
+        return result;
+    }
+
+    void start_golden_sequence()
+    {
+        std::lock_guard<std::mutex> lock(gGoldenMutex);
+        gGoldenSequenceLength = 0;
+    }
+
+    bool next_golden_key(std::string* key)
+    {
+        {
+            std::lock_guard<std::mutex> lock(gVerificationMutex);
+            if (KernelTest::verification_golden != gVerification) {
+                return false;
+            }
+        }
+
+        // results of an invocation which drew no random inputs are the same whatever the seed, so
+        // only those of one which did are keyed on it
+        const std::string invocation = (invocation_uses_random_inputs() ? get_invocation_key() : get_invocation_identity());
+
+        std::lock_guard<std::mutex> lock(gGoldenMutex);
+        std::ostringstream os;
+        os << invocation << " check:" << gGoldenSequenceLength++;
+        *key = os.str();
+        return true;
+    }
+
+    bool matches_golden_hash(const std::string& key, std::uint64_t hash)
+    {
+        std::lock_guard<std::mutex> lock(gGoldenMutex);
+        gGoldenKeysUsed.insert(key);
+        const auto found = gGoldenHashes.find(key);
+        return (found != gGoldenHashes.end() && found->second == hash);
+    }
+
+    void record_golden_hash(const std::string& key, std::uint64_t hash)
+    {
+        std::lock_guard<std::mutex> lock(gGoldenMutex);
+        gGoldenKeysUsed.insert(key);
+        gGoldenHashes[key] = hash;
+    }
+
+    void read_golden_hashes(std::istream& is)
+    {
+        std::lock_guard<std::mutex> lock(gGoldenMutex);
+
+        std::string line;
+        while (std::getline(is, line)) {
+            std::istringstream in_line(line);
+
+            std::uint64_t hash;
+            std::string key;
+            if ((in_line >> std::hex >> hash) && std::getline(in_line >> std::ws, key) && !key.empty()) {
+                gGoldenHashes[key] = hash;
+            }
+        }
+    }
+
+    void write_golden_hashes(std::ostream& os)
+    {
+        std::lock_guard<std::mutex> lock(gGoldenMutex);
+
+        // only the keys this run checked are kept, so that hashes for tests, variations or seeds
+        // no longer run do not accumulate
+        for (const auto& golden : gGoldenHashes) {
+            if (0 == gGoldenKeysUsed.count(golden.first)) {
+                continue;
+            }
+
+            os << std::hex << std::setw(16) << std::setfill('0') << golden.second << ' ' << golden.first << '\n';
+        }
+    }
+
+    const std::size_t Evaluation::kMaxMismatches;
+
     Evaluation& Evaluation::operator+=(const Evaluation& other)
     {
         mSkipped |= other.mSkipped;
@@ -206,6 +593,10 @@ namespace test_utils {
         mNumErrors += other.mNumErrors;
         mMessages.insert(mMessages.end(), other.mMessages.begin(), other.mMessages.end());
 
+        const std::size_t numMismatches = std::min(other.mMismatches.size(),
+                                                   kMaxMismatches - std::min(mMismatches.size(), kMaxMismatches));
+        mMismatches.insert(mMismatches.end(), other.mMismatches.begin(), other.mMismatches.begin() + numMismatches);
+
         return *this;
     }
 
@@ -217,13 +608,23 @@ namespace test_utils {
         InvocationResult invocationResult;
 
         invocationResult.mParameters = test.getParameterString();
+        invocationResult.mNumPixels = count_pixels(test.getExtent());
+        invocationResult.mWorkload = test.getWorkload();
 
-        test.prepare();
+        StopWatch watch;
+        {
+            trace_events::scope scope("prepare", "invocation");
+            test.prepare();
+        }
+        invocationResult.mPrepareTime = watch.getSplitTime();
 
         invocationResult.mExecutionTime = test.run(kernel);
 
-        StopWatch watch;
-        invocationResult.mEvaluation = test.evaluate(verbose);
+        watch.restart();
+        {
+            trace_events::scope scope("evaluate", "invocation");
+            invocationResult.mEvaluation = test.evaluate(verbose);
+        }
         invocationResult.mEvalTime = watch.getSplitTime();
 
         return invocationResult;
@@ -239,11 +640,18 @@ namespace test_utils {
 
         InvocationResult oneResult;
         oneResult.mParameters = test.getParameterString();
+        oneResult.mNumPixels = count_pixels(test.getExtent());
+        oneResult.mWorkload = test.getWorkload();
         oneResult.mEvaluation.mNumCorrect = 1;  // timing tests always succeed trivially
 
         for (unsigned int i = iterations; i > 0; --i)
         {
-            test.prepare();
+            StopWatch watch;
+            {
+                trace_events::scope scope("prepare", "invocation");
+                test.prepare();
+            }
+            oneResult.mPrepareTime = watch.getSplitTime();
             oneResult.mExecutionTime = test.run(kernel);
 
             results.push_back(oneResult);
@@ -252,6 +660,133 @@ namespace test_utils {
         return results;
     }
 
+    std::vector<InvocationResult> throughput_test(clspv_utils::kernel&             kernel,
+                                                  const std::vector<std::string>&  args,
+                                                  unsigned int                     iterations,
+                                                  bool                             verbose,
+                                                  Test&                            test)
+    {
+        InvocationResult oneResult;
+        oneResult.mParameters = test.getParameterString();
+        oneResult.mNumPixels = count_pixels(test.getExtent());
+        oneResult.mWorkload = test.getWorkload();
+        oneResult.mEvaluation.mNumCorrect = 1;  // timing tests always succeed trivially
+
+        StopWatch watch;
+        {
+            trace_events::scope scope("prepare", "invocation");
+            test.prepare();
+        }
+        const StopWatch::duration prepareTime = watch.getSplitTime();
+
+        clspv_utils::execution_time_t submission;
+        kernel.setNumDispatches(iterations);
+        try {
+            submission = test.run(kernel);
+        }
+        catch (...) {
+            kernel.setNumDispatches(1);
+            throw;
+        }
+        kernel.setNumDispatches(1);
+
+        if (submission.dispatches.empty()) {
+            // a single dispatch, whose timestamps are already those of the submission
+            oneResult.mPrepareTime = prepareTime;
+            oneResult.mExecutionTime = submission;
+            return std::vector<InvocationResult>(1, oneResult);
+        }
+
+        //
+        // Each dispatch is charged with the barrier that precedes it, and the last with the barrier
+        // that follows it, so the per-dispatch times add up to the time of the whole submission.
+        // Wall clock time, and the host time of every phase, is shared equally. Latencies are those
+        // of the whole submission.
+        //
+        std::vector<InvocationResult> results;
+        results.reserve(submission.dispatches.size());
+
+        const auto& dispatches = submission.dispatches;
+        oneResult.mPrepareTime = prepareTime / dispatches.size();
+        for (std::size_t i = 0; i < dispatches.size(); ++i) {
+            auto& time = oneResult.mExecutionTime;
+            time.cpu_duration = submission.cpu_duration / dispatches.size();
+            time.descriptor_update_duration = submission.descriptor_update_duration / dispatches.size();
+            time.record_duration = submission.record_duration / dispatches.size();
+            time.submit_duration = submission.submit_duration / dispatches.size();
+            time.wait_duration = submission.wait_duration / dispatches.size();
+            time.has_latency = submission.has_latency;
+            time.submission_latency = submission.submission_latency;
+            time.completion_latency = submission.completion_latency;
+            time.calibration_error = submission.calibration_error;
+            time.timestamps.start = (0 == i ? submission.timestamps.start : dispatches[i - 1].end);
+            time.timestamps.host_barrier = dispatches[i].start;
+            time.timestamps.execution = dispatches[i].end;
+            time.timestamps.gpu_barrier = (dispatches.size() - 1 == i ? submission.timestamps.gpu_barrier : dispatches[i].end);
+
+            results.push_back(oneResult);
+        }
+
+        return results;
+    }
+
+    void set_kernel_observer(kernel_observer observer)
+    {
+        std::lock_guard<std::mutex> lock(gObserverMutex);
+        gKernelObserver = observer;
+    }
+
+    std::uint64_t count_pixels(const vk::Extent3D& extent)
+    {
+        return static_cast<std::uint64_t>(extent.width) * extent.height * extent.depth;
+    }
+
+    vk::Extent3D read_extent_args(const std::vector<std::string>&   args,
+                                  vk::Extent3D                      defaultExtent,
+                                  unsigned int                      numDimensions,
+                                  std::size_t                       bytesPerPixel,
+                                  const clspv_utils::device&        device,
+                                  const std::string&                testName)
+    {
+        const char* const options[] = { "-w", "-h", "-d" };
+        std::uint32_t* const dimensions[] = { &defaultExtent.width, &defaultExtent.height, &defaultExtent.depth };
+
+        for (auto arg = args.begin(); arg != args.end(); arg = std::next(arg)) {
+            for (unsigned int d = 0; d < 3; ++d) {
+                if (*arg != options[d]) continue;
+
+                arg = std::next(arg);
+                if (arg == args.end()) throw std::runtime_error("badly formed arguments to " + testName + " test");
+
+                if (d >= numDimensions) {
+                    throw std::runtime_error(testName + " test does not take " + options[d]);
+                }
+
+                char* end = nullptr;
+                errno = 0;
+                const unsigned long long value = std::strtoull(arg->c_str(), &end, 10);
+                if (arg->empty() || '-' == (*arg)[0] || *end || ERANGE == errno
+                    || 0 == value || value > static_cast<unsigned long long>(std::numeric_limits<std::int32_t>::max())) {
+                    throw std::runtime_error("bad size " + *arg + " for " + testName + " test");
+                }
+                *dimensions[d] = static_cast<std::uint32_t>(value);
+                break;
+            }
+        }
+
+        const std::uint64_t numPixels = count_pixels(defaultExtent);
+        const std::uint64_t maxBytes = std::min<std::uint64_t>(device.getPhysicalDevice().getProperties().limits.maxStorageBufferRange,
+                                                               std::numeric_limits<std::size_t>::max());
+        if (numPixels > maxBytes / bytesPerPixel) {
+            std::ostringstream os;
+            os << testName << " test extent " << defaultExtent.width << 'x' << defaultExtent.height << 'x' << defaultExtent.depth
+               << " needs more than the " << maxBytes << " bytes a storage buffer can hold";
+            throw std::runtime_error(os.str());
+        }
+
+        return defaultExtent;
+    }
+
     Test::Test()
     {
 
@@ -267,6 +802,16 @@ namespace test_utils {
         return std::string();
     }
 
+    vk::Extent3D Test::getExtent() const
+    {
+        return vk::Extent3D(0, 0, 0);
+    }
+
+    Workload Test::getWorkload() const
+    {
+        return Workload();
+    }
+
     void Test::prepare()
     {
 
@@ -5,17 +5,26 @@
 #ifndef CLSPVTEST_TEST_UTILS_HPP
 #define CLSPVTEST_TEST_UTILS_HPP
 
+#include "bulk_compare.hpp"
 #include "clspv_utils/invocation.hpp"
 #include "clspv_utils/kernel.hpp"
+#include "clspv_utils/module.hpp"
+#include "content_hash.hpp"
+#include "device_verify.hpp"
 #include "fp_utils.hpp"
 #include "gpu_types.hpp"
 #include "pixels.hpp"
+#include "random_utils.hpp"
+#include "thread_pool.hpp"
+#include "vulkan_utils/vulkan_utils.hpp"
 
 #include <vulkan/vulkan.hpp>
 
+#include <algorithm>
 #include <cmath>
+#include <cstdint>
 #include <functional>
-#include <random>
+#include <memory>
 #include <sstream>
 #include <string>
 #include <type_traits>
@@ -23,7 +32,79 @@
 
 namespace test_utils {
 
+    struct Evaluation {
+        // number of incorrect pixels whose coordinates (and, when verbose, messages) are recorded
+        static const std::size_t        kMaxMismatches = 64;
+
+        bool                            mSkipped    = false;
+        unsigned int                    mNumCorrect = 0;
+        unsigned int                    mNumErrors  = 0;
+        std::vector<std::string>        mMessages;
+        std::vector<vk::Extent3D>       mMismatches;
+
+        Evaluation& operator+=(const Evaluation& other);
+    };
+
+    template<typename ExpectedPixelType, typename ObservedPixelType>
+    Evaluation evaluate_result(ExpectedPixelType expected_pixel,
+                               ObservedPixelType observed_pixel,
+                               vk::Extent3D      coord,
+                               bool              verbose);
+
+    // Sets the number of host threads check_results and fill_random_pixels use; 0 selects one
+    // thread per core.
+    void set_evaluation_threads(unsigned int numThreads);
+
+    // The pool shared by result evaluation and random fills
+    std::shared_ptr<thread_pool::pool> get_evaluation_pool();
+
+    // Sets the seed for the inputs tests generate with fill_random_pixels
+    void set_random_seed(std::uint64_t seed);
+
+    // Starts a new sequence of random fills. Each test invocation starts its own sequence, keyed on
+    // the invocation's identity, so that running it alone reproduces the inputs it had in a larger run.
+    void start_random_sequence(const std::string& identity);
+
+    // The stream for the next random fill in the current sequence
+    random_utils::stream_t next_random_stream();
+
+    // Identifies the current test invocation by the identity of its random sequence and the seed,
+    // for keying results derived from it
+    std::string get_invocation_key();
+
+    // Identifies the current test invocation without the seed, for keying results which do not
+    // depend on the random inputs
+    std::string get_invocation_identity();
+
+    // Whether the current test invocation has drawn any random streams since its sequence started
+    bool invocation_uses_random_inputs();
+
+    // Starts a new sequence of golden result checks for the current invocation, so that each
+    // check_results call in it has its own golden hash
+    void start_golden_sequence();
+
+    // The key for the next check_results call in the current sequence. Returns false, and leaves
+    // the key untouched, unless the current test requested golden verification.
+    bool next_golden_key(std::string* key);
+
+    // Whether the hash is the one recorded for the key by a previous, fully checked, result
+    bool matches_golden_hash(const std::string& key, std::uint64_t hash);
+
+    void record_golden_hash(const std::string& key, std::uint64_t hash);
+
+    // Golden hashes are saved as lines of "hash key", so that they can outlive the process. Only
+    // the hashes of keys checked since they were read are written back.
+    void read_golden_hashes(std::istream& is);
+    void write_golden_hashes(std::ostream& os);
+
+    // The number of pixels check_results samples, or 0 unless the current test requested sampled
+    // verification
+    unsigned int get_verification_samples();
+
     namespace details {
+        // ULP tolerance for float and half pixel components
+        const int kFloatUlpTolerance = 2;
+
         template<typename ExpectedPixelType, typename ObservedPixelType>
         struct pixel_promotion {
             static constexpr const int expected_vec_size = pixels::traits<ExpectedPixelType>::num_components;
@@ -59,16 +140,14 @@ namespace test_utils {
         template<>
         struct pixel_comparator<float> {
             static bool is_equal(float l, float r) {
-                const int ulp = 2;
-                return fp_utils::almost_equal(l, r, ulp);
+                return fp_utils::almost_equal(l, r, kFloatUlpTolerance);
             }
         };
 
         template<>
         struct pixel_comparator<gpu_types::half> {
             static bool is_equal(gpu_types::half l, gpu_types::half r) {
-                const int ulp = 2;
-                return fp_utils::almost_equal(l, r, ulp);
+                return fp_utils::almost_equal(l, r, kFloatUlpTolerance);
             }
         };
 
@@ -98,6 +177,416 @@ namespace test_utils {
                        && pixel_comparator<T>::is_equal(l.w, r.w);
             }
         };
+
+        //
+        // bulk_comparator compares runs of components; isEqual[i] receives 1 if the i'th components
+        // compare equal under pixel_comparator, and 0 otherwise.
+        //
+
+        template<typename T>
+        struct bulk_comparator {
+            static void compare(const T* expected, const T* observed, std::size_t count, std::uint8_t* isEqual) {
+                for (std::size_t i = 0; i < count; ++i) {
+                    isEqual[i] = pixel_comparator<T>::is_equal(expected[i], observed[i]);
+                }
+            }
+        };
+
+        template<>
+        struct bulk_comparator<float> {
+            static void compare(const float* expected, const float* observed, std::size_t count, std::uint8_t* isEqual) {
+                bulk_compare::compare_components(expected, observed, count, kFloatUlpTolerance, isEqual);
+            }
+        };
+
+        template<>
+        struct bulk_comparator<gpu_types::half> {
+            static void compare(const gpu_types::half* expected, const gpu_types::half* observed, std::size_t count, std::uint8_t* isEqual) {
+                bulk_compare::compare_components(expected, observed, count, kFloatUlpTolerance, isEqual);
+            }
+        };
+
+        template<>
+        struct bulk_comparator<gpu_types::uchar> {
+            static void compare(const gpu_types::uchar* expected, const gpu_types::uchar* observed, std::size_t count, std::uint8_t* isEqual) {
+                bulk_compare::compare_components(expected, observed, count, isEqual);
+            }
+        };
+
+        template<>
+        struct bulk_comparator<std::int32_t> {
+            static void compare(const std::int32_t* expected, const std::int32_t* observed, std::size_t count, std::uint8_t* isEqual) {
+                bulk_compare::compare_components(expected, observed, count, isEqual);
+            }
+        };
+
+        template<typename ExpectedPixelType, typename ObservedPixelType, typename PromotionType>
+        std::string mismatch_message(const ExpectedPixelType&  expected_pixel,
+                                     const ObservedPixelType&  observed_pixel,
+                                     const PromotionType&      expected,
+                                     const PromotionType&      observed,
+                                     vk::Extent3D              coord) {
+            std::ostringstream os;
+            os << "INCORRECT"
+               << ": pixel{x:" << coord.width << ", y:" << coord.height << ", z:" << coord.depth << "}"
+               << " expected:" << pixels::traits<ExpectedPixelType>::toString(expected_pixel)
+               << " observed:" << pixels::traits<ObservedPixelType>::toString(observed_pixel)
+               << " expectedPromotion:" << pixels::traits<PromotionType>::toString(expected)
+               << " observedPromotion:" << pixels::traits<PromotionType>::toString(observed);
+            return os.str();
+        }
+
+        //
+        // Checks rows of pixels at a time. Each row is promoted into reusable buffers, compared
+        // component-wise by bulk_comparator, and the component results are folded into per-pixel
+        // counts. Only the first Evaluation::kMaxMismatches incorrect pixels are recorded, and
+        // messages are only formatted for those.
+        //
+        template<typename ExpectedPixelType, typename ObservedPixelType>
+        class row_checker {
+        public:
+            typedef typename pixel_promotion<ExpectedPixelType, ObservedPixelType>::promotion_type promotion_type;
+            typedef typename pixels::traits<promotion_type>::component_t component_type;
+
+            static constexpr const int num_components = pixels::traits<promotion_type>::num_components;
+            static_assert(sizeof(promotion_type) == num_components * sizeof(component_type),
+                          "promoted pixels must be tightly packed components");
+
+            explicit row_checker(std::uint32_t width)
+                    : mExpected(width), mObserved(width), mIsEqual(width * num_components) {
+            }
+
+            // expected_stride is 1 for a row of expected pixels, or 0 to compare against a single pixel
+            void load_expected(const ExpectedPixelType* expected_row, int expected_stride) {
+                auto p = expected_row;
+                for (auto& e : mExpected) {
+                    e = pixels::traits<promotion_type>::translate(*p);
+                    p += expected_stride;
+                }
+            }
+
+            void check_row(const ExpectedPixelType*    expected_row,
+                           int                         expected_stride,
+                           const ObservedPixelType*    observed_row,
+                           vk::Extent3D                coord,
+                           bool                        verbose,
+                           Evaluation&                 result) {
+                std::transform(observed_row, observed_row + mObserved.size(), mObserved.begin(), [](const ObservedPixelType& p) {
+                    return pixels::traits<promotion_type>::translate(p);
+                });
+
+                bulk_comparator<component_type>::compare(reinterpret_cast<const component_type*>(mExpected.data()),
+                                                         reinterpret_cast<const component_type*>(mObserved.data()),
+                                                         mIsEqual.size(),
+                                                         mIsEqual.data());
+
+                const std::uint8_t* isEqual = mIsEqual.data();
+                for (std::size_t x = 0; x < mObserved.size(); ++x, isEqual += num_components) {
+                    std::uint8_t pixel_is_correct = isEqual[0];
+                    for (int c = 1; c < num_components; ++c) {
+                        pixel_is_correct &= isEqual[c];
+                    }
+
+                    if (pixel_is_correct) {
+                        ++result.mNumCorrect;
+                    }
+                    else {
+                        ++result.mNumErrors;
+
+                        if (result.mMismatches.size() < Evaluation::kMaxMismatches) {
+                            coord.width = static_cast<std::uint32_t>(x);
+                            result.mMismatches.push_back(coord);
+
+                            if (verbose) {
+                                result.mMessages.push_back(mismatch_message(expected_row[x * expected_stride],
+                                                                            observed_row[x],
+                                                                            mExpected[x],
+                                                                            mObserved[x],
+                                                                            coord));
+                            }
+                        }
+                    }
+                }
+            }
+
+        private:
+            std::vector<promotion_type> mExpected;
+            std::vector<promotion_type> mObserved;
+            std::vector<std::uint8_t>   mIsEqual;
+        };
+
+        // smallest number of pixels worth handing to another thread
+        const std::size_t kMinPixelsPerTask = 16 * 1024;
+
+        // tasks per evaluation thread, so that threads finishing early can pick up more rows
+        const std::size_t kTasksPerThread = 4;
+
+        // checks rows [first_row, last_row), counting rows across all slices of the extent
+        template<typename ExpectedPixelType, typename ObservedPixelType>
+        Evaluation check_row_range(const ExpectedPixelType*    expected_pixels,
+                                   int                         expected_pitch,
+                                   int                         expected_stride,
+                                   const ObservedPixelType*    observed_pixels,
+                                   vk::Extent3D                extent,
+                                   int                         pitch,
+                                   bool                        verbose,
+                                   std::size_t                 first_row,
+                                   std::size_t                 last_row) {
+            Evaluation result;
+
+            row_checker<ExpectedPixelType, ObservedPixelType> checker(extent.width);
+
+            auto expected_row = expected_pixels + static_cast<std::ptrdiff_t>(first_row) * expected_pitch;
+            auto observed_row = observed_pixels + static_cast<std::ptrdiff_t>(first_row) * pitch;
+            bool expected_is_loaded = false;
+            for (std::size_t row = first_row; row < last_row; ++row, expected_row += expected_pitch, observed_row += pitch) {
+                // a broadcast expected pixel only needs to be promoted once
+                if (!expected_is_loaded || 0 != expected_pitch) {
+                    checker.load_expected(expected_row, expected_stride);
+                    expected_is_loaded = true;
+                }
+
+                const vk::Extent3D coord(0,
+                                         static_cast<std::uint32_t>(row % extent.height),
+                                         static_cast<std::uint32_t>(row / extent.height));
+                checker.check_row(expected_row, expected_stride, observed_row, coord, verbose, result);
+            }
+
+            return result;
+        }
+
+        //
+        // Large extents are split into runs of rows which are checked on the evaluation pool. The
+        // partial results are merged in row order, so the counts, mismatches, and messages are the
+        // same regardless of the number of threads.
+        //
+        template<typename ExpectedPixelType, typename ObservedPixelType>
+        Evaluation check_all_rows(const ExpectedPixelType*    expected_pixels,
+                                  int                         expected_pitch,
+                                  int                         expected_stride,
+                                  const ObservedPixelType*    observed_pixels,
+                                  vk::Extent3D                extent,
+                                  int                         pitch,
+                                  bool                        verbose) {
+            Evaluation result;
+            if (0 == extent.width) return result;
+
+            const std::size_t num_rows = static_cast<std::size_t>(extent.height) * extent.depth;
+            const std::size_t num_pixels = num_rows * extent.width;
+
+            std::shared_ptr<thread_pool::pool> pool;
+            std::size_t num_tasks = 1;
+            if (num_pixels >= 2 * kMinPixelsPerTask) {
+                pool = get_evaluation_pool();
+                num_tasks = std::min(std::min(pool->size() * kTasksPerThread, num_pixels / kMinPixelsPerTask), num_rows);
+            }
+
+            if (num_tasks <= 1) {
+                result = check_row_range(expected_pixels, expected_pitch, expected_stride,
+                                         observed_pixels, extent, pitch, verbose,
+                                         0, num_rows);
+            }
+            else {
+                std::vector<Evaluation> partial_results(num_tasks);
+                pool->run(num_tasks, [&](std::size_t task) {
+                    partial_results[task] = check_row_range(expected_pixels, expected_pitch, expected_stride,
+                                                            observed_pixels, extent, pitch, verbose,
+                                                            num_rows * task / num_tasks,
+                                                            num_rows * (task + 1) / num_tasks);
+                });
+
+                for (const auto& partial : partial_results) {
+                    result += partial;
+                }
+
+                // each run of rows recorded its own first mismatches; keep those of the whole extent
+                if (verbose && result.mMessages.size() > result.mMismatches.size()) {
+                    result.mMessages.resize(result.mMismatches.size());
+                }
+            }
+
+            if (verbose && result.mNumErrors > result.mMismatches.size()) {
+                std::ostringstream os;
+                os << "... and " << (result.mNumErrors - result.mMismatches.size()) << " more incorrect pixels";
+                result.mMessages.push_back(os.str());
+            }
+
+            return result;
+        }
+
+        template<typename PixelType>
+        std::uint64_t hash_rows(const PixelType* pixels, vk::Extent3D extent, int pitch) {
+            content_hash::hasher hasher;
+
+            const std::uint32_t dimensions[] = { extent.width, extent.height, extent.depth };
+            hasher.update(dimensions, sizeof(dimensions));
+
+            const std::size_t num_rows = static_cast<std::size_t>(extent.height) * extent.depth;
+            const std::size_t row_size = extent.width * sizeof(PixelType);
+            if (static_cast<int>(extent.width) == pitch) {
+                hasher.update(pixels, num_rows * row_size);
+            }
+            else {
+                for (std::size_t row = 0; row < num_rows; ++row) {
+                    hasher.update(pixels + row * pitch, row_size);
+                }
+            }
+
+            return hasher.digest();
+        }
+
+        // upper bound of the Wilson score interval for the proportion num_errors / num_samples
+        inline double error_rate_upper_bound(unsigned int num_errors, unsigned int num_samples, double z) {
+            const double n = num_samples;
+            const double p = num_errors / n;
+            const double z2 = z * z;
+
+            const double centre = p + z2 / (2.0 * n);
+            const double spread = z * std::sqrt(p * (1.0 - p) / n + z2 / (4.0 * n * n));
+            return std::min(1.0, (centre + spread) / (1.0 + z2 / n));
+        }
+
+        //
+        // Checks one random pixel from each of num_samples equal runs of the extent, so the sample
+        // covers the whole extent, and reports a bound on the error rate of the whole extent.
+        //
+        template<typename ExpectedPixelType, typename ObservedPixelType>
+        Evaluation check_sampled_rows(const ExpectedPixelType*    expected_pixels,
+                                      int                         expected_pitch,
+                                      int                         expected_stride,
+                                      const ObservedPixelType*    observed_pixels,
+                                      vk::Extent3D                extent,
+                                      int                         pitch,
+                                      bool                        verbose,
+                                      unsigned int                num_samples) {
+            Evaluation result;
+
+            const std::uint64_t num_pixels = static_cast<std::uint64_t>(extent.width) * extent.height * extent.depth;
+            const std::uint64_t stratum_size = num_pixels / num_samples;
+            const std::uint64_t num_larger_strata = num_pixels % num_samples;
+
+            const random_utils::stream_t stream = next_random_stream();
+            for (unsigned int s = 0; s < num_samples; ++s) {
+                std::uint32_t bits[4];
+                random_utils::philox4x32(stream, s, bits);
+                const std::uint64_t random = (static_cast<std::uint64_t>(bits[1]) << 32) | bits[0];
+
+                const std::uint64_t first = s * stratum_size + std::min<std::uint64_t>(s, num_larger_strata);
+                const std::uint64_t size = stratum_size + (s < num_larger_strata ? 1 : 0);
+                const std::uint64_t index = first + random % size;
+
+                const std::uint64_t row = index / extent.width;
+                const std::uint32_t x = static_cast<std::uint32_t>(index % extent.width);
+                const vk::Extent3D coord(x,
+                                         static_cast<std::uint32_t>(row % extent.height),
+                                         static_cast<std::uint32_t>(row / extent.height));
+
+                const bool record_mismatch = (result.mMismatches.size() < Evaluation::kMaxMismatches);
+                result += evaluate_result(expected_pixels[static_cast<std::ptrdiff_t>(row) * expected_pitch + static_cast<std::ptrdiff_t>(x) * expected_stride],
+                                          observed_pixels[static_cast<std::ptrdiff_t>(row) * pitch + x],
+                                          coord,
+                                          verbose && record_mismatch);
+            }
+
+            std::ostringstream os;
+            os << "sampled " << num_samples << " of " << num_pixels << " pixels, "
+               << result.mNumErrors << " incorrect; error rate at most "
+               << 100.0 * error_rate_upper_bound(result.mNumErrors, num_samples, 1.959964)
+               << "% (95% confidence)";
+            result.mMessages.push_back(os.str());
+
+            return result;
+        }
+
+        //
+        // With golden verification, observed pixels whose hash matches that of the last results
+        // to pass a full check are accepted without comparing them. With sampled verification,
+        // only a sample of the pixels is checked.
+        //
+        template<typename ExpectedPixelType, typename ObservedPixelType>
+        Evaluation check_rows(const ExpectedPixelType*    expected_pixels,
+                              int                         expected_pitch,
+                              int                         expected_stride,
+                              const ObservedPixelType*    observed_pixels,
+                              vk::Extent3D                extent,
+                              int                         pitch,
+                              bool                        verbose) {
+            const unsigned int num_samples = get_verification_samples();
+            if (0 < num_samples && num_samples < static_cast<std::uint64_t>(extent.width) * extent.height * extent.depth) {
+                return check_sampled_rows(expected_pixels, expected_pitch, expected_stride,
+                                          observed_pixels, extent, pitch, verbose, num_samples);
+            }
+
+            std::string golden_key;
+            std::uint64_t golden_hash = 0;
+            const bool is_golden = next_golden_key(&golden_key);
+            if (is_golden) {
+                golden_hash = hash_rows(observed_pixels, extent, pitch);
+                if (matches_golden_hash(golden_key, golden_hash)) {
+                    Evaluation result;
+                    result.mNumCorrect = extent.width * extent.height * extent.depth;
+                    return result;
+                }
+            }
+
+            Evaluation result = check_all_rows(expected_pixels, expected_pitch, expected_stride,
+                                               observed_pixels, extent, pitch, verbose);
+
+            if (is_golden && 0 == result.mNumErrors) {
+                record_golden_hash(golden_key, golden_hash);
+            }
+
+            return result;
+        }
+
+        template<typename T>
+        struct device_comparator {
+        };
+
+        template<>
+        struct device_comparator<float> {
+            static device_verify::summary_t compare(device_verify::verifier&       verifier,
+                                                    vulkan_utils::storage_buffer&  expected,
+                                                    vulkan_utils::storage_buffer&  observed,
+                                                    std::uint32_t                  num_pixels,
+                                                    int                            num_components) {
+                return verifier.compare_floats(expected, observed, num_pixels, num_components, false, kFloatUlpTolerance);
+            }
+        };
+
+        template<>
+        struct device_comparator<gpu_types::half> {
+            static device_verify::summary_t compare(device_verify::verifier&       verifier,
+                                                    vulkan_utils::storage_buffer&  expected,
+                                                    vulkan_utils::storage_buffer&  observed,
+                                                    std::uint32_t                  num_pixels,
+                                                    int                            num_components) {
+                return verifier.compare_floats(expected, observed, num_pixels, num_components, true, kFloatUlpTolerance);
+            }
+        };
+
+        template<>
+        struct device_comparator<gpu_types::uchar> {
+            static device_verify::summary_t compare(device_verify::verifier&       verifier,
+                                                    vulkan_utils::storage_buffer&  expected,
+                                                    vulkan_utils::storage_buffer&  observed,
+                                                    std::uint32_t                  num_pixels,
+                                                    int                            num_components) {
+                // the same off-by-one tolerance as pixel_comparator<gpu_types::uchar>
+                return verifier.compare_uchars(expected, observed, num_pixels, num_components, 1);
+            }
+        };
+
+        template<>
+        struct device_comparator<std::int32_t> {
+            static device_verify::summary_t compare(device_verify::verifier&       verifier,
+                                                    vulkan_utils::storage_buffer&  expected,
+                                                    vulkan_utils::storage_buffer&  observed,
+                                                    std::uint32_t                  num_pixels,
+                                                    int                            num_components) {
+                return verifier.compare_ints(expected, observed, num_pixels, num_components);
+            }
+        };
     }
 
     class StopWatch
@@ -115,22 +604,27 @@ namespace test_utils {
         clock::time_point   mStartTime;
     };
 
-    struct Evaluation {
-        bool                            mSkipped    = false;
-        unsigned int                    mNumCorrect = 0;
-        unsigned int                    mNumErrors  = 0;
-        std::vector<std::string>        mMessages;
-
-        Evaluation& operator+=(const Evaluation& other);
+    //
+    // The memory traffic and arithmetic of one run of a kernel, from which achieved bandwidth and
+    // operation rates follow. Bytes count what the kernel must move, not what caches end up
+    // fetching, and operations count floating point arithmetic written in the kernel source.
+    //
+    struct Workload {
+        std::uint64_t   mBytesRead      = 0;
+        std::uint64_t   mBytesWritten   = 0;
+        std::uint64_t   mOperations     = 0;
     };
 
     struct InvocationResult {
-        InvocationResult() : mEvalTime(0.0) {}
+        InvocationResult() : mNumPixels(0), mPrepareTime(0.0), mEvalTime(0.0) {}
 
         std::string                     mParameters;
+        std::uint64_t                   mNumPixels;     // pixels produced, for throughput; 0 if unknown
+        Workload                        mWorkload;      // of each run; empty if unknown
+        std::chrono::duration<double>   mPrepareTime;
         clspv_utils::execution_time_t   mExecutionTime;
         Evaluation                      mEvaluation;
-        std::chrono::duration<double>   mEvalTime;
+        std::chrono::duration<double>   mEvalTime;      // 0 for timed invocations, which are not evaluated
     };
 
     struct InvocationTest {
@@ -153,6 +647,7 @@ namespace test_utils {
         std::string mVariation;
         test_fn     mTestFn;
         time_fn     mTimeFn;
+        time_fn     mThroughputFn;
     };
 
     struct KernelResult {
@@ -169,14 +664,50 @@ namespace test_utils {
         typedef std::vector<InvocationTest>                 invocation_tests;
         typedef std::vector<std::string>                    test_arguments;
 
+        enum verification {
+            verification_full,      // compare every pixel on the host
+            verification_device,    // compare buffers on the device first, and on the host only if that fails
+            verification_golden,    // compare a hash of the results first, and the results only if that fails
+            verification_sampled    // compare a random sample of the results
+        };
+
+        enum timing {
+            timing_per_submission,  // submit and wait for each iteration separately
+            timing_throughput       // record every iteration into one submission
+        };
+
         std::string         mEntryName;
         vk::Extent3D        mWorkgroupSize;
         test_arguments      mArguments;
-        unsigned int        mTimingIterations   = 0;
-        bool                mIsVerbose          = false;
+        unsigned int        mTimingIterations       = 0;    // the first batch, for adaptive timing
+        unsigned int        mWarmupIterations       = 0;    // timed, but left out of the results
+        double              mTargetPrecision        = 0.0;  // adaptive timing: relative 95% CI half-width; 0 for a fixed count
+        double              mTimeBudget_s           = 0.0;  // adaptive timing: wall clock time after which to stop
+        std::string         mSweep;                         // the sweep this test is a point of; empty if none
+        std::string         mSweepSize;                     // the size of that point, as written in the sweep
+        bool                mIsCalibration          = false; // measures the peak bandwidth for roofline figures
+        timing              mTiming                 = timing_per_submission;
+        bool                mIsVerbose              = false;
+        verification        mVerification           = verification_full;
+        unsigned int        mVerificationSamples    = 0;    // for verification_sampled
         invocation_tests    mInvocationTests;
     };
 
+    // Sets the verifier used by tests which request device verification. Without one, those tests
+    // compare their results on the host.
+    void set_device_verifier(std::shared_ptr<device_verify::verifier> verifier);
+
+    // Sets the verification the current test requested
+    void set_verification(KernelTest::verification verification, unsigned int numSamples);
+
+    // The device verifier, if the current test requested device verification and one is available
+    std::shared_ptr<device_verify::verifier> get_device_verifier();
+
+    // Counts results compared with the device verifier, so that test_kernel can report tests which
+    // requested device verification but have no device buffers to compare. Taking the count resets it.
+    void         note_device_comparison();
+    unsigned int take_device_comparison_count();
+
     struct ModuleResult {
         typedef std::vector<KernelTest::result> results;
 
@@ -190,16 +721,49 @@ namespace test_utils {
         typedef std::pair<const ModuleTest*,ModuleResult>   result;
         typedef std::vector<KernelTest>                     kernel_tests;
 
+        enum reflection {
+            reflection_off,     // module interface comes from the spvmap alone
+            reflection_on,      // kernels and bindings come from the SPIR-V, the rest from the spvmap
+            reflection_verify   // use the spvmap, but fail the module if the SPIR-V disagrees
+        };
+
         std::string     mName;
+        reflection      mReflection     = reflection_off;
         kernel_tests    mKernelTests;
     };
 
+    // Called with the results of each kernel test as soon as they are complete
+    typedef std::function<void (const ModuleTest& moduleTest, const KernelTest::result& kernelResult)> kernel_observer;
+
+    // Sets the observer test_module calls; an empty function (the default) calls nothing
+    void set_kernel_observer(kernel_observer observer);
+
+    // Number of pixels in the extent, which may exceed 32 bits
+    std::uint64_t count_pixels(const vk::Extent3D& extent);
+
+    //
+    // Reads the size arguments kernel tests share, -w width, -h height and -d depth, over
+    // defaultExtent; other arguments are left to the test. A test whose kernel has fewer than three
+    // dimensions takes only the first numDimensions of these. Sizes are read as 64-bit values and
+    // rejected, rather than wrapped, if a dimension does not fit a kernel's int arguments or a
+    // buffer of bytesPerPixel pixels would exceed the device's storage buffer range or the host's
+    // address space.
+    //
+    vk::Extent3D read_extent_args(const std::vector<std::string>&   args,
+                                  vk::Extent3D                      defaultExtent,
+                                  unsigned int                      numDimensions,
+                                  std::size_t                       bytesPerPixel,
+                                  const clspv_utils::device&        device,
+                                  const std::string&                testName);
+
     class Test {
     public:
                 Test();
         virtual ~Test();
 
         virtual std::string getParameterString() const;
+        virtual vk::Extent3D getExtent() const;    // pixels each run produces; empty if not known
+        virtual Workload    getWorkload() const;    // traffic and arithmetic of each run; empty if not known
         virtual void        prepare();
         virtual clspv_utils::execution_time_t   run(clspv_utils::kernel& kernel) = 0;
         virtual Evaluation  evaluate(bool verbose);
@@ -231,15 +795,49 @@ namespace test_utils {
         });
     }
 
-    template <typename PixelType, typename OutputIterator>
-    void fill_random_pixels(OutputIterator first, OutputIterator last) {
-        std::random_device rd;
-        std::mt19937 gen(rd());
-        std::uniform_real_distribution<float> dis(0.0f, nextafterf(1.0f, std::numeric_limits<float>::max()));
+    //
+    // Fills [first, last) with pixels whose components are uniformly distributed in [0,1) before
+    // translation to PixelType. Pixel i is generated from counter i of the next random stream, so the
+    // contents depend only on the seed and the fill's place in its sequence, not on how the work is
+    // split across threads.
+    //
+    template <typename PixelType, typename RandomAccessIterator>
+    void fill_random_pixels(RandomAccessIterator first, RandomAccessIterator last) {
+        const random_utils::stream_t stream = next_random_stream();
+        const std::size_t num_pixels = static_cast<std::size_t>(last - first);
+
+        auto fill_range = [&](std::size_t range_begin, std::size_t range_end) {
+            const std::size_t kBlockSize = 256;
+            float block[4 * kBlockSize];
+
+            for (std::size_t i = range_begin; i < range_end; i += kBlockSize) {
+                const std::size_t count = std::min(kBlockSize, range_end - i);
+                random_utils::uniform_floats(stream, i, count, block);
+
+                const float* components = block;
+                auto dst = first + i;
+                for (std::size_t j = 0; j < count; ++j, components += 4, ++dst) {
+                    *dst = pixels::traits<PixelType>::translate(
+                            gpu_types::float4(components[0], components[1], components[2], components[3]));
+                }
+            }
+        };
 
-        std::generate(first, last, [&dis,&gen]() {
-            return pixels::traits<PixelType>::translate((gpu_types::float4){ dis(gen), dis(gen), dis(gen), dis(gen) });
-        });
+        std::size_t num_tasks = 1;
+        std::shared_ptr<thread_pool::pool> pool;
+        if (num_pixels >= 2 * details::kMinPixelsPerTask) {
+            pool = get_evaluation_pool();
+            num_tasks = std::min(pool->size() * details::kTasksPerThread, num_pixels / details::kMinPixelsPerTask);
+        }
+
+        if (num_tasks <= 1) {
+            fill_range(0, num_pixels);
+        }
+        else {
+            pool->run(num_tasks, [&](std::size_t task) {
+                fill_range(num_pixels * task / num_tasks, num_pixels * (task + 1) / num_tasks);
+            });
+        }
     }
 
     template<typename ExpectedPixelType, typename ObservedPixelType>
@@ -260,24 +858,9 @@ namespace test_utils {
         }
         else {
             ++result.mNumErrors;
+            result.mMismatches.push_back(coord);
             if (verbose) {
-                const std::string expectedString = pixels::traits<decltype(expected_pixel)>::toString(
-                        expected_pixel);
-                const std::string observedString = pixels::traits<decltype(observed_pixel)>::toString(
-                        observed_pixel);
-
-                const std::string expectedPromotionString = pixels::traits<decltype(expected)>::toString(
-                        expected);
-                const std::string observedPromotionString = pixels::traits<decltype(observed)>::toString(
-                        observed);
-
-                std::ostringstream os;
-                os << (pixel_is_correct ? "CORRECT  " : "INCORRECT")
-                   << ": pixel{x:" << coord.width << ", y:" << coord.height << ", z:" << coord.depth << "}"
-                   << " expected:" << expectedString << " observed:" << observedString
-                   << " expectedPromotion:" << expectedPromotionString << " observedPromotion:"
-                   << observedPromotionString;
-                result.mMessages.push_back(os.str());
+                result.mMessages.push_back(details::mismatch_message(expected_pixel, observed_pixel, expected, observed, coord));
             }
         }
 
@@ -290,19 +873,7 @@ namespace test_utils {
                              int                      pitch,
                              ExpectedPixelType        expected,
                              bool                     verbose) {
-        Evaluation result;
-
-        auto row = observed_pixels;
-        for (vk::Extent3D coord; coord.depth < extent.depth; ++coord.depth) {
-            for (coord.height = 0; coord.height < extent.height; ++coord.height, row += pitch) {
-                auto p = row;
-                for (coord.width = 0; coord.width < extent.width; ++coord.width, ++p) {
-                    result += evaluate_result(expected, *p, coord, verbose);
-                }
-            }
-        }
-
-        return result;
+        return details::check_rows(&expected, 0, 0, observed_pixels, extent, pitch, verbose);
     }
 
     template<typename ExpectedPixelType, typename ObservedPixelType>
@@ -311,20 +882,57 @@ namespace test_utils {
                              vk::Extent3D             extent,
                              int                      pitch,
                              bool                     verbose) {
-        Evaluation result;
+        return details::check_rows(expected_pixels, pitch, 1, observed_pixels, extent, pitch, verbose);
+    }
 
-        auto expected_row = expected_pixels;
-        auto observed_row = observed_pixels;
-        for (vk::Extent3D coord; coord.depth < extent.depth; ++coord.depth) {
-            for (coord.height = 0; coord.height < extent.height; ++coord.height, expected_row += pitch, observed_row += pitch) {
-                auto expected_p = expected_row;
-                auto observed_p = observed_row;
-                for (coord.width = 0; coord.width < extent.width; ++coord.width, ++expected_p, ++observed_p) {
-                    result += evaluate_result(*expected_p, *observed_p, coord, verbose);
-                }
+    //
+    // Compares two tightly packed device buffers of PixelType. When the current test requested
+    // device verification, the buffers are first compared on the device; only if that reports
+    // mismatches are the buffers mapped and compared on the host.
+    //
+    template<typename PixelType>
+    Evaluation check_buffer_results(vulkan_utils::storage_buffer&  expected_buffer,
+                                    vulkan_utils::storage_buffer&  observed_buffer,
+                                    vk::Extent3D                   extent,
+                                    bool                           verbose) {
+        typedef typename pixels::traits<PixelType>::component_t component_type;
+
+        const std::uint32_t num_pixels = extent.width * extent.height * extent.depth;
+
+        device_verify::summary_t device_summary;
+        const auto verifier = get_device_verifier();
+        if (verifier) {
+            note_device_comparison();
+            device_summary = details::device_comparator<component_type>::compare(*verifier,
+                                                                                 expected_buffer,
+                                                                                 observed_buffer,
+                                                                                 num_pixels,
+                                                                                 pixels::traits<PixelType>::num_components);
+            if (0 == device_summary.mNumMismatches) {
+                Evaluation result;
+                result.mNumCorrect = num_pixels;
+                return result;
             }
         }
 
+        auto expected_map = expected_buffer.map<PixelType>();
+        auto observed_map = observed_buffer.map<PixelType>();
+        Evaluation result = check_results(expected_map.get(), observed_map.get(), extent, extent.width, verbose);
+
+        if (verifier && verbose) {
+            std::ostringstream os;
+            os << "device verification reported " << device_summary.mNumMismatches << " incorrect pixels";
+            if (!device_summary.mMismatches.empty()) {
+                // the device records whichever mismatches its invocations reach first, which are
+                // not necessarily the lowest ones, so this is only an example
+                const std::uint32_t example = device_summary.mMismatches.front();
+                os << ", e.g. at pixel{x:" << example % extent.width
+                   << ", y:" << (example / extent.width) % extent.height
+                   << ", z:" << example / (extent.width * extent.height) << "}";
+            }
+            result.mMessages.push_back(os.str());
+        }
+
         return result;
     }
 
@@ -339,6 +947,13 @@ namespace test_utils {
                                             bool                             verbose,
                                             Test&                            test);
 
+    // Records iterations dispatches into a single submission, and returns one result per dispatch
+    std::vector<InvocationResult> throughput_test(clspv_utils::kernel&             kernel,
+                                                  const std::vector<std::string>&  args,
+                                                  unsigned int                     iterations,
+                                                  bool                             verbose,
+                                                  Test&                            test);
+
     template <typename Test>
     InvocationResult run_test(clspv_utils::kernel&              kernel,
                               const std::vector<std::string>&   args,
@@ -375,17 +990,37 @@ namespace test_utils {
         return time_test(kernel, args, iterations, verbose, test);
     }
 
+    template <typename Test>
+    std::vector<InvocationResult> throughput_test(clspv_utils::kernel&             kernel,
+                                                  const std::vector<std::string>&  args,
+                                                  unsigned int                     iterations,
+                                                  bool                             verbose)
+    {
+        Test test(kernel, args);
+        return throughput_test(kernel, args, iterations, verbose, test);
+    }
+
     template <typename Test>
     InvocationTest make_invocation_test(std::string variation)
     {
-        return InvocationTest{ variation, run_test<Test>, time_test<Test> };
+        return InvocationTest{ variation, run_test<Test>, time_test<Test>, throughput_test<Test> };
     }
 
     KernelTest::result test_kernel(clspv_utils::module& module,
                                    const KernelTest&    kernelTest);
 
-    ModuleTest::result test_module(clspv_utils::device& inDevice,
-                                   const ModuleTest&    moduleTest);
+    clspv_utils::module::spec_ptr load_module_spec(const std::string&            moduleName,
+                                                   clspv_utils::module_cache&    moduleCache);
+
+    // The module's interface as its reflection mode derives it; the cache keeps it, so it is
+    // derived once however many times the module is loaded
+    clspv_utils::module::spec_ptr get_module_spec(const ModuleTest&                 moduleTest,
+                                                  clspv_utils::module_cache&        moduleCache,
+                                                  const std::vector<std::uint32_t>& spvWords);
+
+    ModuleTest::result test_module(clspv_utils::device&         inDevice,
+                                   const ModuleTest&            moduleTest,
+                                   clspv_utils::module_cache&   moduleCache);
 
     InvocationTest createNullInvocationTest();
     
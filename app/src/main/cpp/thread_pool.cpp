@@ -0,0 +1,116 @@
+//
+// Created by Eric Berdahl on 5/18/18.
+//
+
+#include "thread_pool.hpp"
+
+#include <utility>
+
+namespace thread_pool {
+
+    unsigned int resolve_thread_count(unsigned int numThreads) {
+        if (0 == numThreads) {
+            numThreads = std::thread::hardware_concurrency();
+        }
+
+        // hardware_concurrency may report 0 if it cannot tell
+        return (0 == numThreads ? 1 : numThreads);
+    }
+
+    pool::pool(unsigned int numThreads) {
+        const unsigned int numWorkers = resolve_thread_count(numThreads) - 1;
+
+        mWorkers.reserve(numWorkers);
+        for (unsigned int i = 0; i < numWorkers; ++i) {
+            mWorkers.push_back(std::thread(&pool::worker, this));
+        }
+    }
+
+    pool::~pool() {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mStopping = true;
+        }
+        mWorkAvailable.notify_all();
+
+        for (auto& t : mWorkers) {
+            t.join();
+        }
+    }
+
+    unsigned int pool::size() const {
+        return static_cast<unsigned int>(mWorkers.size() + 1);
+    }
+
+    void pool::run(std::size_t numTasks, const task_fn& task) {
+        if (0 == numTasks) return;
+
+        // one batch at a time
+        std::lock_guard<std::mutex> runLock(mRunMutex);
+
+        std::unique_lock<std::mutex> lock(mMutex);
+        mTask = &task;
+        mNextTask = 0;
+        mNumTasks = numTasks;
+        mNumPending = numTasks;
+        mException = nullptr;
+        mWorkAvailable.notify_all();
+
+        // the calling thread works on the batch too
+        while (mNextTask < mNumTasks) {
+            const std::size_t taskIndex = mNextTask++;
+            lock.unlock();
+
+            std::exception_ptr exception;
+            try {
+                task(taskIndex);
+            }
+            catch (...) {
+                exception = std::current_exception();
+            }
+
+            lock.lock();
+            if (exception && !mException) mException = exception;
+            --mNumPending;
+        }
+
+        mWorkDone.wait(lock, [this]() { return 0 == mNumPending; });
+        mTask = nullptr;
+
+        std::exception_ptr exception;
+        std::swap(exception, mException);
+        lock.unlock();
+
+        if (exception) {
+            std::rethrow_exception(exception);
+        }
+    }
+
+    void pool::worker() {
+        std::unique_lock<std::mutex> lock(mMutex);
+
+        for (;;) {
+            mWorkAvailable.wait(lock, [this]() { return mStopping || (mTask && mNextTask < mNumTasks); });
+            if (mStopping) return;
+
+            const std::size_t taskIndex = mNextTask++;
+            const task_fn& task = *mTask;
+            lock.unlock();
+
+            std::exception_ptr exception;
+            try {
+                task(taskIndex);
+            }
+            catch (...) {
+                exception = std::current_exception();
+            }
+
+            lock.lock();
+            if (exception && !mException) mException = exception;
+            if (0 == --mNumPending) {
+                mWorkDone.notify_all();
+            }
+        }
+    }
+
+}
@@ -0,0 +1,62 @@
+//
+// Created by Eric Berdahl on 5/18/18.
+//
+
+#ifndef CLSPVTEST_THREAD_POOL_HPP
+#define CLSPVTEST_THREAD_POOL_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace thread_pool {
+
+    // Fixed set of worker threads which run batches of indexed tasks. The thread calling run also
+    // executes tasks, so a pool of size 1 has no worker threads at all and runs every task inline.
+    class pool
+    {
+    public:
+        typedef std::function<void (std::size_t)> task_fn;
+
+        // numThreads counts the calling thread; 0 selects one thread per hardware core
+        explicit        pool(unsigned int numThreads);
+                        ~pool();
+
+                        pool(const pool& other) = delete;
+        pool&           operator=(const pool& other) = delete;
+
+        unsigned int    size() const;
+
+        // Calls task(i) for each i in [0, numTasks), returning when all tasks have completed. Tasks
+        // may run concurrently and in any order. If any task throws, the first exception caught is
+        // rethrown once the batch completes.
+        void            run(std::size_t numTasks, const task_fn& task);
+
+    private:
+        void            worker();
+
+    private:
+        std::vector<std::thread>    mWorkers;
+
+        std::mutex                  mRunMutex;
+        std::mutex                  mMutex;
+        std::condition_variable     mWorkAvailable;
+        std::condition_variable     mWorkDone;
+
+        const task_fn*              mTask       = nullptr;
+        std::size_t                 mNextTask   = 0;
+        std::size_t                 mNumTasks   = 0;
+        std::size_t                 mNumPending = 0;
+        std::exception_ptr          mException;
+        bool                        mStopping   = false;
+    };
+
+    // number of threads a pool created with numThreads will use
+    unsigned int resolve_thread_count(unsigned int numThreads);
+}
+
+#endif //CLSPVTEST_THREAD_POOL_HPP
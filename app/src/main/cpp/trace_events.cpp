@@ -0,0 +1,197 @@
+//
+// Created by Eric Berdahl on 5/18/18.
+//
+
+#include "trace_events.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace {
+
+    const std::uint32_t kQueueTrack = 1000;
+
+    // events each thread keeps before overwriting its oldest
+    const std::size_t kRingCapacity = 1 << 16;
+
+    struct event_t {
+        const char*     mName;
+        const char*     mCategory;
+        std::uint64_t   mBegin_ns;
+        std::uint64_t   mEnd_ns;
+        std::uint32_t   mTrack;
+    };
+
+    //
+    // Only its own thread writes a ring, so recording needs no lock. The count is published with
+    // release semantics, so that a writer of the trace which sees an event also sees its contents.
+    //
+    struct ring_t {
+        explicit ring_t(std::uint32_t track) : mEvents(kRingCapacity), mCount(0), mTrack(track) {}
+
+        std::vector<event_t>        mEvents;
+        std::atomic<std::uint64_t>  mCount;
+        std::uint32_t               mTrack;
+    };
+
+    std::atomic<bool>                       gEnabled(false);
+
+    std::mutex                              gRingsMutex;
+    std::vector<std::unique_ptr<ring_t>>    gRings;
+
+    std::mutex                              gNamesMutex;
+    std::set<std::string>                   gNames;
+
+    thread_local ring_t*                    tRing = nullptr;
+
+    ring_t& thread_ring() {
+        if (!tRing) {
+            // once per thread
+            std::lock_guard<std::mutex> lock(gRingsMutex);
+            gRings.emplace_back(new ring_t(static_cast<std::uint32_t>(gRings.size() + 1)));
+            tRing = gRings.back().get();
+        }
+
+        return *tRing;
+    }
+
+    void push(const char* name, const char* category, std::uint64_t begin_ns, std::uint64_t end_ns, std::uint32_t track) {
+        ring_t& ring = thread_ring();
+
+        const std::uint64_t count = ring.mCount.load(std::memory_order_relaxed);
+        event_t& e = ring.mEvents[count % kRingCapacity];
+        e.mName = name;
+        e.mCategory = category;
+        e.mBegin_ns = begin_ns;
+        e.mEnd_ns = std::max(begin_ns, end_ns);
+        e.mTrack = track;
+
+        ring.mCount.store(count + 1, std::memory_order_release);
+    }
+
+    // JSON strings need only quotes, backslashes and control characters escaped
+    void write_string(std::ostream& os, const char* s) {
+        os << '"';
+        for (; *s; ++s) {
+            if ('"' == *s || '\\' == *s) {
+                os << '\\' << *s;
+            }
+            else if (static_cast<unsigned char>(*s) >= 0x20) {
+                os << *s;
+            }
+        }
+        os << '"';
+    }
+
+    void write_thread_name(std::ostream& os, std::uint32_t track, const std::string& name) {
+        os << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << track << ",\"args\":{\"name\":";
+        write_string(os, name.c_str());
+        os << "}}";
+    }
+
+} // anonymous namespace
+
+namespace trace_events {
+
+    void set_enabled(bool enabled) {
+        if (enabled) {
+            std::lock_guard<std::mutex> lock(gRingsMutex);
+            for (auto& ring : gRings) {
+                ring->mCount.store(0, std::memory_order_relaxed);
+            }
+        }
+
+        gEnabled.store(enabled, std::memory_order_release);
+    }
+
+    bool is_enabled() {
+        return gEnabled.load(std::memory_order_relaxed);
+    }
+
+    std::uint64_t now_ns() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    const char* intern(const std::string& name) {
+        std::lock_guard<std::mutex> lock(gNamesMutex);
+        return gNames.insert(name).first->c_str();
+    }
+
+    void record(const char* name, const char* category, std::uint64_t begin_ns, std::uint64_t end_ns) {
+        if (!is_enabled()) return;
+
+        push(name, category, begin_ns, end_ns, thread_ring().mTrack);
+    }
+
+    void record_queue(const char* name, std::uint64_t begin_ns, std::uint64_t end_ns) {
+        if (!is_enabled()) return;
+
+        push(name, "gpu", begin_ns, end_ns, kQueueTrack);
+    }
+
+    void write(std::ostream& os) {
+        std::lock_guard<std::mutex> lock(gRingsMutex);
+
+        // timestamps are relative to the earliest event, in microseconds
+        std::uint64_t origin_ns = std::numeric_limits<std::uint64_t>::max();
+        for (auto& ring : gRings) {
+            const std::uint64_t count = ring->mCount.load(std::memory_order_acquire);
+            for (std::uint64_t i = (count > kRingCapacity ? count - kRingCapacity : 0); i < count; ++i) {
+                origin_ns = std::min(origin_ns, ring->mEvents[i % kRingCapacity].mBegin_ns);
+            }
+        }
+
+        os << std::fixed << std::setprecision(3);
+        os << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+        os << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"ClspvTest\"}}";
+
+        os << ",\n";
+        write_thread_name(os, kQueueTrack, "compute queue");
+
+        std::uint64_t numDropped = 0;
+        for (auto& ring : gRings) {
+            os << ",\n";
+            write_thread_name(os, ring->mTrack, "host thread " + std::to_string(ring->mTrack));
+
+            const std::uint64_t count = ring->mCount.load(std::memory_order_acquire);
+            const std::uint64_t first = (count > kRingCapacity ? count - kRingCapacity : 0);
+            numDropped += first;
+
+            for (std::uint64_t i = first; i < count; ++i) {
+                const event_t& e = ring->mEvents[i % kRingCapacity];
+
+                os << ",\n{\"name\":";
+                write_string(os, e.mName);
+                os << ",\"cat\":";
+                write_string(os, e.mCategory);
+                os << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << e.mTrack
+                   << ",\"ts\":" << (e.mBegin_ns - origin_ns) / 1000.0
+                   << ",\"dur\":" << (e.mEnd_ns - e.mBegin_ns) / 1000.0 << "}";
+            }
+        }
+
+        os << "\n],\"otherData\":{\"droppedEvents\":" << numDropped << "}}\n";
+    }
+
+    scope::scope(const char* name, const char* category) :
+        mName(is_enabled() ? name : nullptr),
+        mCategory(category),
+        mBegin_ns(mName ? now_ns() : 0)
+    {
+    }
+
+    scope::~scope() {
+        if (mName) {
+            record(mName, mCategory, mBegin_ns, now_ns());
+        }
+    }
+
+}
@@ -0,0 +1,60 @@
+//
+// Created by Eric Berdahl on 5/18/18.
+//
+
+#ifndef CLSPVTEST_TRACE_EVENTS_HPP
+#define CLSPVTEST_TRACE_EVENTS_HPP
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+namespace trace_events {
+
+    //
+    // A timeline of what the harness spends its time on, written in the Chrome trace event format
+    // (chrome://tracing, Perfetto). Each host thread records complete events into a ring of its own,
+    // without locks, so recording stays cheap enough to leave on; when a ring is full, its oldest
+    // events are overwritten. GPU work is recorded on a separate track for the compute queue.
+    //
+    // Event names and categories are not copied, and must outlive the trace; use intern for names
+    // built at runtime.
+    //
+
+    // Enabling the trace discards any events recorded before. Nothing is recorded while disabled.
+    void set_enabled(bool enabled);
+
+    bool is_enabled();
+
+    // Host time on the trace's clock
+    std::uint64_t now_ns();
+
+    const char* intern(const std::string& name);
+
+    void record(const char* name, const char* category, std::uint64_t begin_ns, std::uint64_t end_ns);
+
+    // Records an event on the compute queue's track, with host times
+    void record_queue(const char* name, std::uint64_t begin_ns, std::uint64_t end_ns);
+
+    // Writes every recorded event. No thread may be recording meanwhile.
+    void write(std::ostream& os);
+
+    // Records an event covering its lifetime
+    class scope {
+    public:
+                scope(const char* name, const char* category);
+
+                scope(const scope&) = delete;
+
+                ~scope();
+
+        scope&  operator=(const scope&) = delete;
+
+    private:
+        const char*     mName;
+        const char*     mCategory;
+        std::uint64_t   mBegin_ns;
+    };
+}
+
+#endif //CLSPVTEST_TRACE_EVENTS_HPP
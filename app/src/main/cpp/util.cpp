@@ -85,7 +85,10 @@ void Android_handle_cmd(android_app *app, int32_t cmd) {
     switch (cmd) {
         case APP_CMD_INIT_WINDOW:
             // The window is being shown, get it ready.
-            sample_main(0, nullptr);
+            if (const int status = sample_main(0, nullptr)) {
+                LOGE("The sample finished with status %d", status);
+                std::exit(status);
+            }
             LOGI("\n");
             LOGI("=================================================");
             LOGI("          The sample ran successfully!!");
@@ -149,6 +152,12 @@ bool AndroidLoadFile(const char *filePath, std::string *data) {
     return true;
 }
 
+const char *AndroidGetInternalDataPath() {
+    // writable, and private to the application
+    assert(Android_application != nullptr);
+    return Android_application->activity->internalDataPath;
+}
+
 void AndroidGetWindowSize(int32_t *width, int32_t *height) {
     // On Android, retrieve the window size from the native window.
     assert(Android_application != nullptr);
@@ -171,6 +180,11 @@ static int android_close(void *cookie) {
     return 0;
 }
 
+AAsset *AndroidOpenAsset(const char *fname, int mode) {
+    assert(Android_application != nullptr);
+    return AAssetManager_open(Android_application->activity->assetManager, fname, mode);
+}
+
 FILE *AndroidFopen(const char *fname, const char *mode) {
     if (mode[0] == 'w') {
         return NULL;
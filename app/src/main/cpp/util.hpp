@@ -83,10 +83,14 @@ int sample_main(int argc, char *argv[]);
 // Replace printf to logcat output.
 #define printf(...) LOGD(__VA_ARGS__)
 
+struct AAsset;
+
 bool Android_process_command();
 ANativeWindow* AndroidGetApplicationWindow();
 FILE* AndroidFopen(const char* fname, const char* mode);
+AAsset* AndroidOpenAsset(const char* fname, int mode);
 void AndroidGetWindowSize(int32_t *width, int32_t *height);
 bool AndroidLoadFile(const char* filePath, std::string *data);
+const char* AndroidGetInternalDataPath();
 
 #endif // CLSPVTEST_UTIL_HPP
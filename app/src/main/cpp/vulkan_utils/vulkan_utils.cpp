@@ -6,6 +6,8 @@
 
 #include <algorithm>
 #include <cassert>
+#include <chrono>
+#include <cmath>
 #include <cstdint>
 #include <ios>
 #include <iostream>
@@ -829,20 +831,123 @@ namespace vulkan_utils {
         commandBuffer.copyImageToBuffer(imageBarrier.image, imageBarrier.newLayout, bufferBarrier.buffer, copyRegion);
     }
 
+    std::uint64_t timestamp_delta(std::uint64_t startTimestamp, std::uint64_t endTimestamp, std::uint32_t validBits) {
+        // a queue without timestamps reports 0 valid bits, and shifting by 64 is undefined
+        if (0 == validBits) return 0;
+
+        const std::uint64_t mask = std::numeric_limits<std::uint64_t>::max() >> (64 - std::min<std::uint32_t>(validBits, 64));
+
+        // unsigned arithmetic wraps modulo 2^64, so masking leaves the delta modulo 2^validBits
+        return (endTimestamp - startTimestamp) & mask;
+    }
+
     double timestamp_delta_ns(std::uint64_t                         startTimestamp,
                               std::uint64_t                         endTimestamp,
                               const vk::PhysicalDeviceProperties&   deviceProperties,
                               const vk::QueueFamilyProperties&      queueFamilyProperties) {
-        std::uint64_t timestampDelta;
-        if (endTimestamp >= startTimestamp) {
-            timestampDelta = endTimestamp - startTimestamp;
+        const std::uint64_t timestampDelta = timestamp_delta(startTimestamp, endTimestamp, queueFamilyProperties.timestampValidBits);
+        return timestampDelta * static_cast<double>(deviceProperties.limits.timestampPeriod);
+    }
+
+    std::int64_t timestamp_to_host_ns(const timestamp_calibration_t& calibration, std::uint64_t timestamp) {
+        const std::uint32_t validBits = std::min<std::uint32_t>(calibration.mValidBits, 64);
+        std::uint64_t delta = timestamp_delta(calibration.mTimestamp, timestamp, validBits);
+
+        // deltas of half a wrap or more are timestamps taken before the calibration
+        double delta_ns;
+        const std::uint64_t halfWrap = (validBits > 0 ? std::uint64_t(1) << (validBits - 1) : 0);
+        if (validBits > 0 && delta >= halfWrap) {
+            delta = timestamp_delta(timestamp, calibration.mTimestamp, validBits);
+            delta_ns = -(delta * calibration.mTimestampPeriod);
         }
         else {
-            const std::uint64_t maxTimestamp = std::numeric_limits<std::uint64_t>::max() >> (64 - queueFamilyProperties.timestampValidBits);
-            timestampDelta = maxTimestamp - startTimestamp + endTimestamp + 1;
+            delta_ns = delta * calibration.mTimestampPeriod;
+        }
+
+        return static_cast<std::int64_t>(calibration.mHost_ns) + std::llround(delta_ns);
+    }
+
+    timestamp_calibration_t calibrate_timestamps(vk::Device                             device,
+                                                 PFN_vkGetCalibratedTimestampsEXT       getCalibratedTimestamps,
+                                                 const vk::PhysicalDeviceProperties&    deviceProperties,
+                                                 const vk::QueueFamilyProperties&       queueFamilyProperties) {
+        timestamp_calibration_t result;
+        result.mTimestampPeriod = deviceProperties.limits.timestampPeriod;
+        result.mValidBits = queueFamilyProperties.timestampValidBits;
+        if (!getCalibratedTimestamps || 0 == result.mValidBits) return result;
+
+        VkCalibratedTimestampInfoEXT infos[2] = {};
+        infos[0].sType = VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT;
+        infos[0].timeDomain = VK_TIME_DOMAIN_DEVICE_EXT;
+        infos[1].sType = VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT;
+        infos[1].timeDomain = VK_TIME_DOMAIN_CLOCK_MONOTONIC_EXT;
+
+        std::uint64_t timestamps[2] = { 0, 0 };
+        std::uint64_t maxDeviation = 0;
+        if (VK_SUCCESS != getCalibratedTimestamps(static_cast<VkDevice>(device), 2, infos, timestamps, &maxDeviation)) {
+            return result;
+        }
+
+        result.mIsValid = true;
+        result.mIsCalibrated = true;
+        result.mTimestamp = timestamps[0];
+        result.mHost_ns = timestamps[1];
+        result.mMaxDeviation_ns = maxDeviation;
+        return result;
+    }
+
+    timestamp_calibration_t calibrate_timestamps_by_submission(vk::Device                           device,
+                                                               vk::CommandPool                      commandPool,
+                                                               vk::Queue                            queue,
+                                                               const vk::PhysicalDeviceProperties&  deviceProperties,
+                                                               const vk::QueueFamilyProperties&     queueFamilyProperties) {
+        const int kNumAttempts = 8;
+
+        timestamp_calibration_t result;
+        result.mTimestampPeriod = deviceProperties.limits.timestampPeriod;
+        result.mValidBits = queueFamilyProperties.timestampValidBits;
+        if (0 == result.mValidBits) return result;
+
+        vk::QueryPoolCreateInfo poolCreateInfo;
+        poolCreateInfo.setQueryType(vk::QueryType::eTimestamp)
+                .setQueryCount(1);
+        vk::UniqueQueryPool queryPool = device.createQueryPoolUnique(poolCreateInfo);
+
+        vk::UniqueCommandBuffer command = allocate_command_buffer(device, commandPool);
+        command->begin(vk::CommandBufferBeginInfo());
+        command->resetQueryPool(*queryPool, 0, 1);
+        command->writeTimestamp(vk::PipelineStageFlagBits::eTopOfPipe, *queryPool, 0);
+        command->end();
+
+        vk::CommandBuffer rawCommand = *command;
+        vk::SubmitInfo submitInfo;
+        submitInfo.setCommandBufferCount(1)
+                .setPCommandBuffers(&rawCommand);
+
+        auto host_ns = []() {
+            return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+        };
+
+        for (int attempt = 0; attempt < kNumAttempts; ++attempt) {
+            const std::uint64_t before_ns = host_ns();
+            queue.submit(submitInfo, nullptr);
+            queue.waitIdle();
+            const std::uint64_t after_ns = host_ns();
+
+            std::uint64_t timestamp = 0;
+            device.getQueryPoolResults(*queryPool, 0, 1, sizeof(timestamp), &timestamp, sizeof(timestamp),
+                                       vk::QueryResultFlagBits::e64 | vk::QueryResultFlagBits::eWait);
+
+            const std::uint64_t deviation_ns = (after_ns - before_ns) / 2;
+            if (!result.mIsValid || deviation_ns < result.mMaxDeviation_ns) {
+                result.mIsValid = true;
+                result.mTimestamp = timestamp;
+                result.mHost_ns = before_ns + deviation_ns;
+                result.mMaxDeviation_ns = deviation_ns;
+            }
         }
 
-        return timestampDelta * deviceProperties.limits.timestampPeriod;
+        return result;
     }
 
     vk::Extent3D computeNumberWorkgroups(const vk::Extent3D& workgroupSize, const vk::Extent3D& dataSize)
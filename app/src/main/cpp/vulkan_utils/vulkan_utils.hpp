@@ -12,6 +12,30 @@
 #include <ostream>
 #include <vector>
 
+#ifndef VK_EXT_calibrated_timestamps
+// VK_EXT_calibrated_timestamps postdates the bundled Vulkan headers
+#define VK_EXT_calibrated_timestamps 1
+#define VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME "VK_EXT_calibrated_timestamps"
+#define VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT static_cast<VkStructureType>(1000184000)
+
+typedef enum VkTimeDomainEXT {
+    VK_TIME_DOMAIN_DEVICE_EXT = 0,
+    VK_TIME_DOMAIN_CLOCK_MONOTONIC_EXT = 1,
+    VK_TIME_DOMAIN_CLOCK_MONOTONIC_RAW_EXT = 2,
+    VK_TIME_DOMAIN_QUERY_PERFORMANCE_COUNTER_EXT = 3,
+    VK_TIME_DOMAIN_MAX_ENUM_EXT = 0x7FFFFFFF
+} VkTimeDomainEXT;
+
+typedef struct VkCalibratedTimestampInfoEXT {
+    VkStructureType sType;
+    const void*     pNext;
+    VkTimeDomainEXT timeDomain;
+} VkCalibratedTimestampInfoEXT;
+
+typedef VkResult (VKAPI_PTR *PFN_vkGetPhysicalDeviceCalibrateableTimeDomainsEXT)(VkPhysicalDevice physicalDevice, uint32_t* pTimeDomainCount, VkTimeDomainEXT* pTimeDomains);
+typedef VkResult (VKAPI_PTR *PFN_vkGetCalibratedTimestampsEXT)(VkDevice device, uint32_t timestampCount, const VkCalibratedTimestampInfoEXT* pTimestampInfos, uint64_t* pTimestamps, uint64_t* pMaxDeviation);
+#endif
+
 namespace vulkan_utils {
 
     template <typename Type, typename Deleter>
@@ -293,11 +317,51 @@ namespace vulkan_utils {
         lhs.swap(rhs);
     }
 
+    // Ticks from startTimestamp to endTimestamp, allowing for the counter to wrap after validBits bits
+    std::uint64_t timestamp_delta(std::uint64_t startTimestamp, std::uint64_t endTimestamp, std::uint32_t validBits);
+
     double timestamp_delta_ns(std::uint64_t                         startTimestamp,
                               std::uint64_t                         endTimestamp,
                               const vk::PhysicalDeviceProperties&   deviceProperties,
                               const vk::QueueFamilyProperties&      queueFamilyProperties);
 
+    //
+    // A device timestamp and the host time it was taken at, on std::chrono::steady_clock in
+    // nanoseconds, from which other timestamps of the same queue can be placed on the host's clock.
+    // That is CLOCK_MONOTONIC, the host time domain of VK_EXT_calibrated_timestamps.
+    //
+    struct timestamp_calibration_t {
+        bool            mIsValid            = false;
+        bool            mIsCalibrated       = false;    // by VK_EXT_calibrated_timestamps, rather than by a submission
+        std::uint64_t   mTimestamp          = 0;
+        std::uint64_t   mHost_ns            = 0;
+        std::uint64_t   mMaxDeviation_ns    = 0;        // of mHost_ns from the time mTimestamp was taken
+        double          mTimestampPeriod    = 0.0;      // ns per tick
+        std::uint32_t   mValidBits          = 0;
+    };
+
+    // Host time, on the clock of calibration, of a timestamp taken within half a wrap of it
+    std::int64_t timestamp_to_host_ns(const timestamp_calibration_t& calibration, std::uint64_t timestamp);
+
+    // Samples the device and host clocks together; getCalibratedTimestamps must come from a device
+    // with VK_EXT_calibrated_timestamps enabled, and the device and CLOCK_MONOTONIC time domains
+    // must both be calibrateable.
+    timestamp_calibration_t calibrate_timestamps(vk::Device                             device,
+                                                 PFN_vkGetCalibratedTimestampsEXT       getCalibratedTimestamps,
+                                                 const vk::PhysicalDeviceProperties&    deviceProperties,
+                                                 const vk::QueueFamilyProperties&       queueFamilyProperties);
+
+    //
+    // Without the extension, submits a command buffer which only writes a timestamp, several times,
+    // and takes the timestamp to have been written halfway between submitting and the queue going
+    // idle, for the attempt where that interval was shortest. The queue must be idle.
+    //
+    timestamp_calibration_t calibrate_timestamps_by_submission(vk::Device                           device,
+                                                               vk::CommandPool                      commandPool,
+                                                               vk::Queue                            queue,
+                                                               const vk::PhysicalDeviceProperties&  deviceProperties,
+                                                               const vk::QueueFamilyProperties&     queueFamilyProperties);
+
     vk::Extent3D computeNumberWorkgroups(const vk::Extent3D& workgroupSize, const vk::Extent3D& dataSize);
 
     void copyBufferToImage(vk::CommandBuffer    commandBuffer,
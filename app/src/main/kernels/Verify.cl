@@ -0,0 +1,149 @@
+// Kernels which compare a test's observed results against its expected results on the device, so
+// that the host only needs to read back a small summary when every pixel is correct.
+//
+// The summary buffer holds the number of incorrect pixels, followed by the indices of up to
+// VERIFY_MAX_RECORDED of them (in no particular order). The host clears it before each dispatch.
+//
+// The comparisons are conservative: they may report a pixel the host would accept, but never accept
+// a pixel the host would reject. The host runs its own comparison whenever a mismatch is reported.
+
+#define VERIFY_MAX_RECORDED 16
+
+uint VerifyPixelIndex(int inRowLength)
+{
+    return get_global_id(1) * inRowLength + get_global_id(0);
+}
+
+void RecordMismatch(__global uint* outSummary, uint inPixel)
+{
+    const uint slot = atomic_inc(outSummary);
+    if (slot < VERIFY_MAX_RECORDED)
+    {
+        outSummary[1 + slot] = inPixel;
+    }
+}
+
+bool IsFinite(float inValue)
+{
+    // compare bits, since fast relaxed math allows the compiler to assume values are finite
+    return (as_uint(inValue) & 0x7F800000) != 0x7F800000;
+}
+
+bool AlmostEqual(float inExpected, float inObserved, float inTolerance, float inMinNormal)
+{
+    if (!IsFinite(inExpected) || !IsFinite(inObserved))
+    {
+        return false;
+    }
+
+    const float diff = fabs(inExpected - inObserved);
+    return diff < inTolerance * fabs(inExpected + inObserved) || diff < inMinNormal;
+}
+
+float ReadFloatComponent(const __global float* inBuffer, int inIndex, bool is16Bit)
+{
+    if (is16Bit)
+    {
+        return vload_half(inIndex, (const __global half*)inBuffer);
+    }
+    return inBuffer[inIndex];
+}
+
+unsigned int ReadUCharComponent(const __global uint* inBuffer, int inIndex)
+{
+    const int shift = 8 * (inIndex % 4);
+    return ((inBuffer[inIndex / 4] >> shift) & 0xFF);
+}
+
+// float or half components, compared with a relative tolerance (epsilon * ulp, made slightly
+// tighter by the host) unless the difference is below the smallest normal value
+__kernel void VerifyFloatPixels(
+    const __global float*   inExpected,
+    const __global float*   inObserved,
+    __global uint*          outSummary,
+    int                     inNumPixels,
+    int                     inComponentsPerPixel,
+    int                     inRowLength,
+    int                     inIs16Bit,
+    float                   inTolerance,
+    float                   inMinNormal)
+{
+    const uint pixel = VerifyPixelIndex(inRowLength);
+    if (pixel >= (uint)inNumPixels)
+    {
+        return;
+    }
+
+    const int first = pixel * inComponentsPerPixel;
+    bool isCorrect = true;
+    for (int c = 0; c < inComponentsPerPixel; ++c)
+    {
+        isCorrect = isCorrect && AlmostEqual(ReadFloatComponent(inExpected, first + c, inIs16Bit),
+                                             ReadFloatComponent(inObserved, first + c, inIs16Bit),
+                                             inTolerance,
+                                             inMinNormal);
+    }
+
+    if (!isCorrect)
+    {
+        RecordMismatch(outSummary, pixel);
+    }
+}
+
+// 8-bit unsigned components, which may differ by up to inTolerance
+__kernel void VerifyUCharPixels(
+    const __global uint*    inExpected,
+    const __global uint*    inObserved,
+    __global uint*          outSummary,
+    int                     inNumPixels,
+    int                     inComponentsPerPixel,
+    int                     inRowLength,
+    int                     inTolerance)
+{
+    const uint pixel = VerifyPixelIndex(inRowLength);
+    if (pixel >= (uint)inNumPixels)
+    {
+        return;
+    }
+
+    const int first = pixel * inComponentsPerPixel;
+    bool isCorrect = true;
+    for (int c = 0; c < inComponentsPerPixel; ++c)
+    {
+        const int diff = (int)ReadUCharComponent(inExpected, first + c) - (int)ReadUCharComponent(inObserved, first + c);
+        isCorrect = isCorrect && abs(diff) <= (uint)inTolerance;
+    }
+
+    if (!isCorrect)
+    {
+        RecordMismatch(outSummary, pixel);
+    }
+}
+
+// 32-bit integer components, which must match exactly
+__kernel void VerifyIntPixels(
+    const __global int*     inExpected,
+    const __global int*     inObserved,
+    __global uint*          outSummary,
+    int                     inNumPixels,
+    int                     inComponentsPerPixel,
+    int                     inRowLength)
+{
+    const uint pixel = VerifyPixelIndex(inRowLength);
+    if (pixel >= (uint)inNumPixels)
+    {
+        return;
+    }
+
+    const int first = pixel * inComponentsPerPixel;
+    bool isCorrect = true;
+    for (int c = 0; c < inComponentsPerPixel; ++c)
+    {
+        isCorrect = isCorrect && (inExpected[first + c] == inObserved[first + c]);
+    }
+
+    if (!isCorrect)
+    {
+        RecordMismatch(outSummary, pixel);
+    }
+}
@@ -0,0 +1,152 @@
+#!/usr/bin/env python
+#
+# Convert a clspv descriptor map (.spvmap) into the binary form read by
+# clspv_utils::createModuleSpec(const void*, std::size_t). The layout is documented in
+# cpp/clspv_utils/spvmap_binary.hpp; keep the two in sync.
+#
+# usage: spvmap_to_binary.py input.spvmap output.spvmap.bin
+#
+
+import struct
+import sys
+from collections import OrderedDict
+
+MAGIC = 0x42505343
+VERSION = 1
+
+ARG_KINDS = {
+    'pod':        0,
+    'pod_ubo':    1,
+    'buffer':     2,
+    'buffer_ubo': 3,
+    'ro_image':   4,
+    'wo_image':   5,
+    'sampler':    6,
+    'local':      7,
+}
+
+
+def split_csv_line(line):
+    """Split a spvmap line into fields, honoring double-quoted fields (e.g. samplerExpr)."""
+    fields = []
+    pos = 0
+    while pos < len(line):
+        if line[pos] == '"':
+            close = line.find('"', pos + 1)
+            if close < 0:
+                close = len(line)
+            fields.append(line[pos + 1:close])
+            comma = line.find(',', close)
+            pos = len(line) if comma < 0 else comma + 1
+        else:
+            comma = line.find(',', pos)
+            if comma < 0:
+                comma = len(line)
+            fields.append(line[pos:comma])
+            pos = comma + 1
+    return fields
+
+
+def key_values(fields):
+    return zip(fields[0::2], fields[1::2])
+
+
+def parse_spvmap(text):
+    samplers = []
+    constants = []
+    kernels = OrderedDict()
+
+    for line in text.replace('\r', '').split('\n'):
+        fields = split_csv_line(line)
+        if not fields:
+            continue
+
+        tag = fields[0]
+        if tag == 'sampler':
+            sampler = [int(fields[1]), -1, -1]
+            for key, value in key_values(fields[2:]):
+                if key == 'descriptorSet':
+                    sampler[1] = int(value)
+                elif key == 'binding':
+                    sampler[2] = int(value)
+            samplers.append(sampler)
+        elif tag == 'constant':
+            constant = [-1, -1, b'']
+            for key, value in key_values(fields[1:]):
+                if key == 'descriptorSet':
+                    constant[0] = int(value)
+                elif key == 'binding':
+                    constant[1] = int(value)
+                elif key == 'hexbytes':
+                    constant[2] = bytes(bytearray.fromhex(value))
+            constants.append(constant)
+        elif tag == 'kernel':
+            # kind, ordinal, descriptorSet, binding, offset, specConstant
+            arg = [None, -1, -1, -1, -1, -1]
+            for key, value in key_values(fields[2:]):
+                if key == 'argOrdinal':
+                    arg[1] = int(value)
+                elif key == 'descriptorSet':
+                    arg[2] = int(value)
+                elif key == 'binding':
+                    arg[3] = int(value)
+                elif key == 'offset':
+                    arg[4] = int(value)
+                elif key == 'argKind':
+                    if value not in ARG_KINDS:
+                        raise ValueError('unknown argKind encountered: ' + value)
+                    arg[0] = ARG_KINDS[value]
+                elif key == 'arrayNumElemSpecId':
+                    arg[5] = int(value)
+            if arg[0] is None:
+                raise ValueError('kernel argument kind unknown: ' + line)
+            kernels.setdefault(fields[1], []).append(arg)
+
+    return samplers, constants, kernels
+
+
+def build_binary(samplers, constants, kernels):
+    strings = bytearray()
+    constant_data = bytearray()
+
+    sampler_records = b''.join(struct.pack('<3i', *s) for s in samplers)
+
+    constant_records = b''
+    for descriptor_set, binding, data in constants:
+        constant_records += struct.pack('<2i2I', descriptor_set, binding, len(constant_data), len(data))
+        constant_data += data
+
+    kernel_records = b''
+    arg_records = b''
+    num_args = 0
+    for name, args in kernels.items():
+        encoded = name.encode('utf-8')
+        kernel_records += struct.pack('<4I', len(strings), len(encoded), num_args, len(args))
+        strings += encoded
+        for arg in args:
+            arg_records += struct.pack('<I5i', *arg)
+        num_args += len(args)
+
+    header = struct.pack('<8I', MAGIC, VERSION,
+                         len(samplers), len(constants), len(kernels), num_args,
+                         len(strings), len(constant_data))
+
+    return header + sampler_records + constant_records + kernel_records + arg_records + bytes(strings) + bytes(constant_data)
+
+
+def main(argv):
+    if len(argv) != 3:
+        sys.stderr.write('usage: %s input.spvmap output.spvmap.bin\n' % argv[0])
+        return 1
+
+    with open(argv[1], 'r') as f:
+        samplers, constants, kernels = parse_spvmap(f.read())
+
+    with open(argv[2], 'wb') as f:
+        f.write(build_binary(samplers, constants, kernels))
+
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))